@@ -24,6 +24,13 @@ PyAPI_FUNC(PyObject *) _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameOb
 PyAPI_FUNC(void) _PyEval_SetSwitchInterval(unsigned long microseconds);
 PyAPI_FUNC(unsigned long) _PyEval_GetSwitchInterval(void);
 
+PyAPI_FUNC(void) _PyEval_SetGILTiming(int enabled);
+PyAPI_FUNC(int) _PyEval_GetGILTiming(void);
+PyAPI_FUNC(void) _PyEval_GetThreadGILStats(PyThreadState *tstate,
+                                           _PyGILStats *stats);
+PyAPI_FUNC(void) _PyEval_GetInterpreterGILStats(PyInterpreterState *interp,
+                                                _PyGILStats *stats);
+
 PyAPI_FUNC(Py_ssize_t) _PyEval_RequestCodeExtraIndex(freefunc);
 
 PyAPI_FUNC(int) _PyEval_SliceIndex(PyObject *, Py_ssize_t *);
@@ -4,6 +4,10 @@
 
 typedef uint16_t _Py_CODEUNIT;
 
+#ifdef Py_OPCODE_STATS
+struct _PyCodeStats;
+#endif
+
 #ifdef WORDS_BIGENDIAN
 #  define _Py_OPCODE(word) ((word) >> 8)
 #  define _Py_OPARG(word) ((word) & 255)
@@ -61,6 +65,18 @@ struct PyCodeObject {
     _PyOpcache *co_opcache;
     int co_opcache_flag;  // used to determine when create a cache.
     unsigned char co_opcache_size;  // length of co_opcache.
+
+    // Copy of co_code in which the first instruction of each pair listed
+    // in _Py_SUPERINSTRUCTIONS is replaced by the superinstruction.
+    // Created along with the opcode cache; NULL if there is no such pair.
+    _Py_CODEUNIT *co_quickened;
+
+#ifdef Py_OPCODE_STATS
+    // Execution statistics of --with-opcode-stats builds (see
+    // Python/ceval.c).  Created on the first execution; they outlive the
+    // code object so that they can be dumped at exit.
+    struct _PyCodeStats *co_stats;
+#endif
 };
 
 /* Masks for co_flags above */
@@ -18,9 +18,12 @@ struct _frame {
     PyObject *f_globals;        /* global symbol table (PyDictObject) */
     PyObject *f_locals;         /* local symbol table (any mapping) */
     PyObject **f_valuestack;    /* points after the last local */
+    PyObject **f_localsptr;     /* locals+stack: f_localsplus, or the
+                                   thread's data stack if f_datastack */
     /* Next free slot in f_valuestack.  Frame creation sets to f_valuestack.
-       Frame evaluation usually NULLs it, but a frame that yields sets it
-       to the current stack top. */
+       Frame evaluation usually NULLs it, but a frame that yields, or that
+       waits for a call run inline by the eval loop, sets it to the current
+       stack top. */
     PyObject **f_stacktop;
     PyObject *f_trace;          /* Trace function */
     char f_trace_lines;         /* Emit per-line trace events? */
@@ -37,9 +40,13 @@ struct _frame {
        bytecode index. */
     int f_lineno;               /* Current line number */
     int f_iblock;               /* index in f_blockstack */
+    /* Line tracing state of _PyEval_EvalFrameDefault(), saved while the
+       frame is suspended in a call that the eval loop runs inline */
+    int f_instr_lb, f_instr_ub, f_instr_prev;
     char f_executing;           /* whether the frame is still executing */
+    char f_datastack;           /* whether f_localsptr is on the data stack */
     PyTryBlock f_blockstack[CO_MAXBLOCKS]; /* for try and loop blocks */
-    PyObject *f_localsplus[1];  /* locals+stack, dynamically sized */
+    PyObject *f_localsplus[1];  /* inline locals+stack, dynamically sized */
 };
 
 
@@ -56,6 +63,13 @@ PyAPI_FUNC(PyFrameObject *) PyFrame_New(PyThreadState *, PyCodeObject *,
 PyFrameObject* _PyFrame_New_NoTrack(PyThreadState *, PyCodeObject *,
                                     PyObject *, PyObject *);
 
+/* Like _PyFrame_New_NoTrack(), but the locals and the value stack live on
+   the thread's data stack.  The frame must not outlive the call: finish it
+   with _PyFrame_Release() before returning. */
+PyFrameObject* _PyFrame_NewOnStack_NoTrack(PyThreadState *, PyCodeObject *,
+                                           PyObject *, PyObject *);
+void _PyFrame_Release(PyThreadState *, PyFrameObject *);
+
 
 /* The rest of the interface is specific for frame objects */
 
@@ -42,6 +42,32 @@ typedef struct _err_stackitem {
 
 } _PyErr_StackItem;
 
+/* A chunk of the per-thread data stack, which holds the local variables
+   and value stacks of the frames being executed by the thread. */
+typedef struct _stack_chunk {
+    struct _stack_chunk *previous;
+    size_t size;
+    size_t top;
+    PyObject *data[1]; /* Variable sized */
+} _PyStackChunk;
+
+
+/* GIL usage counters of a thread or of an interpreter,
+   see _PyEval_GetThreadGILStats() */
+typedef struct {
+    /* Time spent waiting for the GIL */
+    _PyTime_t wait_time;
+    /* Time spent holding the GIL, only measured while GIL timing is
+       enabled: see _PyEval_SetGILTiming() */
+    _PyTime_t hold_time;
+    /* Number of times the GIL was taken */
+    uint64_t acquisitions;
+    /* Number of times the GIL was dropped because another thread asked
+       for it */
+    uint64_t forced_drops;
+    /* Number of times the thread holding the GIL was asked to drop it */
+    uint64_t drop_requests;
+} _PyGILStats;
 
 // The PyThreadState typedef is in Include/pystate.h.
 struct _ts {
@@ -132,6 +158,26 @@ struct _ts {
     /* Unique thread state id. */
     uint64_t id;
 
+    /* Data stack for frame locals, see _PyThreadState_PushLocals() */
+    _PyStackChunk *datastack_chunk;
+    _PyStackChunk *datastack_spare;
+    PyObject **datastack_top;
+    PyObject **datastack_limit;
+
+    /* GIL usage counters, protected by the GIL mutex */
+    _PyGILStats gil_stats;
+    /* When the thread took the GIL if GIL timing is enabled, else 0 */
+    _PyTime_t gil_taken;
+
+    /* Free small blocks of pymalloc, see _PyObject_ClearThreadCache() */
+    struct _obmalloc_tcache *obmalloc_cache;
+
+    /* Changes of the reference counts of the deferred objects, indexed like
+       the tables of the garbage collector; -1 once the thread state is
+       cleared.  See _Py_IncRefDeferred(). */
+    Py_ssize_t *deferred_refcnt;
+    Py_ssize_t deferred_refcnt_size;
+
     /* XXX signal handlers should also be here */
 
 };
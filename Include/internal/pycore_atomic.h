@@ -551,6 +551,69 @@ typedef struct _Py_atomic_int {
 #define _Py_atomic_load_relaxed(ATOMIC_VAL) \
     _Py_atomic_load_explicit((ATOMIC_VAL), _Py_memory_order_relaxed)
 
+/* Sequentially consistent read-modify-write operations on plain uintptr_t
+   variables, returning the previous value.  They are only provided, and
+   _Py_ATOMIC_HAVE_RMW defined, where they can be implemented. */
+#if defined(HAVE_BUILTIN_ATOMIC)
+#define _Py_ATOMIC_HAVE_RMW
+
+static inline uintptr_t
+_Py_atomic_fetch_add_uintptr(uintptr_t *ptr, uintptr_t value)
+{
+    return __atomic_fetch_add(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+static inline uintptr_t
+_Py_atomic_fetch_sub_uintptr(uintptr_t *ptr, uintptr_t value)
+{
+    return __atomic_fetch_sub(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+static inline uintptr_t
+_Py_atomic_fetch_and_uintptr(uintptr_t *ptr, uintptr_t value)
+{
+    return __atomic_fetch_and(ptr, value, __ATOMIC_SEQ_CST);
+}
+
+#elif defined(_MSC_VER)
+#define _Py_ATOMIC_HAVE_RMW
+
+#if defined(_M_X64) || defined(_M_ARM64)
+static inline uintptr_t
+_Py_atomic_fetch_add_uintptr(uintptr_t *ptr, uintptr_t value)
+{
+    return (uintptr_t)_InterlockedExchangeAdd64((volatile __int64 *)ptr,
+                                                (__int64)value);
+}
+
+static inline uintptr_t
+_Py_atomic_fetch_and_uintptr(uintptr_t *ptr, uintptr_t value)
+{
+    return (uintptr_t)_InterlockedAnd64((volatile __int64 *)ptr,
+                                        (__int64)value);
+}
+#else
+static inline uintptr_t
+_Py_atomic_fetch_add_uintptr(uintptr_t *ptr, uintptr_t value)
+{
+    return (uintptr_t)_InterlockedExchangeAdd((volatile long *)ptr,
+                                              (long)value);
+}
+
+static inline uintptr_t
+_Py_atomic_fetch_and_uintptr(uintptr_t *ptr, uintptr_t value)
+{
+    return (uintptr_t)_InterlockedAnd((volatile long *)ptr, (long)value);
+}
+#endif
+
+static inline uintptr_t
+_Py_atomic_fetch_sub_uintptr(uintptr_t *ptr, uintptr_t value)
+{
+    return _Py_atomic_fetch_add_uintptr(ptr, (uintptr_t)0 - value);
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
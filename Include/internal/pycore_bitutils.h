@@ -171,6 +171,38 @@ _Py_bit_length(unsigned long x)
 }
 
 
+// Return the index of the least significant 1 bit in 'x': the number of
+// trailing 0 bits. 'x' must not be zero.
+static inline int
+_Py_bit_ctz64(uint64_t x)
+{
+    assert(x != 0);
+#if (defined(__clang__) || defined(__GNUC__))
+    // __builtin_ctzll() is available since GCC 3.4.
+    Py_BUILD_ASSERT(sizeof(x) <= sizeof(unsigned long long));
+    return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && defined(_WIN64)
+    unsigned long lsb;
+    _BitScanForward64(&lsb, x);
+    return (int)lsb;
+#elif defined(_MSC_VER)
+    unsigned long lsb;
+    if (_BitScanForward(&lsb, (unsigned long)x)) {
+        return (int)lsb;
+    }
+    _BitScanForward(&lsb, (unsigned long)(x >> 32));
+    return (int)lsb + 32;
+#else
+    int n = 0;
+    while ((x & 1) == 0) {
+        n++;
+        x >>= 1;
+    }
+    return n;
+#endif
+}
+
+
 #ifdef __cplusplus
 }
 #endif
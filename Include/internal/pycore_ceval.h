@@ -8,6 +8,17 @@ extern "C" {
 #  error "this header requires Py_BUILD_CORE define"
 #endif
 
+#ifdef Py_OPCODE_STATS
+   /* --with-opcode-stats also collects the dynamic execution profile of
+      opcode pairs returned by sys.getdxp() */
+#  ifndef DYNAMIC_EXECUTION_PROFILE
+#    define DYNAMIC_EXECUTION_PROFILE
+#  endif
+#  ifndef DXPAIRS
+#    define DXPAIRS
+#  endif
+#endif
+
 /* Forward declarations */
 struct pyruntimestate;
 struct _ceval_runtime_state;
@@ -60,6 +71,11 @@ extern void _PyEval_FiniGIL(PyThreadState *tstate);
 
 extern void _PyEval_ReleaseLock(PyThreadState *tstate);
 
+/* GIL handover mode: 0 for the default mode, 1 for the fair mode */
+extern void _PyEval_SetGILMode(int fair);
+extern int _PyEval_GetGILMode(void);
+extern PyObject* _PyEval_GetGILStats(void);
+
 
 /* --- _Py_EnterRecursiveCall() ----------------------------------------- */
 
@@ -10,15 +10,68 @@ typedef struct {
     uint64_t builtins_ver; /* ma_version of builtin dict */
 } _PyOpcache_LoadGlobal;
 
+typedef struct {
+    PyTypeObject *type;  /* Cached type (borrowed reference) */
+    unsigned int tp_version_tag;  /* tp_version_tag of the cached type */
+    /* hint >= 0 is an index into the entries of the instance dict;
+       hint < -1 is the bitwise inverse of a slot offset in the instance. */
+    Py_ssize_t hint;
+} _PyOpcache_Attr;
+
+typedef struct {
+    PyTypeObject *type;  /* Cached type (borrowed reference) */
+    unsigned int tp_version_tag;  /* tp_version_tag of the cached type */
+    PyObject *descr;  /* Method descriptor found on the type (borrowed) */
+} _PyOpcache_LoadMethod;
+
+/* Operand types a BINARY_ADD or BINARY_SUBSCR instruction is specialized
+   for */
+enum {
+    _PyOpcache_BINARY_GENERIC = 0,
+    _PyOpcache_BINARY_ADD_INT,          /* int + int */
+    _PyOpcache_BINARY_ADD_FLOAT,        /* float + float */
+    _PyOpcache_BINARY_ADD_UNICODE,      /* str + str */
+    _PyOpcache_BINARY_SUBSCR_LIST_INT,  /* list[int] */
+    _PyOpcache_BINARY_SUBSCR_TUPLE_INT, /* tuple[int] */
+    _PyOpcache_BINARY_SUBSCR_DICT,      /* dict[key] */
+};
+
+typedef struct {
+    int kind;  /* One of the _PyOpcache_BINARY_* constants */
+} _PyOpcache_BinaryOp;
+
 struct _PyOpcache {
     union {
         _PyOpcache_LoadGlobal lg;
+        _PyOpcache_Attr attr;  /* LOAD_ATTR and STORE_ATTR */
+        _PyOpcache_LoadMethod lm;
+        _PyOpcache_BinaryOp binop;  /* BINARY_ADD and BINARY_SUBSCR */
     } u;
+    /* LOAD_GLOBAL: 1 once the entry is filled.
+       LOAD_ATTR, STORE_ATTR, LOAD_METHOD, BINARY_ADD, BINARY_SUBSCR: number
+       of misses left before the instruction is deoptimized. */
     char optimized;
 };
 
+#ifdef Py_OPCODE_STATS
+/* Statistics on the execution of a code object, --with-opcode-stats only */
+typedef struct _PyCodeStats {
+    struct _PyCodeStats *next;  /* All the statistics, newest first */
+    char *filename;             /* UTF-8 copy of co_filename */
+    char *name;                 /* UTF-8 copy of co_name */
+    int firstlineno;
+    size_t entries;             /* Frames run, resumed generators included */
+    size_t instructions;        /* Instructions executed */
+    size_t opcache_hits;
+    size_t opcache_misses;
+    size_t opcache_opts;
+    size_t opcache_deopts;
+} _PyCodeStats;
+#endif
+
 /* Private API */
 int _PyCode_InitOpcache(PyCodeObject *co);
+int _PyCode_Quicken(PyCodeObject *co);
 
 
 #ifdef __cplusplus
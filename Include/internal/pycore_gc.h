@@ -42,8 +42,15 @@ typedef struct {
 
 // Lowest bit of _gc_next is used for flags only in GC.
 // But it is always 0 for normal code.
-#define _PyGCHead_NEXT(g)        ((PyGC_Head*)(g)->_gc_next)
-#define _PyGCHead_SET_NEXT(g, p) ((g)->_gc_next = (uintptr_t)(p))
+// Bit 1 is set on objects already examined by the current incremental
+// collection of the oldest generation, and on frozen objects.  It survives
+// relinking the object in a list and is only cleared by the GC.
+#define _PyGC_NEXT_MASK_OLD_VISITED (2)
+#define _PyGCHead_NEXT(g) \
+    ((PyGC_Head*)((g)->_gc_next & ~_PyGC_NEXT_MASK_OLD_VISITED))
+#define _PyGCHead_SET_NEXT(g, p) \
+    ((g)->_gc_next = ((g)->_gc_next & _PyGC_NEXT_MASK_OLD_VISITED) \
+        | (uintptr_t)(p))
 
 // Lowest two bits of _gc_prev is used for _PyGC_PREV_MASK_* flags.
 #define _PyGCHead_PREV(g) ((PyGC_Head*)((g)->_gc_prev & _PyGC_PREV_MASK))
@@ -117,6 +124,11 @@ struct gc_generation {
                   generations */
 };
 
+/* Number of buckets of the pause histograms: bucket i > 0 counts pauses
+   of at least 2**(i-1) and less than 2**i microseconds, bucket 0 shorter
+   pauses and the last bucket all the longer ones. */
+#define NUM_PAUSE_BUCKETS 24
+
 /* Running stats per generation */
 struct gc_generation_stats {
     /* total number of collections */
@@ -125,6 +137,16 @@ struct gc_generation_stats {
     Py_ssize_t collected;
     /* total number of uncollectable objects (put into gc.garbage) */
     Py_ssize_t uncollectable;
+    /* total duration of the collections */
+    _PyTime_t time;
+    /* total duration of each phase of the collections */
+    _PyTime_t update_refs_time;
+    _PyTime_t subtract_refs_time;
+    _PyTime_t move_unreachable_time;
+    _PyTime_t finalize_time;
+    _PyTime_t delete_time;
+    /* histogram of the durations of the collections */
+    Py_ssize_t pauses[NUM_PAUSE_BUCKETS];
 };
 
 struct _gc_runtime_state {
@@ -159,10 +181,44 @@ struct _gc_runtime_state {
        collections, and are awaiting to undergo a full collection for
        the first time. */
     Py_ssize_t long_lived_pending;
+    /* Pause in seconds targeted by each step of an incremental collection
+       of the oldest generation, 0.0 if it is collected in one go. */
+    double incremental_pause;
+    /* While an incremental collection is in progress, the objects of the
+       oldest generation it has not examined yet.  Those in old_unmarked
+       still have the visited bit of the previous one. */
+    PyGC_Head old_unmarked;
+    PyGC_Head old_pending;
+    /* Objects found reachable from the roots whose referents have not been
+       marked yet. */
+    PyGC_Head old_marking;
+    /* Number of objects of old_pending examined by each step. */
+    Py_ssize_t increment_size;
+    /* Number of objects found alive by the current incremental collection:
+       marked from the roots or surviving a step. */
+    Py_ssize_t incremental_survivors;
+    /* Number of threads examining the objects of large collections, 1 if
+       collections are not parallel. */
+    int parallel_threads;
+    /* The deferred objects, indexed by the id held in their ob_refcnt, and
+       their reference counts, without the changes the threads have not
+       merged yet.  The entries of free ids are NULL in deferred, and chain
+       them in deferred_refcnt from deferred_free. */
+    PyObject **deferred;
+    Py_ssize_t *deferred_refcnt;
+    Py_ssize_t deferred_size;
+    Py_ssize_t deferred_free;
+    Py_ssize_t deferred_count;
 };
 
 PyAPI_FUNC(void) _PyGC_InitState(struct _gc_runtime_state *);
 
+// Functions of the deferred reference counts
+extern void _PyGC_ClearThreadState(PyThreadState *tstate);
+extern void _PyGC_UndeferAll(PyThreadState *tstate);
+PyAPI_FUNC(void) _PyGC_Undefer(PyObject *op);
+extern Py_ssize_t _PyGC_GetDeferredRefcnt(PyObject *op);
+
 
 // Functions to clear types free lists
 extern void _PyFrame_ClearFreeList(PyThreadState *tstate);
@@ -20,6 +20,20 @@ extern "C" {
 #undef FORCE_SWITCHING
 #define FORCE_SWITCHING
 
+/* Number of buckets of the GIL wait time histograms: bucket 0 counts waits
+   shorter than 1 microsecond, bucket i > 0 counts waits in
+   [2**(i-1), 2**i) microseconds, and the last bucket everything above. */
+#define _PyGIL_WAIT_BUCKETS 24
+
+/* A thread waiting for the GIL in fair mode (see ceval_gil.h) */
+struct _gil_waiter;
+
+struct _gil_waitqueue {
+    struct _gil_waiter *head;
+    struct _gil_waiter *tail;
+    unsigned long length;
+};
+
 struct _gil_runtime_state {
     /* microseconds (the Python API uses seconds, though) */
     unsigned long interval;
@@ -42,6 +56,20 @@ struct _gil_runtime_state {
     PyCOND_T switch_cond;
     PyMUTEX_T switch_mutex;
 #endif
+    /* Non-zero if the GIL is handed over to waiting threads in FIFO order,
+       threads coming back from a blocking call being served first.
+       The fields below are protected by the mutex. */
+    int fair;
+    /* Threads waiting for the GIL in fair mode: waiters[1] holds the threads
+       which released the GIL on their own (typically around blocking I/O),
+       waiters[0] the threads which were asked to drop it. */
+    struct _gil_waitqueue waiters[2];
+    /* Number of times the GIL was handed over directly to a waiter. */
+    unsigned long handoffs;
+    /* Non-zero if the time threads hold the GIL is measured */
+    int timing;
+    /* Histograms of the time spent in take_gil(), indexed like waiters */
+    uint64_t wait_histogram[2][_PyGIL_WAIT_BUCKETS];
 };
 
 #ifdef __cplusplus
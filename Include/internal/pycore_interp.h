@@ -50,6 +50,9 @@ struct _ceval_state {
     _Py_atomic_int eval_breaker;
     /* Request for dropping the GIL */
     _Py_atomic_int gil_drop_request;
+    /* GIL usage counters of all the threads of the interpreter, protected
+       by the GIL mutex */
+    _PyGILStats gil_stats;
     struct _pending_calls pending;
 #ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
     struct _gil_runtime_state gil;
@@ -157,6 +160,28 @@ struct _Py_context_state {
     int numfree;
 };
 
+struct type_cache_entry {
+    unsigned int version;  // initialized from next_version_tag
+    PyObject *name;        // reference to exactly a str or NULL
+    PyObject *value;       // borrowed reference or NULL
+};
+
+struct type_cache {
+    // Method cache of _PyType_Lookup(), indexed by a hash of the type
+    // version tag and of the attribute name. It has 1 << size_exp entries
+    // and is grown when collisions become frequent.
+    struct type_cache_entry *hashtable;
+    unsigned int size_exp;
+    // Statistics since the interpreter creation
+    size_t hits;
+    size_t misses;
+    size_t collisions;
+    size_t resizes;
+    // Value of the counters at the last resize
+    size_t resize_lookups;
+    size_t resize_collisions;
+};
+
 struct _Py_exc_state {
     // The dict mapping from errno codes to OSError subclasses
     PyObject *errnomap;
@@ -264,6 +289,7 @@ struct _is {
     struct _Py_async_gen_state async_gen;
     struct _Py_context_state context;
     struct _Py_exc_state exc_state;
+    struct type_cache type_cache;
 };
 
 /* Used by _PyImport_Cleanup() */
@@ -15,6 +15,10 @@ extern "C" {
 PyAPI_FUNC(int) _PyType_CheckConsistency(PyTypeObject *type);
 PyAPI_FUNC(int) _PyDict_CheckConsistency(PyObject *mp, int check_content);
 
+/* Return a dict describing the type method cache of the current
+   interpreter: size and hit, miss and collision counters. */
+extern PyObject *_PyType_GetCacheInfo(void);
+
 /* Update the Python traceback of an object. This function must be called
    when a memory block is reused from a free list.
 
@@ -51,6 +55,22 @@ _PyObject_InitVar(PyVarObject *op, PyTypeObject *typeobj, Py_ssize_t size)
     _PyObject_Init((PyObject *)op, typeobj);
 }
 
+/* Make the object immortal: it is never deallocated afterwards. */
+static inline void
+_Py_SetImmortal(PyObject *op)
+{
+    if (_Py_IsImmortal(op)) {
+        return;
+    }
+    if (_Py_IsDeferred(op)) {
+        _PyGC_Undefer(op);
+    }
+#ifdef Py_REF_DEBUG
+    _Py_RefTotal -= Py_REFCNT(op);
+#endif
+    Py_SET_REFCNT(op, _Py_IMMORTAL_REFCNT);
+}
+
 
 /* Tell the GC to track this object.
  *
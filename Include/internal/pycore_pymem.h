@@ -94,6 +94,20 @@ struct _PyTraceMalloc_Config {
 
 PyAPI_DATA(struct _PyTraceMalloc_Config) _Py_tracemalloc_config;
 
+/* Return the free blocks cached by the thread state to pymalloc and stop
+   caching blocks for it.  The GIL must be held. */
+extern void _PyObject_ClearThreadCache(PyThreadState *tstate);
+
+/* Enable or disable the pymalloc caches of free blocks per thread.
+   Disabling them returns the cached blocks of all threads to pymalloc:
+   the GIL must be held. */
+PyAPI_FUNC(void) _PyObject_SetThreadCaches(int enabled);
+PyAPI_FUNC(int) _PyObject_GetThreadCaches(void);
+
+/* Return a dict of statistics about pymalloc, or None if it is not used.
+   Used by sys._malloc_stats(). */
+extern PyObject* _PyObject_GetMallocStats(void);
+
 
 #ifdef __cplusplus
 }
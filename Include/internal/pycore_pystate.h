@@ -132,6 +132,13 @@ PyAPI_FUNC(PyThreadState *) _PyThreadState_Swap(
 
 PyAPI_FUNC(PyStatus) _PyInterpreterState_Enable(_PyRuntimeState *runtime);
 
+/* Reserve 'size' NULL-initialized slots on the thread's data stack.
+   Return NULL with MemoryError set on failure. */
+extern PyObject** _PyThreadState_PushLocals(PyThreadState *tstate, int size);
+/* Release the slots returned by _PyThreadState_PushLocals() and everything
+   pushed after them. */
+extern void _PyThreadState_PopLocals(PyThreadState *tstate, PyObject **locals);
+
 #ifdef HAVE_FORK
 extern PyStatus _PyInterpreterState_DeleteExceptMain(_PyRuntimeState *runtime);
 extern PyStatus _PyGILState_Reinit(_PyRuntimeState *runtime);
@@ -409,8 +409,39 @@ is not considered to be a reference to the type object, to save
 complications in the deallocation function.  (This is actually a
 decision that's up to the implementer of each new type so if you want,
 you can count such references to the type object.)
+
+Immortal objects are never deallocated, and Py_INCREF and Py_DECREF leave
+their reference count alone, so that their memory is not written to: this
+keeps the pages holding them shared between forked processes.  Their
+reference count has the _Py_IMMORTAL_BIT set, which is more references than
+fit in memory, and it starts far enough from the bit that code built
+without immortal objects can still increment and decrement it.
+
+The reference count of deferred objects is kept by the garbage collector:
+their ob_refcnt holds the _Py_DEFERRED_BIT and an index in the tables of the
+collector, and Py_INCREF and Py_DECREF update a table of the current thread
+instead of the object.  The collector adds up these changes when it runs,
+and deallocates the deferred objects which are no longer referenced.
 */
 
+#define _Py_IMMORTAL_BIT ((Py_ssize_t)1 << (8 * SIZEOF_SIZE_T - 3))
+#define _Py_IMMORTAL_REFCNT (_Py_IMMORTAL_BIT + (_Py_IMMORTAL_BIT >> 2))
+#define _Py_DEFERRED_BIT (_Py_IMMORTAL_BIT >> 1)
+
+static inline int _Py_IsImmortal(const PyObject *op)
+{
+    return (op->ob_refcnt & _Py_IMMORTAL_BIT) != 0;
+}
+
+static inline int _Py_IsDeferred(const PyObject *op)
+{
+    return ((op->ob_refcnt & (_Py_IMMORTAL_BIT | _Py_DEFERRED_BIT))
+            == _Py_DEFERRED_BIT);
+}
+
+PyAPI_FUNC(void) _Py_IncRefDeferred(PyObject *);
+PyAPI_FUNC(void) _Py_DecRefDeferred(PyObject *);
+
 #ifdef Py_REF_DEBUG
 PyAPI_DATA(Py_ssize_t) _Py_RefTotal;
 PyAPI_FUNC(void) _Py_NegativeRefcount(const char *filename, int lineno,
@@ -421,6 +452,12 @@ PyAPI_FUNC(void) _Py_Dealloc(PyObject *);
 
 static inline void _Py_INCREF(PyObject *op)
 {
+    if (op->ob_refcnt & (_Py_IMMORTAL_BIT | _Py_DEFERRED_BIT)) {
+        if (!_Py_IsImmortal(op)) {
+            _Py_IncRefDeferred(op);
+        }
+        return;
+    }
 #ifdef Py_REF_DEBUG
     _Py_RefTotal++;
 #endif
@@ -435,6 +472,12 @@ static inline void _Py_DECREF(
 #endif
     PyObject *op)
 {
+    if (op->ob_refcnt & (_Py_IMMORTAL_BIT | _Py_DEFERRED_BIT)) {
+        if (!_Py_IsImmortal(op)) {
+            _Py_DecRefDeferred(op);
+        }
+        return;
+    }
 #ifdef Py_REF_DEBUG
     _Py_RefTotal--;
 #endif
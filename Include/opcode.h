@@ -128,6 +128,19 @@ extern "C" {
 #define DICT_MERGE              164
 #define DICT_UPDATE             165
 
+    /* Superinstructions, only used in quickened code (see
+       _superinstructions in Lib/opcode.py) */
+#define LOAD_FAST__LOAD_FAST     99
+#define LOAD_FAST__LOAD_ATTR    119
+#define STORE_FAST__LOAD_FAST   120
+#define COMPARE_OP__POP_JUMP_IF_FALSE 123
+
+#define _Py_SUPERINSTRUCTIONS(SUPER) \
+    SUPER(LOAD_FAST, LOAD_FAST, LOAD_FAST__LOAD_FAST) \
+    SUPER(LOAD_FAST, LOAD_ATTR, LOAD_FAST__LOAD_ATTR) \
+    SUPER(STORE_FAST, LOAD_FAST, STORE_FAST__LOAD_FAST) \
+    SUPER(COMPARE_OP, POP_JUMP_IF_FALSE, COMPARE_OP__POP_JUMP_IF_FALSE)
+
 /* EXCEPT_HANDLER is a special, implicit block type which is created when
    entering an except handler. It is not an opcode but we define it here
    as we want it to be available to both frameobject.c and ceval.c, while
@@ -215,3 +215,16 @@ def_op('DICT_MERGE', 164)
 def_op('DICT_UPDATE', 165)
 
 del def_op, name_op, jrel_op, jabs_op
+
+# Superinstructions: pairs of instructions which the interpreter fuses into
+# a single one when it quickens a hot code object.  They never appear in
+# co_code or in .pyc files, so they have no entry in opname or opmap;
+# Tools/scripts/generate_opcode_h.py gives them the unused opcodes starting
+# at HAVE_ARGUMENT.  The pairs were picked from the most frequent ones
+# reported by superinstruction_candidates() in Tools/scripts/analyze_dxp.py.
+_superinstructions = [
+    ('LOAD_FAST', 'LOAD_FAST'),
+    ('LOAD_FAST', 'LOAD_ATTR'),
+    ('STORE_FAST', 'LOAD_FAST'),
+    ('COMPARE_OP', 'POP_JUMP_IF_FALSE'),
+]
@@ -70,6 +70,7 @@ def dash_R(ns, test_name, test_func):
     alloc_deltas = [0] * repcount
     fd_deltas = [0] * repcount
     getallocatedblocks = sys.getallocatedblocks
+    getunicodeinternedsize = sys.getunicodeinternedsize
     gettotalrefcount = sys.gettotalrefcount
     fd_count = support.fd_count
 
@@ -88,8 +89,9 @@ def dash_R(ns, test_name, test_func):
         dash_R_cleanup(fs, ps, pic, zdc, abcs)
 
         # dash_R_cleanup() ends with collecting cyclic trash:
-        # read memory statistics immediately after.
-        alloc_after = getallocatedblocks()
+        # read memory statistics immediately after.  Interned strings are
+        # immortal, they are not leaks.
+        alloc_after = getallocatedblocks() - getunicodeinternedsize()
         rc_after = gettotalrefcount()
         fd_after = fd_count()
 
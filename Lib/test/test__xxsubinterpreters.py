@@ -1,3 +1,4 @@
+import array
 from collections import namedtuple
 import contextlib
 import itertools
@@ -299,6 +300,7 @@ class IsShareableTests(unittest.TestCase):
                 'spam',
                 10,
                 -10,
+                memoryview(b'spam'),
                 ]
         for obj in shareables:
             with self.subTest(obj):
@@ -397,6 +399,39 @@ class ShareableTypeTests(unittest.TestCase):
                 with self.assertRaises(OverflowError):
                     interpreters.channel_send(self.cid, i)
 
+    def test_memoryview(self):
+        data = bytearray(b'spam')
+        interpreters.channel_send(self.cid, memoryview(data))
+        got = interpreters.channel_recv(self.cid)
+
+        self.assertIs(type(got), memoryview)
+        self.assertEqual(got, b'spam')
+        self.assertFalse(got.readonly)
+        # The memory is shared, not copied.
+        got[0] = ord('S')
+        self.assertEqual(data, b'Spam')
+        # The exporter stays locked until the buffer is released.
+        with self.assertRaises(BufferError):
+            data.clear()
+        got.release()
+        del got
+        data.clear()
+
+    def test_memoryview_readonly(self):
+        interpreters.channel_send(self.cid, memoryview(b'spam'))
+        got = interpreters.channel_recv(self.cid)
+
+        self.assertEqual(got, b'spam')
+        self.assertTrue(got.readonly)
+
+    def test_memoryview_format(self):
+        data = array.array('i', range(10))
+        interpreters.channel_send(self.cid, memoryview(data)[::2])
+        got = interpreters.channel_recv(self.cid)
+
+        self.assertEqual(got.format, 'i')
+        self.assertEqual(got.tolist(), [0, 2, 4, 6, 8])
+
 
 ##################################
 # interpreter tests
@@ -786,6 +821,25 @@ class RunStringTests(TestBase):
 
         self.assertEqual(out, 'it worked!')
 
+    def test_in_threads_concurrently(self):
+        ids = [self.id] + [interpreters.create() for _ in range(3)]
+        results = {}
+        def f(id):
+            results[id] = _run_output(id, dedent("""
+                total = 0
+                for i in range(100_000):
+                    total += i
+                print(total, end='')
+                """))
+
+        threads = [threading.Thread(target=f, args=(id,)) for id in ids]
+        for t in threads:
+            t.start()
+        for t in threads:
+            t.join()
+
+        self.assertEqual(results, dict.fromkeys(ids, str(sum(range(100_000)))))
+
     def test_create_thread(self):
         subinterp = interpreters.create(isolated=False)
         script, file = _captured_script("""
@@ -1394,6 +1448,27 @@ class ChannelTests(TestBase):
 
         self.assertEqual(obj, b'spam')
 
+    def test_send_recv_buffer_different_interpreters(self):
+        cid = interpreters.channel_create()
+        data = bytearray(b'spam')
+        interpreters.channel_send(cid, memoryview(data))
+        id1 = interpreters.create()
+        interpreters.run_string(id1, dedent(f"""
+            import _xxsubinterpreters as _interpreters
+            view = _interpreters.channel_recv({cid})
+            view[:] = b'eggs'
+            del view
+            _interpreters.channel_send({cid}, memoryview(b'ham'))
+            """))
+        obj = interpreters.channel_recv(cid)
+
+        self.assertEqual(data, b'eggs')
+        # The buffer was released by the other interpreter.
+        data.clear()
+        self.assertEqual(obj, b'ham')
+        del obj
+        interpreters.destroy(id1)
+
     def test_send_recv_different_threads(self):
         cid = interpreters.channel_create()
 
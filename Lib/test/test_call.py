@@ -1,5 +1,7 @@
+import sys
 import unittest
 from test.support import cpython_only
+from test.support.script_helper import assert_python_ok
 try:
     import _testcapi
 except ImportError:
@@ -713,5 +715,73 @@ class TestErrorMessagesUseQualifiedName(unittest.TestCase):
             A().method_two_args("x", "y", x="oops")
 
 
+class InlinedCallTests(unittest.TestCase):
+    # Calls of plain Python functions are run by the eval loop of the caller
+
+    def test_defaults(self):
+        def f(a, b=2, c=3):
+            return (a, b, c)
+        self.assertEqual(f(1), (1, 2, 3))
+        self.assertEqual(f(1, 5), (1, 5, 3))
+        self.assertEqual(f(1, 5, 6), (1, 5, 6))
+        self.assertRaises(TypeError, lambda: f())
+        self.assertRaises(TypeError, lambda: f(1, 2, 3, 4))
+
+    def test_method(self):
+        class C:
+            def m(self, x=1):
+                return self, x
+        c = C()
+        self.assertEqual(c.m(), (c, 1))
+        self.assertEqual(c.m(2), (c, 2))
+        self.assertEqual(C.m(c, 3), (c, 3))
+
+    def test_exception(self):
+        def inner():
+            raise ValueError
+        def outer():
+            return inner()
+        try:
+            outer()
+        except ValueError as exc:
+            tb = exc.__traceback__
+        names = []
+        while tb is not None:
+            names.append(tb.tb_frame.f_code.co_name)
+            tb = tb.tb_next
+        self.assertEqual(names, ['test_exception', 'outer', 'inner'])
+
+    def test_frames(self):
+        def inner():
+            return sys._getframe()
+        def outer():
+            return inner(), sys._getframe()
+        frame, outer_frame = outer()
+        self.assertEqual(frame.f_code.co_name, 'inner')
+        self.assertIs(frame.f_back, outer_frame)
+        self.assertIs(outer_frame.f_back, sys._getframe())
+
+    def test_recursion_limit(self):
+        def recurse(n):
+            return recurse(n + 1)
+        self.assertRaises(RecursionError, recurse, 0)
+
+    @cpython_only
+    def test_deep_recursion(self):
+        # Inlined calls do not use the C stack, so Python recursion is only
+        # bounded by the recursion limit
+        code = """if 1:
+            import sys
+            sys.setrecursionlimit(200_000)
+            def recurse(n):
+                if n == 0:
+                    return 0
+                return 1 + recurse(n - 1)
+            print(recurse(150_000))
+            """
+        rc, out, err = assert_python_ok('-c', code)
+        self.assertEqual(out.strip(), b'150000')
+
+
 if __name__ == "__main__":
     unittest.main()
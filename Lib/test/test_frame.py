@@ -1,4 +1,5 @@
 import re
+import sys
 import types
 import unittest
 import weakref
@@ -156,6 +157,24 @@ class FrameAttrsTest(unittest.TestCase):
         self.assertEqual(outer.f_locals, {})
         self.assertEqual(inner.f_locals, {})
 
+    def test_locals_outlive_call(self):
+        # Frames kept alive after their call returns, here across enough
+        # recursion to span several chunks of the thread's data stack,
+        # must keep their own copy of the locals.
+        def recurse(n, frames):
+            a, b = n, str(n)
+            frames.append(sys._getframe())
+            if n:
+                recurse(n - 1, frames)
+            return frames
+        frames = recurse(500, [])
+        for n, frame in zip(range(500, -1, -1), frames):
+            self.assertEqual(frame.f_locals['a'], n)
+            self.assertEqual(frame.f_locals['b'], str(n))
+        del frames
+        # The data stack is reusable afterwards
+        self.assertEqual(len(recurse(500, [])), 501)
+
     def test_f_lineno_del_segfault(self):
         f, _, _ = self.make_frames()
         with self.assertRaises(AttributeError):
@@ -755,15 +755,24 @@ class GCTests(unittest.TestCase):
         self.assertEqual(out.strip(), b'__del__ called')
 
     def test_get_stats(self):
+        phases = ["update_refs_time", "subtract_refs_time",
+                  "move_unreachable_time", "finalize_time", "delete_time"]
         stats = gc.get_stats()
         self.assertEqual(len(stats), 3)
         for st in stats:
             self.assertIsInstance(st, dict)
             self.assertEqual(set(st),
-                             {"collected", "collections", "uncollectable"})
+                             {"collected", "collections", "uncollectable",
+                              "time", "pauses", *phases})
             self.assertGreaterEqual(st["collected"], 0)
             self.assertGreaterEqual(st["collections"], 0)
             self.assertGreaterEqual(st["uncollectable"], 0)
+            self.assertGreaterEqual(st["time"], sum(st[p] for p in phases))
+            for p in phases:
+                self.assertGreaterEqual(st[p], 0.0)
+            self.assertIsInstance(st["pauses"], tuple)
+            self.assertEqual(len(st["pauses"]), 24)
+            self.assertEqual(sum(st["pauses"]), st["collections"])
         # Check that collection counts are incremented correctly
         if gc.isenabled():
             self.addCleanup(gc.enable)
@@ -779,6 +788,9 @@ class GCTests(unittest.TestCase):
         self.assertEqual(new[0]["collections"], old[0]["collections"] + 1)
         self.assertEqual(new[1]["collections"], old[1]["collections"])
         self.assertEqual(new[2]["collections"], old[2]["collections"] + 1)
+        self.assertEqual(sum(new[2]["pauses"]), sum(old[2]["pauses"]) + 1)
+        self.assertGreater(new[2]["time"], old[2]["time"])
+        self.assertEqual(new[1]["time"], old[1]["time"])
 
     def test_freeze(self):
         gc.freeze()
@@ -786,6 +798,205 @@ class GCTests(unittest.TestCase):
         gc.unfreeze()
         self.assertEqual(gc.get_freeze_count(), 0)
 
+    def test_freeze_immortal(self):
+        # Immortal objects are never freed: run in a separate process.
+        code = """if 1:
+            import gc, sys, weakref
+
+            class A:
+                pass
+
+            a = A()
+            a.name = "spam" * 100
+            a.cycle = a
+            wr = weakref.ref(a)
+            gc.freeze(immortal=True)
+            refcnt = sys.getrefcount(a)
+            name_refcnt = sys.getrefcount(a.name)
+            refs = [a, a.name] * 100
+            assert sys.getrefcount(a) == refcnt
+            assert sys.getrefcount(a.name) == name_refcnt
+            del refs, a
+            gc.unfreeze()
+            gc.collect()
+            assert wr() is not None
+            assert wr().name == "spam" * 100
+
+            b = A()
+            assert sys.getrefcount(b) == 2
+            """
+        assert_python_ok('-c', code)
+
+    def test_incremental(self):
+        for pause in (-1.0, float('inf'), float('nan')):
+            with self.assertRaises(ValueError):
+                gc.set_incremental(pause)
+        self.addCleanup(gc.set_incremental, gc.get_incremental())
+        self.addCleanup(gc.set_threshold, *gc.get_threshold())
+        if not gc.isenabled():
+            gc.enable()
+            self.addCleanup(gc.disable)
+        gc.set_incremental(1e-4)
+        self.assertEqual(gc.get_incremental(), 1e-4)
+        gc.set_threshold(100, 5, 5)
+
+        finalized = []
+        resurrected = []
+        callbacks = []
+        class A:
+            def __del__(self):
+                finalized.append(self.i)
+                if self.i == 0:
+                    resurrected.append(self)
+        gc.collect()
+        cycles = []
+        for i in range(5000):
+            a = A()
+            a.i = i
+            a.self = a
+            cycles.append(a)
+        refs = [weakref.ref(a, callbacks.append) for a in cycles[::10]]
+        # Move the cycles to the oldest generation
+        gc.collect(1)
+        del cycles, a
+
+        steps = []
+        def cb(phase, info):
+            if phase == 'stop' and info['generation'] == 2:
+                steps.append(len(finalized))
+        gc.callbacks.append(cb)
+        try:
+            keep = []
+            for i in range(10**6):
+                keep.append([])
+                if len(finalized) == 5000:
+                    break
+        finally:
+            gc.callbacks.remove(cb)
+        self.assertEqual(sorted(finalized), list(range(5000)))
+        self.assertEqual(len(callbacks), 500)
+        self.assertTrue(all(r() is None for r in refs))
+        # The resurrected cycle was not cleared
+        self.assertIs(resurrected[0].self, resurrected[0])
+        # The oldest generation was examined in several steps
+        self.assertGreater(len(steps), 1)
+
+        # Frozen objects stay out of the increments
+        frozen = []
+        gc.set_incremental(0)
+        self.assertEqual(gc.get_incremental(), 0.0)
+        gc.freeze()
+        self.addCleanup(gc.unfreeze)
+        gc.set_incremental(1e-4)
+        del steps[:]
+        gc.callbacks.append(cb)
+        try:
+            for i in range(10**6):
+                keep.append([frozen])
+                if len(steps) >= 3:
+                    break
+        finally:
+            gc.callbacks.remove(cb)
+        self.assertGreaterEqual(len(steps), 3)
+        self.assertFalse(any(o is frozen for o in gc.get_objects()))
+
+    def test_parallel(self):
+        with self.assertRaises(ValueError):
+            gc.set_parallel(0)
+        self.addCleanup(gc.set_parallel, gc.get_parallel())
+        gc.set_parallel(4)
+        self.assertEqual(gc.get_parallel(), 4)
+
+        class A:
+            pass
+        callbacks = []
+        gc.collect()
+        # Enough objects for several threads, in wide and deep structures
+        keep = [[A() for i in range(100)] for j in range(500)]
+        head = A()
+        a = head
+        for i in range(50000):
+            a.next = A()
+            a = a.next
+        cycles = []
+        for i in range(5000):
+            a = A()
+            a.self = a
+            cycles.append(a)
+        chain = A()
+        chain.next = a = A()
+        for i in range(20000):
+            a.next = A()
+            a = a.next
+        a.next = chain
+        refs = [weakref.ref(a, callbacks.append) for a in cycles[::10]]
+        refs.append(weakref.ref(chain, callbacks.append))
+        del cycles, chain, a
+
+        # 5000 cycles of an instance and its dict, and a cycle of 20002
+        # instances and their dicts
+        self.assertEqual(gc.collect(), 2 * 5000 + 2 * 20002)
+        self.assertEqual(len(callbacks), 501)
+        self.assertTrue(all(r() is None for r in refs))
+        n = 0
+        a = head
+        while hasattr(a, 'next'):
+            a = a.next
+            n += 1
+        self.assertEqual(n, 50000)
+        self.assertEqual(sum(len(l) for l in keep), 50000)
+
+    def test_deferred_refcount(self):
+        def f():
+            return 42
+        class A:
+            pass
+        refcnt = sys.getrefcount(f)
+        self.assertFalse(gc.is_deferred(f))
+        gc.defer_refcount(f)
+        gc.defer_refcount(f.__code__)
+        gc.defer_refcount(A)
+        self.assertTrue(gc.is_deferred(f))
+        self.assertTrue(gc.is_deferred(f.__code__))
+        self.assertTrue(gc.is_deferred(A))
+        self.assertEqual(sys.getrefcount(f), refcnt)
+
+        refs = [f] * 100
+        self.assertEqual(sys.getrefcount(f), refcnt + 100)
+        del refs
+        self.assertEqual(sys.getrefcount(f), refcnt)
+
+        def use():
+            for i in range(1000):
+                self.assertEqual(f(), 42)
+                A()
+        threads = [threading.Thread(target=use) for i in range(5)]
+        with threading_helper.start_threads(threads):
+            use()
+        self.assertEqual(sys.getrefcount(f), refcnt)
+        gc.collect()
+        self.assertTrue(gc.is_deferred(f))
+        self.assertEqual(sys.getrefcount(f), refcnt)
+
+        # Deferred objects are freed by the next collection
+        callbacks = []
+        wr = weakref.ref(f, callbacks.append)
+        del f
+        self.assertEqual(callbacks, [])
+        gc.collect()
+        self.assertEqual(callbacks, [wr])
+
+        # including garbage cycles
+        A.cycle = A
+        wr = weakref.ref(A)
+        del A
+        gc.collect()
+        self.assertIsNone(wr())
+
+        gc.defer_refcount(None)
+        self.assertFalse(gc.is_deferred(None))
+        self.assertRaises(TypeError, gc.defer_refcount, 1.5)
+
     def test_get_objects(self):
         gc.collect()
         l = []
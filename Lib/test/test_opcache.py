@@ -0,0 +1,554 @@
+import dis
+import json
+import opcode
+import os
+import sys
+import sysconfig
+import unittest
+from test import support
+from test.support import script_helper
+
+# The opcode cache of a code object is only created after the code has been
+# executed this number of times (see OPCACHE_MIN_RUNS in Python/ceval.c).
+WARMUP = 1100
+
+
+class TestLoadAttrCache(unittest.TestCase):
+
+    def test_instance_dict(self):
+        class C:
+            def __init__(self, x):
+                self.x = x
+
+        def f(o):
+            return o.x
+
+        for i in range(WARMUP):
+            self.assertEqual(f(C(i)), i)
+
+        o = C(1)
+        o.__dict__.clear()
+        o.y = 2
+        o.x = 3
+        self.assertEqual(f(o), 3)
+        del o.x
+        self.assertRaises(AttributeError, f, o)
+
+    def test_class_modified(self):
+        class C:
+            def __init__(self):
+                self.x = 1
+
+        def f(o):
+            return o.x
+
+        o = C()
+        for _ in range(WARMUP):
+            self.assertEqual(f(o), 1)
+
+        C.x = property(lambda self: 2)
+        self.assertEqual(f(o), 2)
+        del C.x
+        self.assertEqual(f(o), 1)
+
+    def test_base_class_modified(self):
+        class B:
+            pass
+
+        class C(B):
+            def __init__(self):
+                self.x = 1
+
+        def f(o):
+            return o.x
+
+        o = C()
+        for _ in range(WARMUP):
+            self.assertEqual(f(o), 1)
+
+        B.x = property(lambda self: 2)
+        self.assertEqual(f(o), 2)
+
+    def test_class_changed(self):
+        class A:
+            def __init__(self):
+                self.x = 1
+
+        class B:
+            x = property(lambda self: 2)
+
+        def f(o):
+            return o.x
+
+        o = A()
+        for _ in range(WARMUP):
+            self.assertEqual(f(o), 1)
+
+        o.__class__ = B
+        self.assertEqual(f(o), 2)
+
+    def test_getattr_added(self):
+        class C:
+            def __init__(self):
+                self.x = 1
+
+        def f(o):
+            return o.x
+
+        o = C()
+        for _ in range(WARMUP):
+            self.assertEqual(f(o), 1)
+
+        C.__getattribute__ = lambda self, name: 3
+        self.assertEqual(f(o), 3)
+
+    def test_slots(self):
+        class C:
+            __slots__ = ('x',)
+
+        def f(o):
+            return o.x
+
+        o = C()
+        o.x = 1
+        for _ in range(WARMUP):
+            self.assertEqual(f(o), 1)
+
+        del o.x
+        self.assertRaises(AttributeError, f, o)
+        o.x = 2
+        self.assertEqual(f(o), 2)
+
+    def test_polymorphic(self):
+        class A:
+            def __init__(self):
+                self.x = 'a'
+
+        class B:
+            __slots__ = ('x',)
+            def __init__(self):
+                self.x = 'b'
+
+        def f(o):
+            return o.x
+
+        objs = [A(), B(), A(), B()]
+        for i in range(WARMUP):
+            o = objs[i % 4]
+            self.assertEqual(f(o), 'a' if i % 2 == 0 else 'b')
+
+
+class TestStoreAttrCache(unittest.TestCase):
+
+    def test_instance_dict(self):
+        class C:
+            def __init__(self):
+                self.x = 0
+
+        def f(o, v):
+            o.x = v
+
+        o = C()
+        for i in range(WARMUP):
+            f(o, i)
+            self.assertEqual(o.x, i)
+
+        o2 = C()
+        del o2.x
+        f(o2, 'new')
+        self.assertEqual(o2.x, 'new')
+
+    def test_data_descriptor_added(self):
+        class C:
+            def __init__(self):
+                self.x = 0
+
+        def f(o, v):
+            o.x = v
+
+        o = C()
+        for i in range(WARMUP):
+            f(o, i)
+
+        stored = []
+        C.x = property(lambda self: 'prop', lambda self, v: stored.append(v))
+        f(o, 42)
+        self.assertEqual(stored, [42])
+        self.assertEqual(o.__dict__['x'], WARMUP - 1)
+
+    def test_setattr_added(self):
+        class C:
+            def __init__(self):
+                self.x = 0
+
+        def f(o, v):
+            o.x = v
+
+        o = C()
+        for i in range(WARMUP):
+            f(o, i)
+
+        def setattr(self, name, value):
+            object.__setattr__(self, name, value * 2)
+        C.__setattr__ = setattr
+        f(o, 21)
+        self.assertEqual(o.x, 42)
+
+    def test_slots(self):
+        class C:
+            __slots__ = ('x',)
+
+        def f(o, v):
+            o.x = v
+
+        o = C()
+        for i in range(WARMUP):
+            f(o, i)
+            self.assertEqual(o.x, i)
+
+        del o.x
+        f(o, 'again')
+        self.assertEqual(o.x, 'again')
+
+    def test_readonly_member(self):
+        def f(o, v):
+            o.start = v
+
+        r = range(10)
+        for _ in range(WARMUP):
+            with self.assertRaises(AttributeError):
+                f(r, 1)
+
+
+class TestLoadMethodCache(unittest.TestCase):
+
+    def test_builtin_type(self):
+        def f(lst):
+            return lst.copy()
+
+        for i in range(WARMUP):
+            self.assertEqual(f([i]), [i])
+        self.assertEqual(f(['x']), ['x'])
+
+    def test_method_redefined(self):
+        class C:
+            def m(self):
+                return 1
+
+        def f(o):
+            return o.m()
+
+        o = C()
+        for _ in range(WARMUP):
+            self.assertEqual(f(o), 1)
+
+        C.m = lambda self: 2
+        self.assertEqual(f(o), 2)
+
+    def test_shadowed_by_instance(self):
+        class C:
+            def m(self):
+                return 1
+
+        def f(o):
+            return o.m()
+
+        o = C()
+        for _ in range(WARMUP):
+            self.assertEqual(f(o), 1)
+
+        o.m = lambda: 3
+        self.assertEqual(f(o), 3)
+        del o.m
+        self.assertEqual(f(o), 1)
+
+    def test_base_method_overridden(self):
+        class B:
+            def m(self):
+                return 'B'
+
+        class C(B):
+            pass
+
+        def f(o):
+            return o.m()
+
+        o = C()
+        for _ in range(WARMUP):
+            self.assertEqual(f(o), 'B')
+
+        C.m = lambda self: 'C'
+        self.assertEqual(f(o), 'C')
+
+    def test_polymorphic(self):
+        class A:
+            def m(self):
+                return 'A'
+
+        class B:
+            def m(self):
+                return 'B'
+
+        def f(o):
+            return o.m()
+
+        objs = [A(), B()]
+        for i in range(WARMUP):
+            self.assertEqual(f(objs[i % 2]), 'AB'[i % 2])
+
+
+class TestBinaryAddCache(unittest.TestCase):
+
+    def test_int(self):
+        def f(a, b):
+            return a + b
+
+        for i in range(WARMUP):
+            self.assertEqual(f(i, 1), i + 1)
+        self.assertEqual(f(2**100, 2**100), 2**101)
+        self.assertEqual(f(-5, 3), -2)
+        self.assertEqual(f(True, True), 2)
+        self.assertEqual(f(1.5, 1), 2.5)
+        self.assertEqual(f([1], [2]), [1, 2])
+        self.assertRaises(TypeError, f, 1, 'a')
+
+    def test_float(self):
+        def f(a, b):
+            return a + b
+
+        for i in range(WARMUP):
+            self.assertEqual(f(i + 0.5, 0.5), i + 1.0)
+        self.assertEqual(f(float('inf'), 1.0), float('inf'))
+        self.assertEqual(f(1, 2), 3)
+
+    def test_str(self):
+        def f(a, b):
+            return a + b
+
+        for i in range(WARMUP):
+            self.assertEqual(f('a', str(i)), 'a' + str(i))
+        self.assertEqual(f(b'a', b'b'), b'ab')
+
+    def test_subclass(self):
+        class MyInt(int):
+            def __add__(self, other):
+                return 'add'
+
+        def f(a, b):
+            return a + b
+
+        for i in range(WARMUP):
+            self.assertEqual(f(i, i), 2 * i)
+        self.assertEqual(f(MyInt(1), 1), 'add')
+        self.assertEqual(f(1, MyInt(1)), 2)
+
+    def test_types_change(self):
+        def f(a, b):
+            return a + b
+
+        values = [(1, 2, 3), (1.0, 2.0, 3.0), ('a', 'b', 'ab'),
+                  ((1,), (2,), (1, 2))]
+        for i in range(WARMUP):
+            a, b, expected = values[i % len(values)]
+            self.assertEqual(f(a, b), expected)
+
+
+class TestBinarySubscrCache(unittest.TestCase):
+
+    def test_list(self):
+        def f(seq, i):
+            return seq[i]
+
+        seq = list(range(10))
+        for i in range(WARMUP):
+            self.assertEqual(f(seq, i % 10), i % 10)
+        self.assertEqual(f(seq, -1), 9)
+        self.assertEqual(f(seq, -10), 0)
+        self.assertRaises(IndexError, f, seq, 10)
+        self.assertRaises(IndexError, f, seq, -11)
+        self.assertRaises(IndexError, f, seq, 2**100)
+        self.assertRaises(IndexError, f, seq, -2**100)
+        self.assertEqual(f(seq, True), 1)
+        self.assertEqual(f(seq, slice(1, 3)), [1, 2])
+        self.assertEqual(f('abc', 1), 'b')
+
+    def test_tuple(self):
+        def f(seq, i):
+            return seq[i]
+
+        seq = tuple(range(10))
+        for i in range(WARMUP):
+            self.assertEqual(f(seq, i % 10), i % 10)
+        self.assertEqual(f(seq, -1), 9)
+        self.assertRaises(IndexError, f, seq, 10)
+        self.assertRaises(IndexError, f, seq, 2**100)
+        self.assertRaises(IndexError, f, (), 0)
+
+    def test_dict(self):
+        def f(d, k):
+            return d[k]
+
+        d = {str(i): i for i in range(10)}
+        for i in range(WARMUP):
+            self.assertEqual(f(d, str(i % 10)), i % 10)
+        with self.assertRaises(KeyError) as cm:
+            f(d, 'missing')
+        self.assertEqual(cm.exception.args, ('missing',))
+        with self.assertRaises(KeyError) as cm:
+            f(d, (1,))
+        self.assertEqual(cm.exception.args, ((1,),))
+        self.assertRaises(TypeError, f, d, [])
+
+    def test_dict_subclass(self):
+        class D(dict):
+            def __missing__(self, key):
+                return 'missing'
+
+        def f(d, k):
+            return d[k]
+
+        d = {'a': 1}
+        for i in range(WARMUP):
+            self.assertEqual(f(d, 'a'), 1)
+        self.assertEqual(f(D(), 'a'), 'missing')
+
+    def test_list_subclass(self):
+        class L(list):
+            def __getitem__(self, i):
+                return 'item'
+
+        def f(seq, i):
+            return seq[i]
+
+        for i in range(WARMUP):
+            self.assertEqual(f([i], 0), i)
+        self.assertEqual(f(L([1]), 0), 'item')
+
+
+class TestSuperinstructions(unittest.TestCase):
+
+    def test_unbound_local(self):
+        def f(flag):
+            if flag:
+                x = 1
+            return flag, x
+
+        for _ in range(WARMUP):
+            self.assertEqual(f(True), (True, 1))
+        try:
+            f(False)
+        except UnboundLocalError as exc:
+            tb = exc.__traceback__.tb_next
+        else:
+            self.fail("UnboundLocalError not raised")
+        self.assertEqual(tb.tb_lineno, f.__code__.co_firstlineno + 3)
+
+    def test_compare_and_jump(self):
+        class Weird:
+            def __init__(self, result):
+                self.result = result
+            def __lt__(self, other):
+                return self.result
+
+        def f(a, b):
+            if a < b:
+                return 'yes'
+            return 'no'
+
+        for i in range(WARMUP):
+            self.assertEqual(f(i, 500), 'yes' if i < 500 else 'no')
+        self.assertEqual(f(Weird([]), 0), 'no')
+        self.assertEqual(f(Weird([1]), 0), 'yes')
+        self.assertRaises(TypeError, f, 1, 'a')
+
+    def test_attribute(self):
+        class C:
+            x = 1
+
+        def f(o):
+            return o.x
+
+        for _ in range(WARMUP):
+            self.assertEqual(f(C), 1)
+        self.assertRaises(AttributeError, f, object())
+
+    def test_str_concatenate(self):
+        def f(n):
+            s = ''
+            for i in range(n):
+                s = s + 'x'
+                t = s
+            return t
+
+        for _ in range(WARMUP):
+            self.assertEqual(f(3), 'xxx')
+
+    def test_trace_opcodes(self):
+        def f(a, b):
+            x = a
+            y = x + b
+            return a < y
+
+        for i in range(WARMUP):
+            self.assertTrue(f(i, 1))
+
+        offsets = []
+        def tracer(frame, event, arg):
+            if frame.f_code is f.__code__:
+                frame.f_trace_opcodes = True
+                if event == 'opcode':
+                    offsets.append(frame.f_lasti)
+            return tracer
+
+        sys.settrace(tracer)
+        try:
+            f(1, 2)
+        finally:
+            sys.settrace(None)
+        self.assertEqual(offsets,
+                         [instr.offset for instr in dis.get_instructions(f)])
+
+
+@unittest.skipUnless(sysconfig.get_config_var('Py_OPCODE_STATS'),
+                     'requires --with-opcode-stats')
+class TestOpcodeStats(unittest.TestCase):
+
+    def test_dump(self):
+        code = """if 1:
+            class C:
+                pass
+            def f(o):
+                return o.x
+            o = C()
+            o.x = 1
+            for i in range(2000):
+                f(o)
+        """
+        filename = support.TESTFN
+        self.addCleanup(support.unlink, filename)
+        for _ in range(2):
+            script_helper.assert_python_ok('-c', code,
+                                           PYTHONOPCODESTATS=filename)
+        with open(filename, encoding='utf-8') as f:
+            lines = f.readlines()
+        self.assertEqual(len(lines), 2)
+
+        stats = json.loads(lines[0])
+        self.assertEqual(len(stats['opcodes']), 256)
+        self.assertGreaterEqual(stats['opcodes'][opcode.opmap['LOAD_ATTR']],
+                                2000)
+        pairs = {(op1, op2): count for op1, op2, count in stats['pairs']}
+        pair = (opcode.opmap['LOAD_FAST'], opcode.opmap['LOAD_ATTR'])
+        self.assertGreaterEqual(pairs[pair], 2000)
+        self.assertGreater(stats['opcache']['LOAD_ATTR/STORE_ATTR']['hits'], 0)
+
+        f_stats = [c for c in stats['code']
+                   if c['name'] == 'f' and c['filename'] == '<string>']
+        self.assertEqual(len(f_stats), 1)
+        self.assertEqual(f_stats[0]['entries'], 2000)
+        self.assertEqual(f_stats[0]['instructions'], 2000 * 3)
+        self.assertGreater(f_stats[0]['opcache_hits'], 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
@@ -744,13 +744,14 @@ class CPythonOrderedDictTests(OrderedDictTests, unittest.TestCase):
         nodesize = calcsize('Pn2P')
 
         od = OrderedDict()
-        check(od, basicsize + 8 + 5*entrysize)  # 8byte indices + 8*2//3 * entry table
+        # 8byte indices + 24byte tags + 8*2//3 * entry table
+        check(od, basicsize + 8 + 24 + 5*entrysize)
         od.x = 1
-        check(od, basicsize + 8 + 5*entrysize)
+        check(od, basicsize + 8 + 24 + 5*entrysize)
         od.update([(i, i) for i in range(3)])
-        check(od, basicsize + 8*p + 8 + 5*entrysize + 3*nodesize)
+        check(od, basicsize + 8*p + 8 + 24 + 5*entrysize + 3*nodesize)
         od.update([(i, i) for i in range(3, 10)])
-        check(od, basicsize + 16*p + 16 + 10*entrysize + 10*nodesize)
+        check(od, basicsize + 16*p + 16 + 32 + 10*entrysize + 10*nodesize)
 
         check(od.keys(), size('P'))
         check(od.items(), size('P'))
@@ -203,6 +203,114 @@ class SysModuleTest(unittest.TestCase):
         finally:
             sys.setswitchinterval(orig)
 
+    @test.support.cpython_only
+    def test_gilmode(self):
+        self.assertRaises(TypeError, sys._setgilmode)
+        self.assertRaises(ValueError, sys._setgilmode, "spam")
+        orig = sys._getgilmode()
+        self.assertEqual(orig, "default")
+        try:
+            for mode in "fair", "default", "fair":
+                sys._setgilmode(mode)
+                self.assertEqual(sys._getgilmode(), mode)
+                self.assertEqual(sys._getgilstats()["mode"], mode)
+        finally:
+            sys._setgilmode(orig)
+
+    @test.support.cpython_only
+    @threading_helper.reap_threads
+    def test_gilstats(self):
+        import threading
+        import time
+
+        def waits(stats):
+            return sum(stats["io_waits"]) + sum(stats["cpu_waits"])
+
+        stats = sys._getgilstats()
+        self.assertEqual(len(stats["io_waits"]), len(stats["cpu_waits"]))
+
+        def busy(deadline):
+            while time.monotonic() < deadline:
+                pass
+
+        def sleepy(deadline):
+            while time.monotonic() < deadline:
+                time.sleep(0.0001)
+
+        orig_mode = sys._getgilmode()
+        orig_interval = sys.getswitchinterval()
+        sys.setswitchinterval(0.0005)
+        try:
+            for mode in "default", "fair":
+                sys._setgilmode(mode)
+                before = sys._getgilstats()
+                deadline = time.monotonic() + 0.2
+                threads = [threading.Thread(target=busy, args=(deadline,))
+                           for i in range(2)]
+                threads += [threading.Thread(target=sleepy, args=(deadline,))
+                            for i in range(2)]
+                with threading_helper.start_threads(threads):
+                    # Switch modes while threads are waiting for the GIL
+                    sys._setgilmode("default" if mode == "fair" else "fair")
+                    time.sleep(0.05)
+                    sys._setgilmode(mode)
+                after = sys._getgilstats()
+                self.assertGreater(after["switches"], before["switches"])
+                self.assertGreater(waits(after), waits(before))
+                if mode == "fair":
+                    self.assertGreater(after["handoffs"], before["handoffs"])
+        finally:
+            sys._setgilmode(orig_mode)
+            sys.setswitchinterval(orig_interval)
+
+    @test.support.cpython_only
+    @threading_helper.reap_threads
+    def test_gil_thread_stats(self):
+        import threading
+        import time
+
+        keys = {'wait_time', 'hold_time', 'acquisitions', 'forced_drops',
+                'drop_requests'}
+        stats = sys._getgilstats()
+        self.assertEqual(set(stats['interpreter']), keys)
+        self.assertEqual(set(stats['threads'][threading.get_ident()]), keys)
+
+        def busy(deadline):
+            while time.monotonic() < deadline:
+                pass
+
+        orig_interval = sys.getswitchinterval()
+        sys.setswitchinterval(0.0005)
+        sys._setgiltiming(True)
+        try:
+            self.assertIs(sys._getgilstats()['timing'], True)
+            before = sys._getgilstats()['interpreter']
+            deadline = time.monotonic() + 0.1
+            threads = [threading.Thread(target=busy, args=(deadline,))
+                       for i in range(2)]
+            with threading_helper.start_threads(threads):
+                time.sleep(0.05)
+                stats = sys._getgilstats()
+                busy_stats = [stats['threads'][t.ident] for t in threads]
+            after = sys._getgilstats()['interpreter']
+        finally:
+            sys._setgiltiming(False)
+            sys.setswitchinterval(orig_interval)
+        self.assertIs(sys._getgilstats()['timing'], False)
+
+        for key in keys:
+            self.assertGreater(after[key], before[key], key)
+        for thread_stats in busy_stats:
+            self.assertGreater(thread_stats['acquisitions'], 0)
+            self.assertGreater(thread_stats['hold_time'], 0)
+        # The busy threads preempt each other
+        self.assertGreater(sum(t['forced_drops'] for t in busy_stats), 0)
+        self.assertGreater(sum(t['drop_requests'] for t in busy_stats), 0)
+        # The counters of the interpreter include the threads which are gone
+        self.assertGreaterEqual(
+            after['hold_time'] - before['hold_time'],
+            sum(t['hold_time'] for t in busy_stats))
+
     def test_recursionlimit(self):
         self.assertRaises(TypeError, sys.getrecursionlimit, 42)
         oldlimit = sys.getrecursionlimit()
@@ -349,14 +457,33 @@ class SysModuleTest(unittest.TestCase):
         # the reference count to increase by 2 instead of 1.
         global n
         self.assertRaises(TypeError, sys.getrefcount)
-        c = sys.getrefcount(None)
-        n = None
-        self.assertEqual(sys.getrefcount(None), c+1)
+        ob = object()
+        c = sys.getrefcount(ob)
+        n = ob
+        self.assertEqual(sys.getrefcount(ob), c+1)
         del n
-        self.assertEqual(sys.getrefcount(None), c)
+        self.assertEqual(sys.getrefcount(ob), c)
         if hasattr(sys, "gettotalrefcount"):
             self.assertIsInstance(sys.gettotalrefcount(), int)
 
+    @test.support.refcount_test
+    def test_immortal_objects(self):
+        # The reference count of immortal objects never changes
+        for ob in (None, True, False, ..., NotImplemented, -5, 0, 256,
+                   sys.intern('test_immortal_objects')):
+            with self.subTest(ob=ob):
+                c = sys.getrefcount(ob)
+                refs = [ob] * 10
+                self.assertEqual(sys.getrefcount(ob), c)
+                del refs
+                self.assertEqual(sys.getrefcount(ob), c)
+        # but other ints and strings are mortal
+        for ob in (int('257'), ''.join(['test_', 'mortal'])):
+            with self.subTest(ob=ob):
+                c = sys.getrefcount(ob)
+                refs = [ob] * 10
+                self.assertEqual(sys.getrefcount(ob), c + 10)
+
     def test_getframe(self):
         self.assertRaises(TypeError, sys._getframe, 42, 42)
         self.assertRaises(ValueError, sys._getframe, 2000000000)
@@ -534,7 +661,9 @@ class SysModuleTest(unittest.TestCase):
         INTERN_NUMRUNS += 1
         self.assertRaises(TypeError, sys.intern)
         s = "never interned before" + str(INTERN_NUMRUNS)
+        size = sys.getunicodeinternedsize()
         self.assertTrue(sys.intern(s) is s)
+        self.assertEqual(sys.getunicodeinternedsize(), size + 1)
         s2 = s.swapcase().swapcase()
         self.assertTrue(sys.intern(s2) is s)
 
@@ -589,6 +718,25 @@ class SysModuleTest(unittest.TestCase):
     def test_clear_type_cache(self):
         sys._clear_type_cache()
 
+    @test.support.cpython_only
+    def test_getcacheinfo(self):
+        info = sys._getcacheinfo()['type_cache']
+        self.assertEqual(set(info),
+                         {'size', 'hits', 'misses', 'collisions', 'resizes'})
+        for value in info.values():
+            self.assertIsInstance(value, int)
+            self.assertGreaterEqual(value, 0)
+        if info['size']:
+            self.assertEqual(info['size'] & (info['size'] - 1), 0)
+
+            class C:
+                attr = 1
+            hits = sys._getcacheinfo()['type_cache']['hits']
+            for _ in range(10):
+                getattr(C, 'attr')
+            info = sys._getcacheinfo()['type_cache']
+            self.assertGreater(info['hits'], hits)
+
     def test_ioencoding(self):
         env = dict(os.environ)
 
@@ -788,6 +936,67 @@ class SysModuleTest(unittest.TestCase):
         # The function has no parameter
         self.assertRaises(TypeError, sys._debugmallocstats, True)
 
+    @test.support.cpython_only
+    def test_malloc_stats(self):
+        stats = sys._malloc_stats()
+        if stats is None:
+            self.skipTest("pymalloc is not used")
+        size_classes = stats['size_classes']
+        self.assertGreater(stats['arenas'], 0)
+        self.assertGreaterEqual(stats['arenas_highwater'], stats['arenas'])
+        self.assertEqual(stats['arenas_allocated_total'],
+                         stats['arenas'] + stats['arenas_reclaimed']
+                         + stats['arenas_retained'])
+        total = sum(stats[key] for key in (
+            'allocated_bytes', 'cached_bytes', 'available_bytes',
+            'free_pool_bytes', 'pool_header_bytes', 'quantization_bytes',
+            'arena_alignment_bytes'))
+        self.assertEqual(total, stats['arenas'] * stats['arena_size'])
+        self.assertEqual(stats['allocated_bytes'],
+                         sum(size * blocks for size, (pools, blocks, avail, cached)
+                             in size_classes.items()))
+        self.assertGreater(stats['fragmentation'], 0.0)
+        self.assertLess(stats['fragmentation'], 1.0)
+        for size, (pools, blocks, avail, cached) in size_classes.items():
+            self.assertEqual(size % 8, 0)
+            self.assertGreater(pools, 0)
+            self.assertLessEqual((blocks + avail + cached) * size,
+                                 pools * stats['pool_size'])
+
+        # Freeing many objects of a size class leaves available blocks
+        # (debug hooks add their own overhead to the size of the blocks)
+        data = [bytes(200) for i in range(10000)]
+        before = sys._malloc_stats()['size_classes']
+        del data[::2]
+        after = sys._malloc_stats()['size_classes']
+        self.assertGreaterEqual(max(after[size][2] - before[size][2]
+                                    for size in after if size in before),
+                                4000)
+
+    @test.support.cpython_only
+    @unittest.skipUnless(support.with_pymalloc(), 'need pymalloc')
+    def test_mallocarenas(self):
+        code = textwrap.dedent("""
+            import sys
+            for i in range(3):
+                x = [str(j) for j in range(200000)]
+                del x
+            sys._debugmallocstats()
+        """)
+        ret, out, err = assert_python_ok('-c', code,
+            PYTHONMALLOCARENAS='size=1M,retain=2,madvise=1,hugepages=1')
+        self.assertIn(b"Arena options: size=1048576, retain=2, madvise=1",
+                      err)
+        self.assertRegex(err, rb"arenas \* 1048576 bytes/arena")
+        self.assertRegex(err, rb"# arenas reused +=  +[1-9]")
+
+        for opt in ('size=3M', 'size=128K', 'retain=1000', 'retain',
+                    'retain=-1', 'madvise=2', 'spam=1', 'retain=2,'):
+            with self.subTest(opt=opt):
+                ret, out, err = assert_python_failure(
+                    '-c', 'pass', PYTHONMALLOCARENAS=opt)
+                self.assertIn(b"PYTHONMALLOCARENAS: invalid option", err)
+
     @unittest.skipUnless(hasattr(sys, "getallocatedblocks"),
                          "sys.getallocatedblocks unavailable on this build")
     def test_getallocatedblocks(self):
@@ -829,6 +1038,37 @@ class SysModuleTest(unittest.TestCase):
         c = sys.getallocatedblocks()
         self.assertIn(c, range(b - 50, b + 50))
 
+    @test.support.cpython_only
+    def test_malloccaches(self):
+        import threading
+        self.assertRaises(TypeError, sys._setmalloccaches)
+        orig = sys._getmalloccaches()
+        self.assertIs(orig, False)
+
+        def churn():
+            for i in range(1000):
+                x = [str(j) for j in range(i % 50)]
+                del x
+
+        try:
+            sys._setmalloccaches(True)
+            self.assertIs(sys._getmalloccaches(), True)
+            churn()
+            threads = [threading.Thread(target=churn) for i in range(4)]
+            with threading_helper.start_threads(threads):
+                pass
+            gc.collect()
+            a = sys.getallocatedblocks()
+            sys._setmalloccaches(False)
+            self.assertIs(sys._getmalloccaches(), False)
+            gc.collect()
+            # The cached blocks are not counted as allocated
+            b = sys.getallocatedblocks()
+            self.assertIn(b, range(a - 50, a + 50))
+            churn()
+        finally:
+            sys._setmalloccaches(orig)
+
     def test_is_finalizing(self):
         self.assertIs(sys.is_finalizing(), False)
         # Don't use the atexit module because _Py_Finalizing is only set
@@ -1186,9 +1426,9 @@ class SizeofTest(unittest.TestCase):
         # empty dict
         check({}, size('nQ2P'))
         # dict
-        check({"a": 1}, size('nQ2P') + calcsize('2nP2n') + 8 + (8*2//3)*calcsize('n2P'))
+        check({"a": 1}, size('nQ2P') + calcsize('2nP2n') + 8 + 24 + (8*2//3)*calcsize('n2P'))
         longdict = {1:1, 2:2, 3:3, 4:4, 5:5, 6:6, 7:7, 8:8}
-        check(longdict, size('nQ2P') + calcsize('2nP2n') + 16 + (16*2//3)*calcsize('n2P'))
+        check(longdict, size('nQ2P') + calcsize('2nP2n') + 16 + 32 + (16*2//3)*calcsize('n2P'))
         # dictionary-keyview
         check({}.keys(), size('P'))
         # dictionary-valueview
@@ -1236,7 +1476,7 @@ class SizeofTest(unittest.TestCase):
         nfrees = len(x.f_code.co_freevars)
         extras = x.f_code.co_stacksize + x.f_code.co_nlocals +\
                   ncells + nfrees - 1
-        check(x, vsize('5P2c4P3ic' + CO_MAXBLOCKS*'3i' + 'P' + extras*'P'))
+        check(x, vsize('5P2c5P6i2c' + CO_MAXBLOCKS*'3i' + 'P' + extras*'P'))
         # function
         def func(): pass
         check(func, size('13P'))
@@ -1347,13 +1587,13 @@ class SizeofTest(unittest.TestCase):
                   '5P')
         class newstyleclass(object): pass
         # Separate block for PyDictKeysObject with 8 keys and 5 entries
-        check(newstyleclass, s + calcsize("2nP2n0P") + 8 + 5*calcsize("n2P"))
+        check(newstyleclass, s + calcsize("2nP2n0P") + 8 + 24 + 5*calcsize("n2P"))
         # dict with shared keys
         check(newstyleclass().__dict__, size('nQ2P') + 5*self.P)
         o = newstyleclass()
         o.a = o.b = o.c = o.d = o.e = o.f = o.g = o.h = 1
         # Separate block for PyDictKeysObject with 16 keys and 10 entries
-        check(newstyleclass, s + calcsize("2nP2n0P") + 16 + 10*calcsize("n2P"))
+        check(newstyleclass, s + calcsize("2nP2n0P") + 16 + 32 + 10*calcsize("n2P"))
         # dict with shared keys
         check(newstyleclass().__dict__, size('nQ2P') + 10*self.P)
         # unicode
@@ -141,6 +141,45 @@ test_bit_length(PyObject *self, PyObject *Py_UNUSED(args))
 }
 
 
+static int
+check_bit_ctz64(uint64_t x, int expected)
+{
+    // Use volatile to prevent the compiler to optimize out the whole test
+    volatile uint64_t u = x;
+    int n = _Py_bit_ctz64(u);
+    if (n != expected) {
+        PyErr_Format(PyExc_AssertionError,
+                     "_Py_bit_ctz64(%llu) returns %i, expected %i",
+                     (unsigned long long)x, n, expected);
+        return -1;
+    }
+    return 0;
+}
+
+
+static PyObject*
+test_bit_ctz64(PyObject *self, PyObject *Py_UNUSED(args))
+{
+#define CHECK(X, RESULT) \
+    do { \
+        if (check_bit_ctz64(X, RESULT) < 0) { \
+            return NULL; \
+        } \
+    } while (0)
+
+    CHECK(1, 0);
+    CHECK(0x1000, 12);
+    CHECK(0x54320, 5);
+    CHECK(0x80000000, 31);
+    CHECK(UINT64_C(0x100000000), 32);
+    CHECK(UINT64_C(0x8000000000000000), 63);
+    CHECK(UINT64_C(0xFFFFFFFFFFFFFFFF), 0);
+    Py_RETURN_NONE;
+
+#undef CHECK
+}
+
+
 #define TO_PTR(ch) ((void*)(uintptr_t)ch)
 #define FROM_PTR(ptr) ((uintptr_t)ptr)
 #define VALUE(key) (1 + ((int)(key) - 'a'))
@@ -237,6 +276,7 @@ static PyMethodDef TestMethods[] = {
     {"test_bswap", test_bswap, METH_NOARGS},
     {"test_popcount", test_popcount, METH_NOARGS},
     {"test_bit_length", test_bit_length, METH_NOARGS},
+    {"test_bit_ctz64", test_bit_ctz64, METH_NOARGS},
     {"test_hashtable", test_hashtable, METH_NOARGS},
     {NULL, NULL} /* sentinel */
 };
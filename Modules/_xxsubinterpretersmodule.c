@@ -276,6 +276,141 @@ _sharedexception_apply(_sharedexception *exc, PyObject *wrapperclass)
     }
 }
 
+/* shared buffers */
+
+/* A memoryview is shared with another interpreter without copying the
+   memory of its exporter.  The buffer is acquired in the sending
+   interpreter and it is only released there.  The cross-interpreter data
+   owns it until it is received; ownership is then handed off to a
+   SharedBuffer object, which exports the same memory to a memoryview in
+   the receiving interpreter. */
+
+typedef struct sharedbuffer {
+    PyObject_HEAD
+    Py_buffer *view;
+    int64_t interpid;  // the interpreter which acquired the buffer
+} sharedbuffer;
+
+static PyTypeObject SharedBuffertype;
+
+static void
+_sharedbuffer_free(void *arg)
+{
+    Py_buffer *view = (Py_buffer *)arg;
+    PyBuffer_Release(view);
+    PyMem_RawFree(view);
+}
+
+static void
+sharedbuffer_dealloc(sharedbuffer *self)
+{
+    // Release the buffer in the interpreter which acquired it.
+    _PyCrossInterpreterData data = {0};
+    data.data = self->view;
+    data.interp = self->interpid;
+    data.free = _sharedbuffer_free;
+
+    PyObject *exc, *value, *tb;
+    PyErr_Fetch(&exc, &value, &tb);
+    _PyCrossInterpreterData_Release(&data);
+    // XXX If that interpreter was already destroyed, the buffer leaks.
+    PyErr_Clear();
+    PyErr_Restore(exc, value, tb);
+
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static int
+sharedbuffer_getbuf(sharedbuffer *self, Py_buffer *view, int flags)
+{
+    if ((flags & PyBUF_WRITABLE) && self->view->readonly) {
+        PyErr_SetString(PyExc_BufferError, "shared buffer is read-only");
+        return -1;
+    }
+    if ((flags & PyBUF_STRIDES) != PyBUF_STRIDES
+            && !PyBuffer_IsContiguous(self->view, 'C')) {
+        PyErr_SetString(PyExc_BufferError,
+                        "shared buffer is not C-contiguous");
+        return -1;
+    }
+    // The buffer was acquired with PyBUF_FULL_RO: export it as is.
+    *view = *self->view;
+    Py_INCREF(self);
+    view->obj = (PyObject *)self;
+    view->internal = NULL;
+    return 0;
+}
+
+static PyBufferProcs sharedbuffer_as_buffer = {
+    (getbufferproc)sharedbuffer_getbuf,     /* bf_getbuffer */
+    NULL,                                   /* bf_releasebuffer */
+};
+
+PyDoc_STRVAR(sharedbuffer_doc,
+"Memory shared by another interpreter, exported through a memoryview.");
+
+static PyTypeObject SharedBuffertype = {
+    PyVarObject_HEAD_INIT(&PyType_Type, 0)
+    "_xxsubinterpreters.SharedBuffer",  /* tp_name */
+    sizeof(sharedbuffer),               /* tp_basicsize */
+    0,                                  /* tp_itemsize */
+    (destructor)sharedbuffer_dealloc,   /* tp_dealloc */
+    0,                                  /* tp_vectorcall_offset */
+    0,                                  /* tp_getattr */
+    0,                                  /* tp_setattr */
+    0,                                  /* tp_as_async */
+    0,                                  /* tp_repr */
+    0,                                  /* tp_as_number */
+    0,                                  /* tp_as_sequence */
+    0,                                  /* tp_as_mapping */
+    0,                                  /* tp_hash */
+    0,                                  /* tp_call */
+    0,                                  /* tp_str */
+    0,                                  /* tp_getattro */
+    0,                                  /* tp_setattro */
+    &sharedbuffer_as_buffer,            /* tp_as_buffer */
+    Py_TPFLAGS_DEFAULT,                 /* tp_flags */
+    sharedbuffer_doc,                   /* tp_doc */
+};
+
+static PyObject *
+_memoryview_from_xid(_PyCrossInterpreterData *data)
+{
+    sharedbuffer *self = PyObject_New(sharedbuffer, &SharedBuffertype);
+    if (self == NULL) {
+        return NULL;
+    }
+    // Hand the buffer off to the new object: the cross-interpreter data
+    // is left with nothing to release.
+    self->view = (Py_buffer *)data->data;
+    self->interpid = data->interp;
+    data->data = NULL;
+    data->free = NULL;
+
+    PyObject *view = PyMemoryView_FromObject((PyObject *)self);
+    Py_DECREF(self);
+    return view;
+}
+
+static int
+_memoryview_shared(PyObject *obj, _PyCrossInterpreterData *data)
+{
+    Py_buffer *view = PyMem_RawMalloc(sizeof(Py_buffer));
+    if (view == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    if (PyObject_GetBuffer(obj, view, PyBUF_FULL_RO) < 0) {
+        PyMem_RawFree(view);
+        return -1;
+    }
+    data->data = view;
+    data->obj = NULL;  // The buffer holds a reference to the exporter.
+    data->new_object = _memoryview_from_xid;
+    data->free = _sharedbuffer_free;
+    return 0;
+}
+
 
 /* channel-specific code ****************************************************/
 
@@ -1831,9 +1966,106 @@ interp_exceptions_init(PyObject *ns)
     return 0;
 }
 
+/* interpreters entered through run_string() */
+
+/* A thread running a script in another interpreter may release the GIL
+   of its own interpreter before the script starts executing (with
+   EXPERIMENTAL_ISOLATED_SUBINTERPRETERS), so the frame of the interpreter
+   alone does not tell whether it is in use.  Those interpreters are
+   tracked here instead. */
+
+struct _runningitem;
+
+typedef struct _runningitem {
+    int64_t interpid;
+    struct _runningitem *next;
+} _runningitem;
+
+static struct {
+    PyThread_type_lock mutex;
+    _runningitem *head;
+} _running = {NULL, NULL};
+
+static int
+_running_init(void)
+{
+    if (_running.mutex == NULL) {
+        _running.mutex = PyThread_allocate_lock();
+        if (_running.mutex == NULL) {
+            PyErr_SetString(PyExc_RuntimeError,
+                            "can't initialize mutex for running interpreters");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static _runningitem **
+_running_find(int64_t interpid)  // needs lock
+{
+    _runningitem **pitem = &_running.head;
+    while (*pitem != NULL && (*pitem)->interpid != interpid) {
+        pitem = &(*pitem)->next;
+    }
+    return pitem;
+}
+
+static int _ensure_not_running(PyInterpreterState *interp);
+
+/* Mark the interpreter as running.  Fail if it is already running. */
+static int
+_running_enter(PyInterpreterState *interp)
+{
+    if (_ensure_not_running(interp) < 0) {
+        return -1;
+    }
+    _runningitem *item = PyMem_RawMalloc(sizeof(_runningitem));
+    if (item == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    item->interpid = PyInterpreterState_GetID(interp);
+
+    PyThread_acquire_lock(_running.mutex, WAIT_LOCK);
+    _runningitem **pitem = _running_find(item->interpid);
+    int found = (*pitem != NULL);
+    if (!found) {
+        item->next = _running.head;
+        _running.head = item;
+    }
+    PyThread_release_lock(_running.mutex);
+
+    if (found) {
+        // Another thread entered it in the meantime.
+        PyMem_RawFree(item);
+        PyErr_Format(PyExc_RuntimeError, "interpreter already running");
+        return -1;
+    }
+    return 0;
+}
+
+static void
+_running_exit(PyInterpreterState *interp)
+{
+    PyThread_acquire_lock(_running.mutex, WAIT_LOCK);
+    _runningitem **pitem = _running_find(PyInterpreterState_GetID(interp));
+    _runningitem *item = *pitem;
+    assert(item != NULL);
+    *pitem = item->next;
+    PyThread_release_lock(_running.mutex);
+    PyMem_RawFree(item);
+}
+
 static int
 _is_running(PyInterpreterState *interp)
 {
+    PyThread_acquire_lock(_running.mutex, WAIT_LOCK);
+    int found = (*_running_find(PyInterpreterState_GetID(interp)) != NULL);
+    PyThread_release_lock(_running.mutex);
+    if (found) {
+        return 1;
+    }
+
     PyThreadState *tstate = PyInterpreterState_ThreadHead(interp);
     if (PyThreadState_Next(tstate) != NULL) {
         PyErr_SetString(PyExc_RuntimeError,
@@ -1926,32 +2158,47 @@ error:
     return -1;
 }
 
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+/* Each interpreter has its own GIL.  Release the GIL of the current
+   interpreter before taking the one of tstate's interpreter, so that
+   threads running different interpreters never wait on each other and
+   a thread never holds two GILs.  Return the previous thread state. */
+static PyThreadState *
+_switch_gil(PyThreadState *tstate)
+{
+    PyThreadState *save_tstate = PyEval_SaveThread();
+    PyEval_RestoreThread(tstate);
+    return save_tstate;
+}
+#endif
+
 static int
 _run_script_in_interpreter(PyInterpreterState *interp, const char *codestr,
                            PyObject *shareables)
 {
-    if (_ensure_not_running(interp) < 0) {
+    _sharedns *shared = _get_shared_ns(shareables);
+    if (shared == NULL && PyErr_Occurred()) {
         return -1;
     }
 
-    _sharedns *shared = _get_shared_ns(shareables);
-    if (shared == NULL && PyErr_Occurred()) {
+    if (_running_enter(interp) < 0) {
+        if (shared != NULL) {
+            _sharedns_free(shared);
+        }
         return -1;
     }
 
 #ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
     // Switch to interpreter.
     PyThreadState *new_tstate = PyInterpreterState_ThreadHead(interp);
-    PyThreadState *save1 = PyEval_SaveThread();
-
-    (void)PyThreadState_Swap(new_tstate);
+    PyThreadState *save_tstate = _switch_gil(new_tstate);
 
     // Run the script.
     _sharedexception *exc = NULL;
     int result = _run_script(interp, codestr, shared, &exc);
 
     // Switch back.
-    PyEval_RestoreThread(save1);
+    _switch_gil(save_tstate);
 #else
     // Switch to interpreter.
     PyThreadState *save_tstate = NULL;
@@ -1972,6 +2219,8 @@ _run_script_in_interpreter(PyInterpreterState *interp, const char *codestr,
     }
 #endif
 
+    _running_exit(interp);
+
     // Propagate any exception out to the caller.
     if (exc != NULL) {
         _sharedexception_apply(exc, RunFailedError);
@@ -2005,6 +2254,9 @@ _init_globals(void)
     if (_channels_init(&_globals.channels) != 0) {
         return -1;
     }
+    if (_running_init() != 0) {
+        return -1;
+    }
     return 0;
 }
 
@@ -2028,6 +2280,13 @@ interp_create(PyObject *self, PyObject *args, PyObject *kwds)
     PyThreadState *save_tstate = PyThreadState_Swap(NULL);
     // XXX Possible GILState issues?
     PyThreadState *tstate = _Py_NewInterpreter(isolated);
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    if (tstate != NULL) {
+        // Release the GIL of the new interpreter: the GIL of the current
+        // interpreter is still held by save_tstate.
+        PyEval_SaveThread();
+    }
+#endif
     PyThreadState_Swap(save_tstate);
     if (tstate == NULL) {
         /* Since no new thread state was created, there is no exception to
@@ -2039,10 +2298,16 @@ interp_create(PyObject *self, PyObject *args, PyObject *kwds)
     PyInterpreterState *interp = PyThreadState_GetInterpreter(tstate);
     PyObject *idobj = _PyInterpreterState_GetIDObject(interp);
     if (idobj == NULL) {
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+        save_tstate = _switch_gil(tstate);
+        Py_EndInterpreter(tstate);
+        PyEval_RestoreThread(save_tstate);
+#else
         // XXX Possible GILState issues?
         save_tstate = PyThreadState_Swap(tstate);
         Py_EndInterpreter(tstate);
         PyThreadState_Swap(save_tstate);
+#endif
         return NULL;
     }
     _PyInterpreterState_RequireIDRef(interp, 1);
@@ -2092,10 +2357,17 @@ interp_destroy(PyObject *self, PyObject *args, PyObject *kwds)
 
     // Destroy the interpreter.
     PyThreadState *tstate = PyInterpreterState_ThreadHead(interp);
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    PyThreadState *save_tstate = _switch_gil(tstate);
+    Py_EndInterpreter(tstate);
+    // Py_EndInterpreter() cleared the current thread state
+    PyEval_RestoreThread(save_tstate);
+#else
     // XXX Possible GILState issues?
     PyThreadState *save_tstate = PyThreadState_Swap(tstate);
     Py_EndInterpreter(tstate);
     PyThreadState_Swap(save_tstate);
+#endif
 
     Py_RETURN_NONE;
 }
@@ -2637,6 +2909,9 @@ PyInit__xxsubinterpreters(void)
     if (PyType_Ready(&ChannelIDtype) != 0) {
         return NULL;
     }
+    if (PyType_Ready(&SharedBuffertype) != 0) {
+        return NULL;
+    }
 
     /* Create the module */
     PyObject *module = PyModule_Create(&interpretersmodule);
@@ -2666,6 +2941,10 @@ PyInit__xxsubinterpreters(void)
     if (_PyCrossInterpreterData_RegisterClass(&ChannelIDtype, _channelid_shared)) {
         return NULL;
     }
+    if (_PyCrossInterpreterData_RegisterClass(&PyMemoryView_Type,
+                                              _memoryview_shared)) {
+        return NULL;
+    }
 
     return module;
 }
@@ -303,26 +303,77 @@ PyDoc_STRVAR(gc_is_finalized__doc__,
 #define GC_IS_FINALIZED_METHODDEF    \
     {"is_finalized", (PyCFunction)gc_is_finalized, METH_O, gc_is_finalized__doc__},
 
+PyDoc_STRVAR(gc_defer_refcount__doc__,
+"defer_refcount($module, obj, /)\n"
+"--\n"
+"\n"
+"Defer the reference counting of the object to the garbage collector.\n"
+"\n"
+"Its reference count is no longer stored in the object, which saves writes to\n"
+"its memory when long-lived objects like functions, classes and code objects\n"
+"are used by several threads or forked processes.  The object is deallocated\n"
+"by the next collection once it is no longer referenced.\n"
+"\n"
+"Only objects supported by the collector and code objects can be deferred.");
+
+#define GC_DEFER_REFCOUNT_METHODDEF    \
+    {"defer_refcount", (PyCFunction)gc_defer_refcount, METH_O, gc_defer_refcount__doc__},
+
+PyDoc_STRVAR(gc_is_deferred__doc__,
+"is_deferred($module, obj, /)\n"
+"--\n"
+"\n"
+"Returns true if the reference counting of the object is deferred.");
+
+#define GC_IS_DEFERRED_METHODDEF    \
+    {"is_deferred", (PyCFunction)gc_is_deferred, METH_O, gc_is_deferred__doc__},
+
 PyDoc_STRVAR(gc_freeze__doc__,
-"freeze($module, /)\n"
+"freeze($module, /, *, immortal=False)\n"
 "--\n"
 "\n"
 "Freeze all current tracked objects and ignore them for future collections.\n"
 "\n"
 "This can be used before a POSIX fork() call to make the gc copy-on-write friendly.\n"
 "Note: collection before a POSIX fork() call may free pages for future allocation\n"
-"which can cause copy-on-write.");
+"which can cause copy-on-write.\n"
+"\n"
+"If immortal is true, the frozen objects and the untracked objects they refer\n"
+"to also become immortal: they are never deallocated, and their reference\n"
+"counts are no longer updated.");
 
 #define GC_FREEZE_METHODDEF    \
-    {"freeze", (PyCFunction)gc_freeze, METH_NOARGS, gc_freeze__doc__},
+    {"freeze", (PyCFunction)(void(*)(void))gc_freeze, METH_FASTCALL|METH_KEYWORDS, gc_freeze__doc__},
 
 static PyObject *
-gc_freeze_impl(PyObject *module);
+gc_freeze_impl(PyObject *module, int immortal);
 
 static PyObject *
-gc_freeze(PyObject *module, PyObject *Py_UNUSED(ignored))
+gc_freeze(PyObject *module, PyObject *const *args, Py_ssize_t nargs, PyObject *kwnames)
 {
-    return gc_freeze_impl(module);
+    PyObject *return_value = NULL;
+    static const char * const _keywords[] = {"immortal", NULL};
+    static _PyArg_Parser _parser = {NULL, _keywords, "freeze", 0};
+    PyObject *argsbuf[1];
+    Py_ssize_t noptargs = nargs + (kwnames ? PyTuple_GET_SIZE(kwnames) : 0) - 0;
+    int immortal = 0;
+
+    args = _PyArg_UnpackKeywords(args, nargs, NULL, kwnames, &_parser, 0, 0, 0, argsbuf);
+    if (!args) {
+        goto exit;
+    }
+    if (!noptargs) {
+        goto skip_optional_kwonly;
+    }
+    immortal = PyObject_IsTrue(args[0]);
+    if (immortal < 0) {
+        goto exit;
+    }
+skip_optional_kwonly:
+    return_value = gc_freeze_impl(module, immortal);
+
+exit:
+    return return_value;
 }
 
 PyDoc_STRVAR(gc_unfreeze__doc__,
@@ -372,4 +423,132 @@ gc_get_freeze_count(PyObject *module, PyObject *Py_UNUSED(ignored))
 exit:
     return return_value;
 }
-/*[clinic end generated code: output=61e15f3a549f3ab5 input=a9049054013a1b77]*/
+
+PyDoc_STRVAR(gc_set_incremental__doc__,
+"set_incremental($module, pause, /)\n"
+"--\n"
+"\n"
+"Set the pause targeted by incremental collections of the oldest generation.\n"
+"\n"
+"The pause is in seconds.  When it is positive, the oldest generation is\n"
+"collected in steps that each take about that long, instead of all at once.\n"
+"A pause of 0 disables incremental collections.");
+
+#define GC_SET_INCREMENTAL_METHODDEF    \
+    {"set_incremental", (PyCFunction)gc_set_incremental, METH_O, gc_set_incremental__doc__},
+
+static PyObject *
+gc_set_incremental_impl(PyObject *module, double pause);
+
+static PyObject *
+gc_set_incremental(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    double pause;
+
+    if (PyFloat_CheckExact(arg)) {
+        pause = PyFloat_AS_DOUBLE(arg);
+    }
+    else
+    {
+        pause = PyFloat_AsDouble(arg);
+        if (pause == -1.0 && PyErr_Occurred()) {
+            goto exit;
+        }
+    }
+    return_value = gc_set_incremental_impl(module, pause);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(gc_get_incremental__doc__,
+"get_incremental($module, /)\n"
+"--\n"
+"\n"
+"Return the pause targeted by incremental collections of the oldest generation.\n"
+"\n"
+"0.0 means that incremental collections are disabled.");
+
+#define GC_GET_INCREMENTAL_METHODDEF    \
+    {"get_incremental", (PyCFunction)gc_get_incremental, METH_NOARGS, gc_get_incremental__doc__},
+
+static double
+gc_get_incremental_impl(PyObject *module);
+
+static PyObject *
+gc_get_incremental(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    PyObject *return_value = NULL;
+    double _return_value;
+
+    _return_value = gc_get_incremental_impl(module);
+    if ((_return_value == -1.0) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyFloat_FromDouble(_return_value);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(gc_set_parallel__doc__,
+"set_parallel($module, threads, /)\n"
+"--\n"
+"\n"
+"Set the number of threads examining the objects of large collections.\n"
+"\n"
+"The threads propagate reachability between the objects, finalization and\n"
+"the destruction of garbage stay on the collecting thread.  1 makes\n"
+"collections serial.");
+
+#define GC_SET_PARALLEL_METHODDEF    \
+    {"set_parallel", (PyCFunction)gc_set_parallel, METH_O, gc_set_parallel__doc__},
+
+static PyObject *
+gc_set_parallel_impl(PyObject *module, int threads);
+
+static PyObject *
+gc_set_parallel(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int threads;
+
+    threads = _PyLong_AsInt(arg);
+    if (threads == -1 && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = gc_set_parallel_impl(module, threads);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(gc_get_parallel__doc__,
+"get_parallel($module, /)\n"
+"--\n"
+"\n"
+"Return the number of threads examining the objects of large collections.");
+
+#define GC_GET_PARALLEL_METHODDEF    \
+    {"get_parallel", (PyCFunction)gc_get_parallel, METH_NOARGS, gc_get_parallel__doc__},
+
+static int
+gc_get_parallel_impl(PyObject *module);
+
+static PyObject *
+gc_get_parallel(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    PyObject *return_value = NULL;
+    int _return_value;
+
+    _return_value = gc_get_parallel_impl(module);
+    if ((_return_value == -1) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyLong_FromLong((long)_return_value);
+
+exit:
+    return return_value;
+}
+/*[clinic end generated code: output=a144e9c6f48be025 input=a9049054013a1b77]*/
@@ -24,12 +24,15 @@
 */
 
 #include "Python.h"
+#include "pycore_atomic.h"      // _Py_atomic_fetch_add_uintptr()
+#include "pycore_bitutils.h"    // _Py_bit_length()
 #include "pycore_context.h"
 #include "pycore_initconfig.h"
 #include "pycore_interp.h"      // PyInterpreterState.gc
 #include "pycore_object.h"
 #include "pycore_pyerrors.h"
 #include "pycore_pystate.h"     // _PyThreadState_GET()
+#include "frameobject.h"        // PyFrameObject.f_back
 #include "pydtrace.h"
 #include "pytime.h"             // _PyTime_GetMonotonicClock()
 
@@ -69,6 +72,11 @@ module gc
 // most gc_list_* functions for it.
 #define NEXT_MASK_UNREACHABLE  (1)
 
+// Bit 1 of _gc_next is the OLD_VISITED flag of incremental collections of
+// the oldest generation.  Unlike the other flags it persists between
+// collections: see "Incremental collection of the oldest generation" below.
+#define NEXT_MASK_OLD_VISITED  _PyGC_NEXT_MASK_OLD_VISITED
+
 /* Get an object's GC head */
 #define AS_GC(o) ((PyGC_Head *)(o)-1)
 
@@ -87,6 +95,18 @@ gc_clear_collecting(PyGC_Head *g)
     g->_gc_prev &= ~PREV_MASK_COLLECTING;
 }
 
+static inline int
+gc_is_old_visited(PyGC_Head *g)
+{
+    return (g->_gc_next & NEXT_MASK_OLD_VISITED) != 0;
+}
+
+static inline void
+gc_set_old_visited(PyGC_Head *g)
+{
+    g->_gc_next |= NEXT_MASK_OLD_VISITED;
+}
+
 static inline Py_ssize_t
 gc_get_refs(PyGC_Head *g)
 {
@@ -128,6 +148,16 @@ gc_decref(PyGC_Head *g)
 
 #define GEN_HEAD(gcstate, n) (&(gcstate)->generations[n].head)
 
+/* Bounds and initial value of the number of objects of the oldest generation
+   examined by each step of an incremental collection */
+#define INCREMENT_SIZE_MIN      1000
+#define INCREMENT_SIZE_MAX      (PY_SSIZE_T_MAX / 16)
+#define INCREMENT_SIZE_INITIAL  10000
+/* Number of objects moved from old_unmarked to old_pending, and of objects
+   of old_marking traversed, per step, in units of increment_size */
+#define UNMARK_FACTOR           8
+#define MARK_FACTOR             4
+
 
 static GCState *
 get_gc_state(void)
@@ -158,6 +188,25 @@ _PyGC_InitState(GCState *gcstate)
            (uintptr_t)&gcstate->permanent_generation.head}, 0, 0
     };
     gcstate->permanent_generation = permanent_generation;
+
+    gcstate->incremental_pause = 0.0;
+    PyGC_Head old_unmarked = {(uintptr_t)&gcstate->old_unmarked,
+                              (uintptr_t)&gcstate->old_unmarked};
+    gcstate->old_unmarked = old_unmarked;
+    PyGC_Head old_pending = {(uintptr_t)&gcstate->old_pending,
+                             (uintptr_t)&gcstate->old_pending};
+    gcstate->old_pending = old_pending;
+    PyGC_Head old_marking = {(uintptr_t)&gcstate->old_marking,
+                             (uintptr_t)&gcstate->old_marking};
+    gcstate->old_marking = old_marking;
+    gcstate->increment_size = INCREMENT_SIZE_INITIAL;
+    gcstate->incremental_survivors = 0;
+    gcstate->parallel_threads = 1;
+    gcstate->deferred = NULL;
+    gcstate->deferred_refcnt = NULL;
+    gcstate->deferred_size = 0;
+    gcstate->deferred_free = -1;
+    gcstate->deferred_count = 0;
 }
 
 
@@ -224,6 +273,13 @@ NEXT_MASK_UNREACHABLE
     The flag is unset and the object is moved back to "reachable" set.
 
     move_legacy_finalizers() will remove this flag from "unreachable" set.
+
+NEXT_MASK_OLD_VISITED
+    Set on objects which the current incremental collection of the oldest
+    generation has already examined, and on objects of the permanent
+    generation.  _PyGCHead_SET_NEXT() preserves it, so it survives the
+    object being moved between lists.  It may be set on objects of "young"
+    in move_unreachable(), but never on objects in "unreachable".
 */
 
 /*** list functions ***/
@@ -335,6 +391,21 @@ gc_list_clear_collecting(PyGC_Head *collectable)
     }
 }
 
+/* Mark all objects in the list as visited by the incremental collection of
+ * the oldest generation.  Return their number.
+ */
+static Py_ssize_t
+gc_list_set_old_visited(PyGC_Head *list)
+{
+    PyGC_Head *gc;
+    Py_ssize_t n = 0;
+    for (gc = GC_NEXT(list); gc != list; gc = GC_NEXT(gc)) {
+        gc_set_old_visited(gc);
+        n++;
+    }
+    return n;
+}
+
 /* Append objects in a GC list to a Python list.
  * Return 0 if all OK, < 0 if error (out of memory for list)
  */
@@ -395,7 +466,8 @@ validate_list(PyGC_Head *head, enum flagstates flags)
     PyGC_Head *gc = GC_NEXT(head);
     while (gc != head) {
         PyGC_Head *trueprev = GC_PREV(gc);
-        PyGC_Head *truenext = (PyGC_Head *)(gc->_gc_next  & ~NEXT_MASK_UNREACHABLE);
+        PyGC_Head *truenext = (PyGC_Head *)(gc->_gc_next
+            & ~(NEXT_MASK_UNREACHABLE | NEXT_MASK_OLD_VISITED));
         assert(truenext != NULL);
         assert(trueprev == prev);
         assert((gc->_gc_prev & PREV_MASK_COLLECTING) == prev_value);
@@ -412,15 +484,328 @@ validate_list(PyGC_Head *head, enum flagstates flags)
 /*** end of list stuff ***/
 
 
+/*
+Deferred reference counts
+-------------------------
+
+gc.defer_refcount() hands the reference count of an object over to the
+collector: the object gets an id, its reference count moves to
+gcstate->deferred_refcnt[id], and its ob_refcnt is set to _Py_DEFERRED_BIT
+plus the id.  From then on, Py_INCREF() and Py_DECREF() call
+_Py_IncRefDeferred() and _Py_DecRefDeferred(), which only update the
+tstate->deferred_refcnt table of the current thread: the header of the
+object is no longer written to, and threads using the same objects no longer
+write to the same cache lines.
+
+A deferred object is not deallocated when its last reference goes away,
+since no thread knows the total.  Each collection first merges the tables
+of the threads into gcstate->deferred_refcnt (deferred_merge()), then
+deallocates the deferred objects whose count is zero (deferred_collect()).
+The counts are then exact until Python code runs again, so that
+update_refs() can use them.  The deferred objects found unreachable get
+their reference count back (deferred_restore()), after which the garbage is
+handled as usual.
+
+Only objects allocated by an interpreter can be deferred: objects tracked by
+the collector, and code objects.
+*/
+
+static inline Py_ssize_t
+deferred_id(PyObject *op)
+{
+    return op->ob_refcnt & (_Py_DEFERRED_BIT - 1);
+}
+
+/* Grow the table of tstate to the size of the tables of its interpreter.
+   Return -1 on memory error. */
+static int
+deferred_resize_thread(PyThreadState *tstate)
+{
+    Py_ssize_t size = tstate->interp->gc.deferred_size;
+    Py_ssize_t *refcnt = PyMem_RawRealloc(tstate->deferred_refcnt,
+                                          size * sizeof(Py_ssize_t));
+    if (refcnt == NULL) {
+        return -1;
+    }
+    memset(refcnt + tstate->deferred_refcnt_size, 0,
+           (size - tstate->deferred_refcnt_size) * sizeof(Py_ssize_t));
+    tstate->deferred_refcnt = refcnt;
+    tstate->deferred_refcnt_size = size;
+    return 0;
+}
+
+/* deferred_add() when the table of the thread is too small for id. */
+static _Py_NO_INLINE void
+deferred_add_slow(PyThreadState *tstate, Py_ssize_t id, Py_ssize_t n)
+{
+    PyInterpreterState *interp;
+    if (tstate != NULL) {
+        if (tstate->deferred_refcnt_size >= 0
+            && deferred_resize_thread(tstate) == 0)
+        {
+            tstate->deferred_refcnt[id] += n;
+            return;
+        }
+        interp = tstate->interp;
+    }
+    else {
+        interp = _PyRuntime.interpreters.main;
+    }
+    /* The thread state is cleared, or out of memory */
+    interp->gc.deferred_refcnt[id] += n;
+}
+
+static inline void
+deferred_add(PyObject *op, Py_ssize_t n)
+{
+    Py_ssize_t id = deferred_id(op);
+    PyThreadState *tstate = _PyThreadState_GET();
+    if (tstate != NULL && id < tstate->deferred_refcnt_size) {
+        tstate->deferred_refcnt[id] += n;
+    }
+    else {
+        deferred_add_slow(tstate, id, n);
+    }
+}
+
+void
+_Py_IncRefDeferred(PyObject *op)
+{
+    deferred_add(op, 1);
+}
+
+void
+_Py_DecRefDeferred(PyObject *op)
+{
+    deferred_add(op, -1);
+}
+
+/* Add the changes made by tstate to the counts of its interpreter. */
+static void
+deferred_merge_thread(GCState *gcstate, PyThreadState *tstate)
+{
+    Py_ssize_t *refcnt = tstate->deferred_refcnt;
+    for (Py_ssize_t i = 0; i < tstate->deferred_refcnt_size; i++) {
+        gcstate->deferred_refcnt[i] += refcnt[i];
+        refcnt[i] = 0;
+    }
+}
+
+/* Add the changes made by all the threads of interp to its counts. */
+static void
+deferred_merge(PyInterpreterState *interp)
+{
+    /* Like HEAD_LOCK() in pystate.c: threads states may be added and
+       removed without the GIL. */
+    PyThread_acquire_lock(_PyRuntime.interpreters.mutex, WAIT_LOCK);
+    for (PyThreadState *p = interp->tstate_head; p != NULL; p = p->next) {
+        deferred_merge_thread(&interp->gc, p);
+    }
+    PyThread_release_lock(_PyRuntime.interpreters.mutex);
+}
+
+/* Allocate an id for op.  Return -1 on memory error. */
+static Py_ssize_t
+deferred_alloc(GCState *gcstate, PyObject *op)
+{
+    if (gcstate->deferred_free < 0) {
+        Py_ssize_t size = gcstate->deferred_size;
+        Py_ssize_t new_size = size ? size * 2 : 64;
+        if (new_size > PY_SSIZE_T_MAX / (Py_ssize_t)sizeof(Py_ssize_t)) {
+            return -1;
+        }
+        PyObject **deferred = PyMem_RawRealloc(
+            gcstate->deferred, new_size * sizeof(PyObject *));
+        if (deferred == NULL) {
+            return -1;
+        }
+        gcstate->deferred = deferred;
+        Py_ssize_t *refcnt = PyMem_RawRealloc(
+            gcstate->deferred_refcnt, new_size * sizeof(Py_ssize_t));
+        if (refcnt == NULL) {
+            return -1;
+        }
+        gcstate->deferred_refcnt = refcnt;
+        for (Py_ssize_t id = new_size - 1; id >= size; id--) {
+            deferred[id] = NULL;
+            refcnt[id] = gcstate->deferred_free;
+            gcstate->deferred_free = id;
+        }
+        gcstate->deferred_size = new_size;
+    }
+    Py_ssize_t id = gcstate->deferred_free;
+    gcstate->deferred_free = gcstate->deferred_refcnt[id];
+    gcstate->deferred[id] = op;
+    gcstate->deferred_count++;
+    return id;
+}
+
+/* Free the id of a deferred object.  The changes of the threads must have
+   been merged, so that they are all zero for the id. */
+static void
+deferred_release(GCState *gcstate, Py_ssize_t id)
+{
+    gcstate->deferred[id] = NULL;
+    gcstate->deferred_refcnt[id] = gcstate->deferred_free;
+    gcstate->deferred_free = id;
+    gcstate->deferred_count--;
+}
+
+/* Defer the reference count of op.  Return -1 on memory error. */
+static int
+deferred_set(GCState *gcstate, PyObject *op)
+{
+    assert(!_Py_IsImmortal(op) && !_Py_IsDeferred(op));
+    Py_ssize_t id = deferred_alloc(gcstate, op);
+    if (id < 0) {
+        return -1;
+    }
+    gcstate->deferred_refcnt[id] = Py_REFCNT(op);
+#ifdef Py_REF_DEBUG
+    _Py_RefTotal -= Py_REFCNT(op);
+#endif
+    Py_SET_REFCNT(op, _Py_DEFERRED_BIT | id);
+    return 0;
+}
+
+/* Give its reference count back to op, a deferred object whose changes
+   have been merged. */
+static void
+deferred_restore(GCState *gcstate, PyObject *op)
+{
+    Py_ssize_t id = deferred_id(op);
+    Py_ssize_t refcnt = gcstate->deferred_refcnt[id];
+    deferred_release(gcstate, id);
+#ifdef Py_REF_DEBUG
+    _Py_RefTotal += refcnt;
+#endif
+    Py_SET_REFCNT(op, refcnt);
+}
+
+/* Merge the changes of the threads, and deallocate the deferred objects
+   which are no longer referenced.  Deallocations can run any code, which
+   may release references to other deferred objects or let other threads
+   run: repeat until no deferred object is freed, after which the merged
+   counts are exact. */
+static void
+deferred_collect(PyThreadState *tstate)
+{
+    GCState *gcstate = &tstate->interp->gc;
+    if (gcstate->deferred_count == 0) {
+        return;
+    }
+    int found;
+    do {
+        deferred_merge(tstate->interp);
+        /* Without running any code, turn the unreferenced objects into
+           ordinary objects owned by this function, and mark their ids
+           with -1... */
+        found = 0;
+        for (Py_ssize_t id = 0; id < gcstate->deferred_size; id++) {
+            PyObject *op = gcstate->deferred[id];
+            if (op != NULL && gcstate->deferred_refcnt[id] == 0) {
+#ifdef Py_REF_DEBUG
+                _Py_RefTotal++;
+#endif
+                Py_SET_REFCNT(op, 1);
+                gcstate->deferred_refcnt[id] = -1;
+                found = 1;
+            }
+        }
+        /* ... then release them.  The tables may be resized meanwhile, but
+           the ids of these objects stay allocated until then. */
+        for (Py_ssize_t id = 0; found && id < gcstate->deferred_size; id++) {
+            PyObject *op = gcstate->deferred[id];
+            if (op != NULL && gcstate->deferred_refcnt[id] == -1) {
+                deferred_release(gcstate, id);
+                Py_DECREF(op);
+            }
+        }
+    } while (found);
+}
+
+/* Restore the reference count of the deferred objects of `unreachable`. */
+static void
+deferred_restore_unreachable(GCState *gcstate, PyGC_Head *unreachable)
+{
+    for (PyGC_Head *gc = GC_NEXT(unreachable); gc != unreachable;
+         gc = GC_NEXT(gc))
+    {
+        PyObject *op = FROM_GC(gc);
+        if (_Py_IsDeferred(op)) {
+            deferred_restore(gcstate, op);
+        }
+    }
+}
+
+/* Give back their reference count to all the deferred objects of the
+   interpreter of tstate, after deallocating those no longer referenced. */
+void
+_PyGC_UndeferAll(PyThreadState *tstate)
+{
+    GCState *gcstate = &tstate->interp->gc;
+    deferred_collect(tstate);
+    for (Py_ssize_t id = 0; id < gcstate->deferred_size; id++) {
+        PyObject *op = gcstate->deferred[id];
+        if (op != NULL) {
+            deferred_restore(gcstate, op);
+        }
+    }
+}
+
+/* Give its reference count back to the deferred object op. */
+void
+_PyGC_Undefer(PyObject *op)
+{
+    PyInterpreterState *interp = _PyInterpreterState_GET();
+    assert(_Py_IsDeferred(op));
+    deferred_merge(interp);
+    deferred_restore(&interp->gc, op);
+}
+
+/* Return the reference count of the deferred object op. */
+Py_ssize_t
+_PyGC_GetDeferredRefcnt(PyObject *op)
+{
+    PyInterpreterState *interp = _PyInterpreterState_GET();
+    assert(_Py_IsDeferred(op));
+    deferred_merge(interp);
+    return interp->gc.deferred_refcnt[deferred_id(op)];
+}
+
+/* Called by PyThreadState_Clear(): merge the changes of the thread, and
+   update the counts of the interpreter directly from now on. */
+void
+_PyGC_ClearThreadState(PyThreadState *tstate)
+{
+    if (tstate->deferred_refcnt_size > 0) {
+        deferred_merge_thread(&tstate->interp->gc, tstate);
+    }
+    PyMem_RawFree(tstate->deferred_refcnt);
+    tstate->deferred_refcnt = NULL;
+    tstate->deferred_refcnt_size = -1;
+}
+
+/* The reference count of op: the merged count if op is deferred. */
+static inline Py_ssize_t
+gc_refcnt(GCState *gcstate, PyObject *op)
+{
+    if (_Py_IsDeferred(op)) {
+        return gcstate->deferred_refcnt[deferred_id(op)];
+    }
+    return Py_REFCNT(op);
+}
+
 /* Set all gc_refs = ob_refcnt.  After this, gc_refs is > 0 and
  * PREV_MASK_COLLECTING bit is set for all objects in containers.
  */
 static void
 update_refs(PyGC_Head *containers)
 {
+    GCState *gcstate = get_gc_state();
     PyGC_Head *gc = GC_NEXT(containers);
     for (; gc != containers; gc = GC_NEXT(gc)) {
-        gc_reset_refs(gc, Py_REFCNT(FROM_GC(gc)));
+        gc_reset_refs(gc, gc_refcnt(gcstate, FROM_GC(gc)));
         /* Python's cyclic gc should never see an incoming refcount
          * of 0:  if something decref'ed to 0, it should have been
          * deallocated immediately at that time.
@@ -605,7 +990,7 @@ move_unreachable(PyGC_Head *young, PyGC_Head *unreachable)
              */
             // Move gc to unreachable.
             // No need to gc->next->prev = prev because it is single linked.
-            prev->_gc_next = gc->_gc_next;
+            _PyGCHead_SET_NEXT(prev, GC_NEXT(gc));
 
             // We can't use gc_list_append() here because we use
             // NEXT_MASK_UNREACHABLE here.
@@ -620,7 +1005,7 @@ move_unreachable(PyGC_Head *young, PyGC_Head *unreachable)
             gc->_gc_next = (NEXT_MASK_UNREACHABLE | (uintptr_t)unreachable);
             unreachable->_gc_prev = (uintptr_t)gc;
         }
-        gc = (PyGC_Head*)prev->_gc_next;
+        gc = GC_NEXT(prev);
     }
     // young->_gc_prev must be last element remained in the list.
     young->_gc_prev = (uintptr_t)prev;
@@ -1051,9 +1436,13 @@ show_stats_each_generations(GCState *gcstate)
     size_t pos = 0;
 
     for (int i = 0; i < NUM_GENERATIONS && pos < sizeof(buf); i++) {
-        pos += PyOS_snprintf(buf+pos, sizeof(buf)-pos,
-                             " %zd",
-                             gc_list_size(GEN_HEAD(gcstate, i)));
+        Py_ssize_t size = gc_list_size(GEN_HEAD(gcstate, i));
+        if (i == NUM_GENERATIONS - 1) {
+            size += gc_list_size(&gcstate->old_unmarked);
+            size += gc_list_size(&gcstate->old_marking);
+            size += gc_list_size(&gcstate->old_pending);
+        }
+        pos += PyOS_snprintf(buf+pos, sizeof(buf)-pos, " %zd", size);
     }
 
     PySys_FormatStderr(
@@ -1062,122 +1451,851 @@ show_stats_each_generations(GCState *gcstate)
         buf, gc_list_size(&gcstate->permanent_generation.head));
 }
 
-/* Deduce which objects among "base" are unreachable from outside the list
-   and move them to 'unreachable'. The process consist in the following steps:
-
-1. Copy all reference counts to a different field (gc_prev is used to hold
-   this copy to save memory).
-2. Traverse all objects in "base" and visit all referred objects using
-   "tp_traverse" and for every visited object, subtract 1 to the reference
-   count (the one that we copied in the previous step). After this step, all
-   objects that can be reached directly from outside must have strictly positive
-   reference count, while all unreachable objects must have a count of exactly 0.
-3. Identify all unreachable objects (the ones with 0 reference count) and move
-   them to the "unreachable" list. This step also needs to move back to "base" all
-   objects that were initially marked as unreachable but are referred transitively
-   by the reachable objects (the ones with strictly positive reference count).
-
-Contracts:
+/* Add the time elapsed since *t to *total, and set *t to the current time. */
+static inline void
+gc_time_phase(_PyTime_t *t, _PyTime_t *total)
+{
+    _PyTime_t now = _PyTime_GetPerfCounter();
+    *total += now - *t;
+    *t = now;
+}
 
-    * The "base" has to be a valid list with no mask set.
+/* Account for a collection which paused the program for `pause`. */
+static void
+gc_record_pause(struct gc_generation_stats *stats, _PyTime_t pause)
+{
+    _PyTime_t us = _PyTime_AsMicroseconds(pause, _PyTime_ROUND_FLOOR);
+    int bucket = 0;
+    if (us > 0) {
+        bucket = Py_MIN(_Py_bit_length((unsigned long)us),
+                        NUM_PAUSE_BUCKETS - 1);
+    }
+    stats->time += pause;
+    stats->pauses[bucket]++;
+}
 
-    * The "unreachable" list must be uninitialized (this function calls
-      gc_list_init over 'unreachable').
+#ifdef _Py_ATOMIC_HAVE_RMW
+/*
+Parallel collections
+--------------------
+
+When gc.set_parallel() asks for several threads, deduce_unreachable() splits
+the work of large collections between the collecting thread and helper
+threads started for the collection.  Copying the reference counts,
+subtracting the internal references and propagating reachability only call
+tp_traverse and never run Python code, so the helpers need neither the GIL
+nor a thread state: the collecting thread holds the GIL meanwhile, which
+keeps the objects from changing.  Finalization and everything after it stay
+serial.
+
+The objects of the list are first copied to an array, whose chunks the
+threads claim one at a time, so that each phase is balanced between them
+whatever the cost of each object.  A chunk refers to objects anywhere in the
+list, so visit_decref_atomic() decrements gc_refs atomically.
+
+Reachability is propagated by marking: the thread which atomically clears
+the PREV_MASK_COLLECTING flag of an object owns it and pushes it on its
+stack, to traverse it later.  The first round starts from the objects with
+gc_refs > 0.  A thread whose stack overflows moves half of it to the spill
+array.  Once all the chunks of a round are claimed, the threads stop after
+traversing PARALLEL_MARK_BUDGET objects and spill the rest of their stack:
+the objects spilled during a round make the chunks of the next one, and the
+marking is over after a round which spilled nothing.  Since an object is
+pushed only by the thread which marked it, the spill array never holds more
+objects than the list.  Finally, the collecting thread moves the objects
+which are still flagged to 'unreachable', leaving both lists as
+move_unreachable() does.
+*/
 
-IMPORTANT: This function leaves 'unreachable' with the NEXT_MASK_UNREACHABLE
-flag set but it does not clear it to skip unnecessary iteration. Before the
-flag is cleared (for example, by using 'clear_unreachable_mask' function or
-by a call to 'move_legacy_finalizers'), the 'unreachable' list is not a normal
-list and we can not use most gc_list_* functions for it. */
-static inline void
-deduce_unreachable(PyGC_Head *base, PyGC_Head *unreachable) {
-    validate_list(base, collecting_clear_unreachable_clear);
-    /* Using ob_refcnt and gc_refs, calculate which objects in the
-     * container set are reachable from outside the set (i.e., have a
-     * refcount greater than 0 when all the references within the
-     * set are taken into account).
-     */
-    update_refs(base);  // gc_prev is used for gc_refs
-    subtract_refs(base);
+/* Minimum number of objects examined by each thread */
+#define PARALLEL_MIN_OBJECTS        20000
+/* Number of objects in the chunks of the array of objects and of the spill
+   array */
+#define PARALLEL_CHUNK_SIZE         256
+#define PARALLEL_SPILL_CHUNK_SIZE   16
+#define PARALLEL_STACK_SIZE         1024
+#define PARALLEL_MARK_BUDGET        4096
+
+enum parallel_phase {
+    PARALLEL_UPDATE_REFS,
+    PARALLEL_SUBTRACT_REFS,
+    PARALLEL_MARK,
+    PARALLEL_EXIT,
+};
 
-    /* Leave everything reachable from outside base in base, and move
-     * everything else (in base) to unreachable.
-     *
-     * NOTE:  This used to move the reachable objects into a reachable
-     * set instead.  But most things usually turn out to be reachable,
-     * so it's more efficient to move the unreachable things.  It "sounds slick"
-     * to move the unreachable objects, until you think about it - the reason it
-     * pays isn't actually obvious.
-     *
-     * Suppose we create objects A, B, C in that order.  They appear in the young
-     * generation in the same order.  If B points to A, and C to B, and C is
-     * reachable from outside, then the adjusted refcounts will be 0, 0, and 1
-     * respectively.
-     *
-     * When move_unreachable finds A, A is moved to the unreachable list.  The
-     * same for B when it's first encountered.  Then C is traversed, B is moved
-     * _back_ to the reachable list.  B is eventually traversed, and then A is
-     * moved back to the reachable list.
-     *
-     * So instead of not moving at all, the reachable objects B and A are moved
-     * twice each.  Why is this a win?  A straightforward algorithm to move the
-     * reachable objects instead would move A, B, and C once each.
-     *
-     * The key is that this dance leaves the objects in order C, B, A - it's
-     * reversed from the original order.  On all _subsequent_ scans, none of
-     * them will move.  Since most objects aren't in cycles, this can save an
-     * unbounded number of moves across an unbounded number of later collections.
-     * It can cost more only the first time the chain is scanned.
-     *
-     * Drawback:  move_unreachable is also used to find out what's still trash
-     * after finalizers may resurrect objects.  In _that_ case most unreachable
-     * objects will remain unreachable, so it would be more efficient to move
-     * the reachable objects instead.  But this is a one-time cost, probably not
-     * worth complicating the code to speed just a little.
-     */
-    gc_list_init(unreachable);
-    move_unreachable(base, unreachable);  // gc_prev is pointer again
-    validate_list(base, collecting_clear_unreachable_clear);
-    validate_list(unreachable, collecting_set_unreachable_set);
-}
+struct gc_parallel;
 
-/* Handle objects that may have resurrected after a call to 'finalize_garbage', moving
-   them to 'old_generation' and placing the rest on 'still_unreachable'.
+struct gc_parallel_helper {
+    struct gc_parallel *parallel;
+    /* Released to start each phase */
+    PyThread_type_lock start;
+};
 
-   Contracts:
-       * After this function 'unreachable' must not be used anymore and 'still_unreachable'
-         will contain the objects that did not resurrect.
+struct gc_parallel {
+    GCState *gcstate;
+    enum parallel_phase phase;
+    /* The objects of the list */
+    PyGC_Head **objects;
+    Py_ssize_t nobjects;
+    /* Objects marked but not traversed by the previous rounds */
+    PyGC_Head **spill;
+    uintptr_t nspill;
+    /* Chunks of the current phase */
+    PyGC_Head **chunks;
+    Py_ssize_t chunks_size;
+    Py_ssize_t chunk_size;
+    /* Only the objects of the chunks with gc_refs > 0 are reachable */
+    int roots;
+    /* Index in chunks of the next chunk to claim */
+    uintptr_t next_chunk;
+    /* Number of threads which have not finished the current phase */
+    uintptr_t running;
+    /* Released by the last thread to finish a phase */
+    PyThread_type_lock done;
+    /* An object whose checks failed, with the failed check: it is reported
+       by the collecting thread, since dumping it needs the GIL. */
+    PyObject *broken;
+    const char *broken_msg;
+    /* Number of threads using this structure: the last one frees it */
+    uintptr_t users;
+    int nhelpers;
+    struct gc_parallel_helper *helpers;
+};
 
-       * The "still_unreachable" list must be uninitialized (this function calls
-         gc_list_init over 'still_unreachable').
+struct gc_mark_stack {
+    struct gc_parallel *parallel;
+    Py_ssize_t size;
+    PyGC_Head *items[PARALLEL_STACK_SIZE];
+};
 
-IMPORTANT: After a call to this function, the 'still_unreachable' set will have the
-PREV_MARK_COLLECTING set, but the objects in this set are going to be removed so
-we can skip the expense of clearing the flag to avoid extra iteration. */
+/* Record that the checks of op failed.  Only the debug build checks the
+   list, like update_refs() and visit_decref(); if several threads find
+   broken objects, any of them is reported. */
 static inline void
-handle_resurrected_objects(PyGC_Head *unreachable, PyGC_Head* still_unreachable,
-                           PyGC_Head *old_generation)
+parallel_set_broken(struct gc_parallel *parallel, PyObject *op,
+                    const char *msg)
 {
-    // Remove the PREV_MASK_COLLECTING from unreachable
-    // to prepare it for a new call to 'deduce_unreachable'
-    gc_list_clear_collecting(unreachable);
+#ifdef Py_DEBUG
+    parallel->broken_msg = msg;
+    parallel->broken = op;
+#else
+    (void)parallel;
+    (void)op;
+    (void)msg;
+#endif
+}
 
-    // After the call to deduce_unreachable, the 'still_unreachable' set will
-    // have the PREV_MARK_COLLECTING set, but the objects are going to be
-    // removed so we can skip the expense of clearing the flag.
-    PyGC_Head* resurrected = unreachable;
-    deduce_unreachable(resurrected, still_unreachable);
+/* Return the index of the first object of the next unclaimed chunk, or -1
+   if they are all claimed. */
+static inline Py_ssize_t
+parallel_claim_chunk(struct gc_parallel *parallel)
+{
+    Py_ssize_t i = (Py_ssize_t)_Py_atomic_fetch_add_uintptr(
+        &parallel->next_chunk, (uintptr_t)parallel->chunk_size);
+    return i < parallel->chunks_size ? i : -1;
+}
+
+static void
+parallel_update_refs(struct gc_parallel *parallel)
+{
+    Py_ssize_t i;
+    while ((i = parallel_claim_chunk(parallel)) >= 0) {
+        Py_ssize_t end = Py_MIN(i + parallel->chunk_size,
+                                parallel->chunks_size);
+        for (; i < end; i++) {
+            PyGC_Head *gc = parallel->chunks[i];
+            gc_reset_refs(gc, gc_refcnt(parallel->gcstate, FROM_GC(gc)));
+            /* See update_refs() */
+            if (gc_get_refs(gc) == 0) {
+                parallel_set_broken(parallel, FROM_GC(gc),
+                                    "refcount is zero");
+            }
+        }
+    }
+}
+
+struct visit_decref_atomic_arg {
+    struct gc_parallel *parallel;
+    PyObject *parent;
+};
+
+/* A traversal callback for parallel_subtract_refs. */
+static int
+visit_decref_atomic(PyObject *op, struct visit_decref_atomic_arg *arg)
+{
+#ifdef Py_DEBUG
+    if (_PyObject_IsFreed(op)) {
+        parallel_set_broken(arg->parallel, arg->parent,
+                            "refers to a freed object");
+        return 0;
+    }
+#endif
+
+    if (_PyObject_IS_GC(op)) {
+        PyGC_Head *gc = AS_GC(op);
+        if (gc_is_collecting(gc)) {
+            uintptr_t prev = _Py_atomic_fetch_sub_uintptr(
+                &gc->_gc_prev, (uintptr_t)1 << _PyGC_PREV_SHIFT);
+            if ((prev >> _PyGC_PREV_SHIFT) == 0) {
+                parallel_set_broken(arg->parallel, op,
+                                    "refcount is too small");
+            }
+        }
+    }
+    return 0;
+}
+
+static void
+parallel_subtract_refs(struct gc_parallel *parallel)
+{
+    Py_ssize_t i;
+    while ((i = parallel_claim_chunk(parallel)) >= 0) {
+        Py_ssize_t end = Py_MIN(i + parallel->chunk_size,
+                                parallel->chunks_size);
+        for (; i < end; i++) {
+            struct visit_decref_atomic_arg arg = {
+                parallel, FROM_GC(parallel->chunks[i])};
+            (void) Py_TYPE(arg.parent)->tp_traverse(
+                arg.parent, (visitproc)visit_decref_atomic, &arg);
+        }
+    }
+}
+
+/* Clear the PREV_MASK_COLLECTING flag of gc.  Return 1 if this thread
+   cleared it, 0 if another thread did. */
+static inline int
+gc_mark_atomic(PyGC_Head *gc)
+{
+    uintptr_t prev = _Py_atomic_fetch_and_uintptr(
+        &gc->_gc_prev, ~(uintptr_t)PREV_MASK_COLLECTING);
+    return (prev & PREV_MASK_COLLECTING) != 0;
+}
+
+/* Move the n oldest objects of the stack to the spill array. */
+static void
+parallel_spill(struct gc_mark_stack *stack, Py_ssize_t n)
+{
+    struct gc_parallel *parallel = stack->parallel;
+    Py_ssize_t start = (Py_ssize_t)_Py_atomic_fetch_add_uintptr(
+        &parallel->nspill, (uintptr_t)n);
+    assert(start + n <= parallel->nobjects);
+    memcpy(parallel->spill + start, stack->items, n * sizeof(PyGC_Head *));
+    stack->size -= n;
+    memmove(stack->items, stack->items + n,
+            stack->size * sizeof(PyGC_Head *));
+}
+
+/* A traversal callback for parallel_mark. */
+static int
+visit_mark(PyObject *op, struct gc_mark_stack *stack)
+{
+    if (!_PyObject_IS_GC(op)) {
+        return 0;
+    }
+    PyGC_Head *gc = AS_GC(op);
+    // Ignore objects in other generations and the marked ones.
+    if (!gc_is_collecting(gc) || !gc_mark_atomic(gc)) {
+        return 0;
+    }
+    if (stack->size == PARALLEL_STACK_SIZE) {
+        parallel_spill(stack, PARALLEL_STACK_SIZE / 2);
+    }
+    stack->items[stack->size++] = gc;
+    return 0;
+}
+
+static void
+parallel_mark(struct gc_parallel *parallel, struct gc_mark_stack *stack)
+{
+    Py_ssize_t traversed = 0;
+    Py_ssize_t i = 0, end = 0;
+    for (;;) {
+        PyGC_Head *gc;
+        if (stack->size > 0) {
+            /* A stale next_chunk only makes the thread stop later. */
+            if (traversed >= PARALLEL_MARK_BUDGET && i == end
+                && (Py_ssize_t)parallel->next_chunk >= parallel->chunks_size)
+            {
+                break;
+            }
+            gc = stack->items[--stack->size];
+        }
+        else {
+            if (i == end) {
+                i = parallel_claim_chunk(parallel);
+                if (i < 0) {
+                    break;
+                }
+                end = Py_MIN(i + parallel->chunk_size, parallel->chunks_size);
+            }
+            gc = parallel->chunks[i++];
+            if (parallel->roots
+                && (gc_get_refs(gc) == 0 || !gc_mark_atomic(gc)))
+            {
+                continue;
+            }
+        }
+        PyObject *op = FROM_GC(gc);
+        (void) Py_TYPE(op)->tp_traverse(op, (visitproc)visit_mark, stack);
+        traversed++;
+    }
+    if (stack->size > 0) {
+        parallel_spill(stack, stack->size);
+    }
+}
+
+static void
+parallel_work(struct gc_parallel *parallel, enum parallel_phase phase,
+              struct gc_mark_stack *stack)
+{
+    switch (phase) {
+    case PARALLEL_UPDATE_REFS:
+        parallel_update_refs(parallel);
+        break;
+    case PARALLEL_SUBTRACT_REFS:
+        parallel_subtract_refs(parallel);
+        break;
+    case PARALLEL_MARK:
+        parallel_mark(parallel, stack);
+        break;
+    default:
+        Py_UNREACHABLE();
+    }
+}
+
+static void
+parallel_free(struct gc_parallel *parallel)
+{
+    for (int i = 0; i < parallel->nhelpers; i++) {
+        PyThread_free_lock(parallel->helpers[i].start);
+    }
+    PyMem_RawFree(parallel->helpers);
+    if (parallel->done != NULL) {
+        PyThread_free_lock(parallel->done);
+    }
+    PyMem_RawFree(parallel->spill);
+    PyMem_RawFree(parallel->objects);
+    PyMem_RawFree(parallel);
+}
+
+/* Called by each thread when it is done with the structure. */
+static void
+parallel_release(struct gc_parallel *parallel)
+{
+    if (_Py_atomic_fetch_sub_uintptr(&parallel->users, 1) == 1) {
+        parallel_free(parallel);
+    }
+}
+
+static void
+parallel_helper(void *arg)
+{
+    struct gc_parallel_helper *helper = (struct gc_parallel_helper *)arg;
+    struct gc_parallel *parallel = helper->parallel;
+    struct gc_mark_stack stack;
+    stack.parallel = parallel;
+    stack.size = 0;
+
+    for (;;) {
+        PyThread_acquire_lock(helper->start, WAIT_LOCK);
+        enum parallel_phase phase = parallel->phase;
+        if (phase == PARALLEL_EXIT) {
+            break;
+        }
+        parallel_work(parallel, phase, &stack);
+        if (_Py_atomic_fetch_sub_uintptr(&parallel->running, 1) == 1) {
+            PyThread_release_lock(parallel->done);
+        }
+    }
+    parallel_release(parallel);
+}
+
+/* Start the helpers on a phase, take part in it, and wait until they are
+   all done. */
+static void
+parallel_run(struct gc_parallel *parallel, enum parallel_phase phase,
+             PyGC_Head **chunks, Py_ssize_t size, Py_ssize_t chunk_size,
+             struct gc_mark_stack *stack)
+{
+    parallel->phase = phase;
+    parallel->chunks = chunks;
+    parallel->chunks_size = size;
+    parallel->chunk_size = chunk_size;
+    parallel->next_chunk = 0;
+    parallel->running = (uintptr_t)parallel->nhelpers + 1;
+    for (int i = 0; i < parallel->nhelpers; i++) {
+        PyThread_release_lock(parallel->helpers[i].start);
+    }
+    parallel_work(parallel, phase, stack);
+    if (_Py_atomic_fetch_sub_uintptr(&parallel->running, 1) != 1) {
+        PyThread_acquire_lock(parallel->done, WAIT_LOCK);
+    }
+    if (parallel->broken != NULL) {
+        _PyObject_ASSERT_FAILED_MSG(parallel->broken, parallel->broken_msg);
+    }
+}
+
+/* Return 1 if list has more than n objects. */
+static int
+gc_list_size_exceeds(PyGC_Head *list, Py_ssize_t n)
+{
+    PyGC_Head *gc;
+    for (gc = GC_NEXT(list); gc != list; gc = GC_NEXT(gc)) {
+        if (n-- == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Copy the objects of list to a new array.  Return NULL on memory error. */
+static PyGC_Head **
+gc_list_to_array(PyGC_Head *list, Py_ssize_t *size)
+{
+    Py_ssize_t allocated = 4 * PARALLEL_MIN_OBJECTS, n = 0;
+    PyGC_Head **array = PyMem_RawMalloc(allocated * sizeof(PyGC_Head *));
+    if (array == NULL) {
+        return NULL;
+    }
+    for (PyGC_Head *gc = GC_NEXT(list); gc != list; gc = GC_NEXT(gc)) {
+        if (n == allocated) {
+            PyGC_Head **resized = NULL;
+            if (allocated <= PY_SSIZE_T_MAX / 2 / (Py_ssize_t)sizeof(PyGC_Head *)) {
+                allocated *= 2;
+                resized = PyMem_RawRealloc(array,
+                                           allocated * sizeof(PyGC_Head *));
+            }
+            if (resized == NULL) {
+                PyMem_RawFree(array);
+                return NULL;
+            }
+            array = resized;
+        }
+        array[n++] = gc;
+    }
+    *size = n;
+    return array;
+}
+
+/* Same as deduce_unreachable(), on gcstate->parallel_threads threads.
+   Return -1 without doing anything if there are too few objects for
+   several threads, or on memory error. */
+static int
+deduce_unreachable_parallel(PyGC_Head *base, PyGC_Head *unreachable,
+                            struct gc_generation_stats *stats)
+{
+    GCState *gcstate = get_gc_state();
+    int nthreads = gcstate->parallel_threads;
+    if (nthreads < 2
+        || !gc_list_size_exceeds(base, 2 * PARALLEL_MIN_OBJECTS)) {
+        return -1;
+    }
+
+    _PyTime_t t = 0;
+    if (stats != NULL) {
+        t = _PyTime_GetPerfCounter();
+    }
+    struct gc_parallel *parallel = PyMem_RawCalloc(1, sizeof(*parallel));
+    if (parallel == NULL) {
+        return -1;
+    }
+    Py_ssize_t n;
+    parallel->objects = gc_list_to_array(base, &n);
+    if (parallel->objects != NULL) {
+        parallel->nobjects = n;
+        nthreads = (int)Py_MIN(nthreads, n / PARALLEL_MIN_OBJECTS);
+        parallel->spill = PyMem_RawMalloc(n * sizeof(PyGC_Head *));
+        parallel->helpers = PyMem_RawCalloc(nthreads - 1,
+                                            sizeof(struct gc_parallel_helper));
+        parallel->done = PyThread_allocate_lock();
+    }
+    if (parallel->objects == NULL || parallel->spill == NULL
+        || parallel->helpers == NULL || parallel->done == NULL)
+    {
+        parallel_free(parallel);
+        return -1;
+    }
+    PyThread_acquire_lock(parallel->done, WAIT_LOCK);
+    parallel->gcstate = gcstate;
+    parallel->users = 1;
+
+    /* Start the helpers.  If a thread cannot be started, make do with
+       those already running. */
+    for (int i = 0; i < nthreads - 1; i++) {
+        struct gc_parallel_helper *helper = &parallel->helpers[i];
+        helper->parallel = parallel;
+        helper->start = PyThread_allocate_lock();
+        if (helper->start == NULL) {
+            break;
+        }
+        PyThread_acquire_lock(helper->start, WAIT_LOCK);
+        _Py_atomic_fetch_add_uintptr(&parallel->users, 1);
+        if (PyThread_start_new_thread(parallel_helper, helper)
+            == PYTHREAD_INVALID_THREAD_ID)
+        {
+            _Py_atomic_fetch_sub_uintptr(&parallel->users, 1);
+            PyThread_free_lock(helper->start);
+            break;
+        }
+        parallel->nhelpers++;
+    }
+
+    struct gc_mark_stack stack;
+    stack.parallel = parallel;
+    stack.size = 0;
+    PyGC_Head **objects = parallel->objects;
+
+    parallel_run(parallel, PARALLEL_UPDATE_REFS,
+                 objects, n, PARALLEL_CHUNK_SIZE, &stack);
+    if (stats != NULL) {
+        gc_time_phase(&t, &stats->update_refs_time);
+    }
+    parallel_run(parallel, PARALLEL_SUBTRACT_REFS,
+                 objects, n, PARALLEL_CHUNK_SIZE, &stack);
+    if (stats != NULL) {
+        gc_time_phase(&t, &stats->subtract_refs_time);
+    }
+
+    parallel->roots = 1;
+    parallel_run(parallel, PARALLEL_MARK,
+                 objects, n, PARALLEL_CHUNK_SIZE, &stack);
+    parallel->roots = 0;
+    Py_ssize_t start = 0, end;
+    while ((end = (Py_ssize_t)parallel->nspill) > start) {
+        parallel_run(parallel, PARALLEL_MARK,
+                     parallel->spill + start, end - start,
+                     PARALLEL_SPILL_CHUNK_SIZE, &stack);
+        start = end;
+    }
+
+    parallel->phase = PARALLEL_EXIT;
+    for (int i = 0; i < parallel->nhelpers; i++) {
+        PyThread_release_lock(parallel->helpers[i].start);
+    }
+
+    /* Split the objects between base and unreachable, restoring the
+       _gc_prev pointers, as move_unreachable() does. */
+    gc_list_init(unreachable);
+    PyGC_Head *prev = base;
+    for (Py_ssize_t i = 0; i < n; i++) {
+        PyGC_Head *gc = objects[i];
+        if (gc_is_collecting(gc)) {
+            PyGC_Head *last = GC_PREV(unreachable);
+            last->_gc_next = (NEXT_MASK_UNREACHABLE | (uintptr_t)gc);
+            _PyGCHead_SET_PREV(gc, last);
+            gc->_gc_next = (NEXT_MASK_UNREACHABLE | (uintptr_t)unreachable);
+            unreachable->_gc_prev = (uintptr_t)gc;
+        }
+        else {
+            _PyGCHead_SET_NEXT(prev, gc);
+            _PyGCHead_SET_PREV(gc, prev);
+            prev = gc;
+        }
+    }
+    _PyGCHead_SET_NEXT(prev, base);
+    base->_gc_prev = (uintptr_t)prev;
+    unreachable->_gc_next &= ~NEXT_MASK_UNREACHABLE;
+    parallel_release(parallel);
+
+    if (stats != NULL) {
+        gc_time_phase(&t, &stats->move_unreachable_time);
+    }
+    return 0;
+}
+#endif  /* _Py_ATOMIC_HAVE_RMW */
+
+/* Deduce which objects among "base" are unreachable from outside the list
+   and move them to 'unreachable'. The process consist in the following steps:
+
+1. Copy all reference counts to a different field (gc_prev is used to hold
+   this copy to save memory).
+2. Traverse all objects in "base" and visit all referred objects using
+   "tp_traverse" and for every visited object, subtract 1 to the reference
+   count (the one that we copied in the previous step). After this step, all
+   objects that can be reached directly from outside must have strictly positive
+   reference count, while all unreachable objects must have a count of exactly 0.
+3. Identify all unreachable objects (the ones with 0 reference count) and move
+   them to the "unreachable" list. This step also needs to move back to "base" all
+   objects that were initially marked as unreachable but are referred transitively
+   by the reachable objects (the ones with strictly positive reference count).
+
+If "stats" is not NULL, the duration of each step is added to it.
+
+Contracts:
+
+    * The "base" has to be a valid list with no mask set.
+
+    * The "unreachable" list must be uninitialized (this function calls
+      gc_list_init over 'unreachable').
+
+IMPORTANT: This function leaves 'unreachable' with the NEXT_MASK_UNREACHABLE
+flag set but it does not clear it to skip unnecessary iteration. Before the
+flag is cleared (for example, by using 'clear_unreachable_mask' function or
+by a call to 'move_legacy_finalizers'), the 'unreachable' list is not a normal
+list and we can not use most gc_list_* functions for it. */
+static inline void
+deduce_unreachable(PyGC_Head *base, PyGC_Head *unreachable,
+                   struct gc_generation_stats *stats) {
+    _PyTime_t t = 0;
+    validate_list(base, collecting_clear_unreachable_clear);
+#ifdef _Py_ATOMIC_HAVE_RMW
+    if (deduce_unreachable_parallel(base, unreachable, stats) == 0) {
+        validate_list(base, collecting_clear_unreachable_clear);
+        validate_list(unreachable, collecting_set_unreachable_set);
+        return;
+    }
+#endif
+    /* Using ob_refcnt and gc_refs, calculate which objects in the
+     * container set are reachable from outside the set (i.e., have a
+     * refcount greater than 0 when all the references within the
+     * set are taken into account).
+     */
+    if (stats != NULL) {
+        t = _PyTime_GetPerfCounter();
+    }
+    update_refs(base);  // gc_prev is used for gc_refs
+    if (stats != NULL) {
+        gc_time_phase(&t, &stats->update_refs_time);
+    }
+    subtract_refs(base);
+    if (stats != NULL) {
+        gc_time_phase(&t, &stats->subtract_refs_time);
+    }
+
+    /* Leave everything reachable from outside base in base, and move
+     * everything else (in base) to unreachable.
+     *
+     * NOTE:  This used to move the reachable objects into a reachable
+     * set instead.  But most things usually turn out to be reachable,
+     * so it's more efficient to move the unreachable things.  It "sounds slick"
+     * to move the unreachable objects, until you think about it - the reason it
+     * pays isn't actually obvious.
+     *
+     * Suppose we create objects A, B, C in that order.  They appear in the young
+     * generation in the same order.  If B points to A, and C to B, and C is
+     * reachable from outside, then the adjusted refcounts will be 0, 0, and 1
+     * respectively.
+     *
+     * When move_unreachable finds A, A is moved to the unreachable list.  The
+     * same for B when it's first encountered.  Then C is traversed, B is moved
+     * _back_ to the reachable list.  B is eventually traversed, and then A is
+     * moved back to the reachable list.
+     *
+     * So instead of not moving at all, the reachable objects B and A are moved
+     * twice each.  Why is this a win?  A straightforward algorithm to move the
+     * reachable objects instead would move A, B, and C once each.
+     *
+     * The key is that this dance leaves the objects in order C, B, A - it's
+     * reversed from the original order.  On all _subsequent_ scans, none of
+     * them will move.  Since most objects aren't in cycles, this can save an
+     * unbounded number of moves across an unbounded number of later collections.
+     * It can cost more only the first time the chain is scanned.
+     *
+     * Drawback:  move_unreachable is also used to find out what's still trash
+     * after finalizers may resurrect objects.  In _that_ case most unreachable
+     * objects will remain unreachable, so it would be more efficient to move
+     * the reachable objects instead.  But this is a one-time cost, probably not
+     * worth complicating the code to speed just a little.
+     */
+    gc_list_init(unreachable);
+    move_unreachable(base, unreachable);  // gc_prev is pointer again
+    if (stats != NULL) {
+        gc_time_phase(&t, &stats->move_unreachable_time);
+    }
+    validate_list(base, collecting_clear_unreachable_clear);
+    validate_list(unreachable, collecting_set_unreachable_set);
+}
+
+/* Handle objects that may have resurrected after a call to 'finalize_garbage', moving
+   them to 'old_generation' and placing the rest on 'still_unreachable'.
+
+   Contracts:
+       * After this function 'unreachable' must not be used anymore and 'still_unreachable'
+         will contain the objects that did not resurrect.
+
+       * The "still_unreachable" list must be uninitialized (this function calls
+         gc_list_init over 'still_unreachable').
+
+IMPORTANT: After a call to this function, the 'still_unreachable' set will have the
+PREV_MARK_COLLECTING set, but the objects in this set are going to be removed so
+we can skip the expense of clearing the flag to avoid extra iteration. */
+static inline void
+handle_resurrected_objects(PyGC_Head *unreachable, PyGC_Head* still_unreachable,
+                           PyGC_Head *old_generation)
+{
+    // Remove the PREV_MASK_COLLECTING from unreachable
+    // to prepare it for a new call to 'deduce_unreachable'
+    gc_list_clear_collecting(unreachable);
+
+    // After the call to deduce_unreachable, the 'still_unreachable' set will
+    // have the PREV_MARK_COLLECTING set, but the objects are going to be
+    // removed so we can skip the expense of clearing the flag.
+    PyGC_Head* resurrected = unreachable;
+    deduce_unreachable(resurrected, still_unreachable, NULL);
     clear_unreachable_mask(still_unreachable);
 
     // Move the resurrected objects to the old generation for future collection.
     gc_list_merge(resurrected, old_generation);
 }
 
+/* Incremental collection of the oldest generation
+   ------------------------------------------------
+
+When a pause is set with gc.set_incremental(), the oldest generation is not
+examined in one go, which takes time proportional to the number of
+long-lived objects, but over several steps of bounded duration.
+
+An incremental collection starts when the thresholds and the
+long_lived_pending heuristic of collect_generations() call for a full
+collection: the oldest generation is moved to old_unmarked.  Then each time
+generation 1 or 2 would be collected, a step runs instead:
+
+1. As long as old_unmarked is not empty, the step moves a chunk of it to
+   old_pending, clearing the NEXT_MASK_OLD_VISITED flag left by the previous
+   incremental collection, and collects generation 1 as usual.  This is
+   much cheaper than examining the objects.
+
+2. The objects reachable from the roots (sys.modules, the builtins and the
+   frames of all threads) are alive: there is no need to examine them.
+   Without this, the first increment that reaches a module dict or a large
+   container would pull in most of the heap.  The step which empties
+   old_unmarked puts the roots in old_marking (gc_mark_roots()), then the
+   following steps traverse chunks of old_marking, marking the unvisited
+   objects it reaches as visited and adding them to it, and collect
+   generation 1 as usual.  Traversed objects join the oldest generation.
+   An object which becomes garbage after it was marked is collected by the
+   next incremental collection.
+
+3. Then each step collects the young generations together with the first
+   increment_size objects of old_pending and all the unvisited objects
+   transitively reachable from them or from the young generations (see
+   gc_fill_increment()).  Since the increment is closed under references, a
+   reference cycle is never split between the increment and the rest of the
+   oldest generation, and finalizers, resurrection and weakref callbacks
+   behave as in a full collection.  Objects of the increment are marked
+   visited, so that later steps do not pull them in again, and survivors
+   join the oldest generation.
+
+The incremental collection is complete once old_pending is empty.  After
+each step, increment_size is scaled by the ratio of the pause to the
+duration of the step.  The pause is a target, not a bound: a step whose
+increment reaches many objects not reachable from the roots takes longer.
+
+Objects of the permanent generation are marked visited as well, which keeps
+the incremental collection from pulling them in.  Full collections first
+put the objects of old_unmarked, old_marking and old_pending back in the
+oldest generation.
+*/
+
+static inline int
+gc_incremental_in_progress(GCState *gcstate)
+{
+    return !(gc_list_is_empty(&gcstate->old_unmarked)
+             && gc_list_is_empty(&gcstate->old_marking)
+             && gc_list_is_empty(&gcstate->old_pending));
+}
+
+/* Abandon the incremental collection in progress, if any. */
+static void
+gc_incremental_abort(GCState *gcstate)
+{
+    PyGC_Head *old = GEN_HEAD(gcstate, NUM_GENERATIONS - 1);
+    gc_list_merge(&gcstate->old_unmarked, old);
+    gc_list_merge(&gcstate->old_marking, old);
+    gc_list_merge(&gcstate->old_pending, old);
+}
+
+/* A traversal callback for gc_mark_alive and gc_fill_increment: mark
+ * unvisited objects and move them to `list`. */
+static int
+visit_add_unvisited(PyObject *op, PyGC_Head *list)
+{
+    if (op != NULL && _PyObject_IS_GC(op) && _PyObject_GC_IS_TRACKED(op)) {
+        PyGC_Head *gc = AS_GC(op);
+        if (!gc_is_old_visited(gc)) {
+            gc_set_old_visited(gc);
+            gc_list_move(gc, list);
+        }
+    }
+    return 0;
+}
+
+/* Start marking the objects reachable from the roots. */
+static void
+gc_mark_roots(PyThreadState *tstate)
+{
+    PyInterpreterState *interp = tstate->interp;
+    PyGC_Head *marking = &interp->gc.old_marking;
+
+    visit_add_unvisited(interp->modules, marking);
+    visit_add_unvisited(interp->sysdict, marking);
+    visit_add_unvisited(interp->builtins, marking);
+    /* Running frames are not tracked, walk them explicitly. */
+    for (PyThreadState *p = interp->tstate_head; p != NULL; p = p->next) {
+        for (PyFrameObject *f = p->frame; f != NULL; f = f->f_back) {
+            visit_add_unvisited((PyObject *)f, marking);
+            (void) Py_TYPE(f)->tp_traverse((PyObject *)f,
+                                           (visitproc)visit_add_unvisited,
+                                           (void *)marking);
+        }
+    }
+}
+
+/* Traverse up to `n` objects of old_marking, marking what they reach, and
+ * move them to the oldest generation. */
+static void
+gc_mark_alive(GCState *gcstate, Py_ssize_t n)
+{
+    PyGC_Head *marking = &gcstate->old_marking;
+    PyGC_Head *old = GEN_HEAD(gcstate, NUM_GENERATIONS - 1);
+
+    while (n-- > 0 && !gc_list_is_empty(marking)) {
+        PyGC_Head *gc = GC_NEXT(marking);
+        PyObject *op = FROM_GC(gc);
+        gc_list_move(gc, old);
+        gcstate->incremental_survivors++;
+        (void) Py_TYPE(op)->tp_traverse(op,
+                                        (visitproc)visit_add_unvisited,
+                                        (void *)marking);
+    }
+}
+
+/* Add a slice of old_pending to the young generations in `increment`, and
+ * all the unvisited objects reachable from the increment.
+ */
+static void
+gc_fill_increment(GCState *gcstate, PyGC_Head *increment)
+{
+    PyGC_Head *pending = &gcstate->old_pending;
+    PyGC_Head *gc;
+
+    gc_list_set_old_visited(increment);
+    for (Py_ssize_t i = 0; i < gcstate->increment_size; i++) {
+        if (gc_list_is_empty(pending)) {
+            break;
+        }
+        gc = GC_NEXT(pending);
+        gc_set_old_visited(gc);
+        gc_list_move(gc, increment);
+    }
+    /* Note that the increment grows while we walk it. */
+    for (gc = GC_NEXT(increment); gc != increment; gc = GC_NEXT(gc)) {
+        PyObject *op = FROM_GC(gc);
+        traverseproc traverse = Py_TYPE(op)->tp_traverse;
+        (void) traverse(op,
+                        (visitproc)visit_add_unvisited,
+                        (void *)increment);
+    }
+}
+
 /* This is the main function.  Read this to understand how the
- * collection process works. */
+ * collection process works.  If `incremental` is true, `generation` must be
+ * the oldest one, and only a step of its incremental collection runs.
+ */
 static Py_ssize_t
 collect(PyThreadState *tstate, int generation,
-        Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable, int nofail)
+        Py_ssize_t *n_collected, Py_ssize_t *n_uncollectable, int nofail,
+        int incremental)
 {
     int i;
     Py_ssize_t m = 0; /* # objects collected */
@@ -1189,6 +2307,7 @@ collect(PyThreadState *tstate, int generation,
     PyGC_Head *gc;
     _PyTime_t t1 = 0;   /* initialize to prevent a compiler warning */
     GCState *gcstate = &tstate->interp->gc;
+    struct gc_generation_stats *stats = &gcstate->generation_stats[generation];
 
 #ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
     if (tstate->interp->config._isolated_interpreter) {
@@ -1199,7 +2318,8 @@ collect(PyThreadState *tstate, int generation,
 #endif
 
     if (gcstate->debug & DEBUG_STATS) {
-        PySys_WriteStderr("gc: collecting generation %d...\n", generation);
+        PySys_WriteStderr("gc: collecting %sgeneration %d...\n",
+                          incremental ? "an increment of " : "", generation);
         show_stats_each_generations(gcstate);
         t1 = _PyTime_GetMonotonicClock();
     }
@@ -1207,31 +2327,53 @@ collect(PyThreadState *tstate, int generation,
     if (PyDTrace_GC_START_ENABLED())
         PyDTrace_GC_START(generation);
 
+    /* A step of an incremental collection starts as a collection of the
+     * younger generations, then adds its increment to them. */
+    int last = incremental ? NUM_GENERATIONS - 2 : generation;
+    if (last == NUM_GENERATIONS - 1) {
+        gc_incremental_abort(gcstate);
+    }
+
     /* update collection and allocation counters */
-    if (generation+1 < NUM_GENERATIONS)
-        gcstate->generations[generation+1].count += 1;
-    for (i = 0; i <= generation; i++)
+    if (last+1 < NUM_GENERATIONS)
+        gcstate->generations[last+1].count += 1;
+    for (i = 0; i <= last; i++)
         gcstate->generations[i].count = 0;
 
+    /* Deallocate the deferred objects no longer referenced, leaving exact
+     * reference counts for the others. */
+    deferred_collect(tstate);
+
     /* merge younger generations with one we are currently collecting */
-    for (i = 0; i < generation; i++) {
-        gc_list_merge(GEN_HEAD(gcstate, i), GEN_HEAD(gcstate, generation));
+    for (i = 0; i < last; i++) {
+        gc_list_merge(GEN_HEAD(gcstate, i), GEN_HEAD(gcstate, last));
     }
 
     /* handy references */
-    young = GEN_HEAD(gcstate, generation);
-    if (generation < NUM_GENERATIONS-1)
-        old = GEN_HEAD(gcstate, generation+1);
+    young = GEN_HEAD(gcstate, last);
+    if (last < NUM_GENERATIONS-1)
+        old = GEN_HEAD(gcstate, last+1);
     else
         old = young;
     validate_list(old, collecting_clear_unreachable_clear);
 
-    deduce_unreachable(young, &unreachable);
+    if (incremental) {
+        gc_fill_increment(gcstate, young);
+    }
+
+    deduce_unreachable(young, &unreachable, stats);
 
     untrack_tuples(young);
     /* Move reachable objects to next generation. */
     if (young != old) {
-        if (generation == NUM_GENERATIONS - 2) {
+        if (incremental) {
+            /* Each object is in at most one increment per incremental
+               collection, so this is not quadratic either. */
+            untrack_dicts(young);
+            /* Some survivors lost their mark in move_unreachable(). */
+            gcstate->incremental_survivors += gc_list_set_old_visited(young);
+        }
+        else if (generation == NUM_GENERATIONS - 2) {
             gcstate->long_lived_pending += gc_list_size(young);
         }
         gc_list_merge(young, old);
@@ -1257,6 +2399,11 @@ collect(PyThreadState *tstate, int generation,
      */
     move_legacy_finalizer_reachable(&finalizers);
 
+    /* The deferred objects which are garbage are no longer deferred. */
+    if (gcstate->deferred_count > 0) {
+        deferred_restore_unreachable(gcstate, &unreachable);
+    }
+
     validate_list(&finalizers, collecting_clear_unreachable_clear);
     validate_list(&unreachable, collecting_set_unreachable_clear);
 
@@ -1268,6 +2415,7 @@ collect(PyThreadState *tstate, int generation,
     }
 
     /* Clear weakrefs and invoke callbacks as necessary. */
+    _PyTime_t t = _PyTime_GetPerfCounter();
     m += handle_weakrefs(&unreachable, old);
 
     validate_list(old, collecting_clear_unreachable_clear);
@@ -1280,7 +2428,12 @@ collect(PyThreadState *tstate, int generation,
      * to 'finalize_garbage' and continue the collection with the
      * objects that are still unreachable */
     PyGC_Head final_unreachable;
+    if (gcstate->deferred_count > 0) {
+        /* In case finalizers deferred objects of unreachable */
+        deferred_merge(tstate->interp);
+    }
     handle_resurrected_objects(&unreachable, &final_unreachable, old);
+    gc_time_phase(&t, &stats->finalize_time);
 
     /* Call tp_clear on objects in the final_unreachable set.  This will cause
     * the reference cycles to be broken.  It may also cause some objects
@@ -1288,6 +2441,7 @@ collect(PyThreadState *tstate, int generation,
     */
     m += gc_list_size(&final_unreachable);
     delete_garbage(tstate, gcstate, &final_unreachable, old);
+    gc_time_phase(&t, &stats->delete_time);
 
     /* Collect statistics on uncollectable objects found and print
      * debugging information. */
@@ -1312,7 +2466,7 @@ collect(PyThreadState *tstate, int generation,
 
     /* Clear free list only during the collection of the highest
      * generation */
-    if (generation == NUM_GENERATIONS-1) {
+    if (generation == NUM_GENERATIONS-1 && !incremental) {
         clear_freelists(tstate);
     }
 
@@ -1333,7 +2487,6 @@ collect(PyThreadState *tstate, int generation,
         *n_uncollectable = n;
     }
 
-    struct gc_generation_stats *stats = &gcstate->generation_stats[generation];
     stats->collections++;
     stats->collected += m;
     stats->uncollectable += n;
@@ -1398,9 +2551,83 @@ static Py_ssize_t
 collect_with_callback(PyThreadState *tstate, int generation)
 {
     assert(!_PyErr_Occurred(tstate));
+    GCState *gcstate = &tstate->interp->gc;
+    Py_ssize_t result, collected, uncollectable;
+    invoke_gc_callback(tstate, "start", generation, 0, 0);
+    _PyTime_t t0 = _PyTime_GetPerfCounter();
+    result = collect(tstate, generation, &collected, &uncollectable, 0, 0);
+    gc_record_pause(&gcstate->generation_stats[generation],
+                    _PyTime_GetPerfCounter() - t0);
+    invoke_gc_callback(tstate, "stop", generation, collected, uncollectable);
+    assert(!_PyErr_Occurred(tstate));
+    return result;
+}
+
+/* Run a step of the incremental collection of the oldest generation and
+ * invoke progress callbacks.  If none is in progress, start one if `start`
+ * is true, else collect the younger generations as usual.
+ */
+static Py_ssize_t
+collect_increment_with_callback(PyThreadState *tstate, int start)
+{
+    assert(!_PyErr_Occurred(tstate));
+    GCState *gcstate = &tstate->interp->gc;
+    PyGC_Head *unmarked = &gcstate->old_unmarked;
+    PyGC_Head *pending = &gcstate->old_pending;
+
+    if (!gc_incremental_in_progress(gcstate)) {
+        if (!start) {
+            return collect_with_callback(tstate, NUM_GENERATIONS - 2);
+        }
+        gc_list_merge(GEN_HEAD(gcstate, NUM_GENERATIONS - 1), unmarked);
+        gcstate->generations[NUM_GENERATIONS - 1].count = 0;
+        gcstate->long_lived_pending = 0;
+        gcstate->incremental_survivors = 0;
+    }
+
+    /* Steps which only unmark or mark objects of the oldest generation
+       collect generation 1 as usual */
+    PyGC_Head *marking = &gcstate->old_marking;
+    int incremental = gc_list_is_empty(unmarked) && gc_list_is_empty(marking);
+    int generation = incremental ? NUM_GENERATIONS - 1 : NUM_GENERATIONS - 2;
     Py_ssize_t result, collected, uncollectable;
     invoke_gc_callback(tstate, "start", generation, 0, 0);
-    result = collect(tstate, generation, &collected, &uncollectable, 0);
+    _PyTime_t t0 = _PyTime_GetPerfCounter();
+    if (!gc_list_is_empty(unmarked)) {
+        Py_ssize_t n = gcstate->increment_size * UNMARK_FACTOR;
+        while (n-- > 0 && !gc_list_is_empty(unmarked)) {
+            PyGC_Head *gc = GC_NEXT(unmarked);
+            gc->_gc_next &= ~NEXT_MASK_OLD_VISITED;
+            gc_list_move(gc, pending);
+        }
+        if (gc_list_is_empty(unmarked)) {
+            gc_mark_roots(tstate);
+        }
+    }
+    else if (!gc_list_is_empty(marking)) {
+        gc_mark_alive(gcstate, gcstate->increment_size * MARK_FACTOR);
+    }
+    result = collect(tstate, generation,
+                     &collected, &uncollectable, 0, incremental);
+    _PyTime_t pause = _PyTime_GetPerfCounter() - t0;
+    gc_record_pause(&gcstate->generation_stats[generation], pause);
+    double elapsed = _PyTime_AsSecondsDouble(pause);
+
+    /* Aim at the pause for the next step, without overreacting to a
+       single step which happened to be much shorter or longer. */
+    double ratio = 2.0;
+    if (elapsed * ratio > gcstate->incremental_pause) {
+        ratio = Py_MAX(gcstate->incremental_pause / elapsed, 0.5);
+    }
+    double size = gcstate->increment_size * ratio;
+    size = Py_MIN(Py_MAX(size, INCREMENT_SIZE_MIN), INCREMENT_SIZE_MAX);
+    gcstate->increment_size = (Py_ssize_t)size;
+
+    if (incremental && gc_list_is_empty(pending)) {
+        /* The incremental collection is complete */
+        gcstate->long_lived_total = gcstate->incremental_survivors;
+        clear_freelists(tstate);
+    }
     invoke_gc_callback(tstate, "stop", generation, collected, uncollectable);
     assert(!_PyErr_Occurred(tstate));
     return result;
@@ -1455,7 +2682,13 @@ collect_generations(PyThreadState *tstate)
             if (i == NUM_GENERATIONS - 1
                 && gcstate->long_lived_pending < gcstate->long_lived_total / 4)
                 continue;
-            n = collect_with_callback(tstate, i);
+            if (i > 0 && gcstate->incremental_pause > 0.0) {
+                n = collect_increment_with_callback(
+                    tstate, i == NUM_GENERATIONS - 1);
+            }
+            else {
+                n = collect_with_callback(tstate, i);
+            }
             break;
         }
     }
@@ -1692,6 +2925,12 @@ gc_get_referrers(PyObject *self, PyObject *args)
             return NULL;
         }
     }
+    if (!(gc_referrers_for(args, &gcstate->old_unmarked, result)) ||
+        !(gc_referrers_for(args, &gcstate->old_marking, result)) ||
+        !(gc_referrers_for(args, &gcstate->old_pending, result))) {
+        Py_DECREF(result);
+        return NULL;
+    }
     return result;
 }
 
@@ -1776,6 +3015,9 @@ gc_get_objects_impl(PyObject *module, Py_ssize_t generation)
         if (append_objects(result, GEN_HEAD(gcstate, generation))) {
             goto error;
         }
+        if (generation == NUM_GENERATIONS - 1) {
+            goto pending;
+        }
 
         return result;
     }
@@ -1786,6 +3028,15 @@ gc_get_objects_impl(PyObject *module, Py_ssize_t generation)
             goto error;
         }
     }
+
+pending:
+    /* Objects of the oldest generation not examined yet by the incremental
+       collection in progress */
+    if (append_objects(result, &gcstate->old_unmarked) ||
+        append_objects(result, &gcstate->old_marking) ||
+        append_objects(result, &gcstate->old_pending)) {
+        goto error;
+    }
     return result;
 
 error:
@@ -1818,12 +3069,35 @@ gc_get_stats_impl(PyObject *module)
         return NULL;
 
     for (i = 0; i < NUM_GENERATIONS; i++) {
-        PyObject *dict;
+        PyObject *dict, *pauses;
         st = &stats[i];
-        dict = Py_BuildValue("{snsnsn}",
+        pauses = PyTuple_New(NUM_PAUSE_BUCKETS);
+        if (pauses == NULL)
+            goto error;
+        for (int j = 0; j < NUM_PAUSE_BUCKETS; j++) {
+            PyObject *count = PyLong_FromSsize_t(st->pauses[j]);
+            if (count == NULL) {
+                Py_DECREF(pauses);
+                goto error;
+            }
+            PyTuple_SET_ITEM(pauses, j, count);
+        }
+        dict = Py_BuildValue("{snsnsnsdsdsdsdsdsdsN}",
                              "collections", st->collections,
                              "collected", st->collected,
-                             "uncollectable", st->uncollectable
+                             "uncollectable", st->uncollectable,
+                             "time", _PyTime_AsSecondsDouble(st->time),
+                             "update_refs_time",
+                             _PyTime_AsSecondsDouble(st->update_refs_time),
+                             "subtract_refs_time",
+                             _PyTime_AsSecondsDouble(st->subtract_refs_time),
+                             "move_unreachable_time",
+                             _PyTime_AsSecondsDouble(st->move_unreachable_time),
+                             "finalize_time",
+                             _PyTime_AsSecondsDouble(st->finalize_time),
+                             "delete_time",
+                             _PyTime_AsSecondsDouble(st->delete_time),
+                             "pauses", pauses
                             );
         if (dict == NULL)
             goto error;
@@ -1885,25 +3159,145 @@ gc_is_finalized(PyObject *module, PyObject *obj)
     Py_RETURN_FALSE;
 }
 
+/*[clinic input]
+gc.defer_refcount
+
+    obj: object
+    /
+
+Defer the reference counting of the object to the garbage collector.
+
+Its reference count is no longer stored in the object, which saves writes to
+its memory when long-lived objects like functions, classes and code objects
+are used by several threads or forked processes.  The object is deallocated
+by the next collection once it is no longer referenced.
+
+Only objects supported by the collector and code objects can be deferred.
+[clinic start generated code]*/
+
+static PyObject *
+gc_defer_refcount(PyObject *module, PyObject *obj)
+/*[clinic end generated code: output=31f5d143e6f79540 input=228b7c76a8da4687]*/
+{
+    if (_Py_IsImmortal(obj) || _Py_IsDeferred(obj)) {
+        Py_RETURN_NONE;
+    }
+    if (!_PyObject_IS_GC(obj) && !PyCode_Check(obj)) {
+        PyErr_Format(PyExc_TypeError,
+                     "cannot defer the reference count of '%.200s' objects",
+                     Py_TYPE(obj)->tp_name);
+        return NULL;
+    }
+    if (deferred_set(get_gc_state(), obj) < 0) {
+        return PyErr_NoMemory();
+    }
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+gc.is_deferred
+
+    obj: object
+    /
+
+Returns true if the reference counting of the object is deferred.
+[clinic start generated code]*/
+
+static PyObject *
+gc_is_deferred(PyObject *module, PyObject *obj)
+/*[clinic end generated code: output=c3becd087dba5ae6 input=5e19341022d9baf5]*/
+{
+    return PyBool_FromLong(_Py_IsDeferred(obj));
+}
+
+/* A traversal callback for gc_immortalize: make immortal the objects which
+ * the collector doesn't track, and push the containers among them on
+ * `stack` so that what they refer to is made immortal as well.
+ */
+static int
+visit_immortalize(PyObject *op, PyObject *stack)
+{
+    if (op == NULL || _Py_IsImmortal(op)) {
+        return 0;
+    }
+    if (!_PyObject_IS_GC(op)) {
+        _Py_SetImmortal(op);
+        return 0;
+    }
+    if (_PyObject_GC_IS_TRACKED(op)) {
+        /* Frozen on its own */
+        return 0;
+    }
+    _Py_SetImmortal(op);
+    /* Being immortal, op is not actually increfed */
+    return PyList_Append(stack, op);
+}
+
+/* Make the objects of the permanent generation immortal, and the objects
+ * reachable from them which the collector doesn't track.
+ */
+static int
+gc_immortalize(GCState *gcstate)
+{
+    PyGC_Head *permanent = &gcstate->permanent_generation.head;
+    PyObject *stack = PyList_New(0);
+    if (stack == NULL) {
+        return -1;
+    }
+    for (PyGC_Head *gc = GC_NEXT(permanent); gc != permanent; gc = GC_NEXT(gc)) {
+        PyObject *op = FROM_GC(gc);
+        _Py_SetImmortal(op);
+        do {
+            if (Py_TYPE(op)->tp_traverse(op, (visitproc)visit_immortalize,
+                                         stack) < 0) {
+                Py_DECREF(stack);
+                return -1;
+            }
+            Py_ssize_t n = PyList_GET_SIZE(stack);
+            if (n == 0) {
+                break;
+            }
+            op = PyList_GET_ITEM(stack, n - 1);
+            (void) PyList_SetSlice(stack, n - 1, n, NULL);
+        } while (1);
+    }
+    Py_DECREF(stack);
+    return 0;
+}
+
 /*[clinic input]
 gc.freeze
 
+    *
+    immortal: bool = False
+
 Freeze all current tracked objects and ignore them for future collections.
 
 This can be used before a POSIX fork() call to make the gc copy-on-write friendly.
 Note: collection before a POSIX fork() call may free pages for future allocation
 which can cause copy-on-write.
+
+If immortal is true, the frozen objects and the untracked objects they refer
+to also become immortal: they are never deallocated, and their reference
+counts are no longer updated.
 [clinic start generated code]*/
 
 static PyObject *
-gc_freeze_impl(PyObject *module)
-/*[clinic end generated code: output=502159d9cdc4c139 input=b602b16ac5febbe5]*/
+gc_freeze_impl(PyObject *module, int immortal)
+/*[clinic end generated code: output=42dc7e62f9e59ad3 input=8028808fb61eecdf]*/
 {
     GCState *gcstate = get_gc_state();
+    gc_incremental_abort(gcstate);
     for (int i = 0; i < NUM_GENERATIONS; ++i) {
+        if (gcstate->incremental_pause > 0.0) {
+            gc_list_set_old_visited(GEN_HEAD(gcstate, i));
+        }
         gc_list_merge(GEN_HEAD(gcstate, i), &gcstate->permanent_generation.head);
         gcstate->generations[i].count = 0;
     }
+    if (immortal && gc_immortalize(gcstate) < 0) {
+        return NULL;
+    }
     Py_RETURN_NONE;
 }
 
@@ -1940,6 +3334,105 @@ gc_get_freeze_count_impl(PyObject *module)
 }
 
 
+/*[clinic input]
+gc.set_incremental
+
+    pause: double
+    /
+
+Set the pause targeted by incremental collections of the oldest generation.
+
+The pause is in seconds.  When it is positive, the oldest generation is
+collected in steps that each take about that long, instead of all at once.
+A pause of 0 disables incremental collections.
+[clinic start generated code]*/
+
+static PyObject *
+gc_set_incremental_impl(PyObject *module, double pause)
+/*[clinic end generated code: output=dc8d6ce9108bddb5 input=772a7c638be0e683]*/
+{
+    if (!(pause >= 0.0) || Py_IS_INFINITY(pause)) {
+        PyErr_SetString(PyExc_ValueError,
+                        "pause must be a non-negative finite number");
+        return NULL;
+    }
+    GCState *gcstate = get_gc_state();
+    if (pause > 0.0 && gcstate->incremental_pause == 0.0) {
+        /* Objects frozen meanwhile are not marked yet */
+        gc_list_set_old_visited(&gcstate->permanent_generation.head);
+    }
+    else if (pause == 0.0 && !gcstate->collecting) {
+        gc_incremental_abort(gcstate);
+    }
+    gcstate->incremental_pause = pause;
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+gc.get_incremental -> double
+
+Return the pause targeted by incremental collections of the oldest generation.
+
+0.0 means that incremental collections are disabled.
+[clinic start generated code]*/
+
+static double
+gc_get_incremental_impl(PyObject *module)
+/*[clinic end generated code: output=a4ff9b83a08a764e input=9c32321128cb9313]*/
+{
+    GCState *gcstate = get_gc_state();
+    return gcstate->incremental_pause;
+}
+
+/*[clinic input]
+gc.set_parallel
+
+    threads: int
+    /
+
+Set the number of threads examining the objects of large collections.
+
+The threads propagate reachability between the objects, finalization and
+the destruction of garbage stay on the collecting thread.  1 makes
+collections serial.
+[clinic start generated code]*/
+
+static PyObject *
+gc_set_parallel_impl(PyObject *module, int threads)
+/*[clinic end generated code: output=eb1b216ff80032f6 input=97c264520ed56b3d]*/
+{
+    if (threads < 1) {
+        PyErr_SetString(PyExc_ValueError, "threads must be at least 1");
+        return NULL;
+    }
+#ifndef _Py_ATOMIC_HAVE_RMW
+    if (threads > 1) {
+        PyErr_SetString(PyExc_NotImplementedError,
+                        "parallel collections are not supported "
+                        "on this platform");
+        return NULL;
+    }
+#endif
+    GCState *gcstate = get_gc_state();
+    gcstate->parallel_threads = threads;
+    Py_RETURN_NONE;
+}
+
+/*[clinic input]
+gc.get_parallel -> int
+
+Return the number of threads examining the objects of large collections.
+[clinic start generated code]*/
+
+static int
+gc_get_parallel_impl(PyObject *module)
+/*[clinic end generated code: output=5b8b3265d5cdfb34 input=71772ac02fe8d6e8]*/
+{
+    GCState *gcstate = get_gc_state();
+    return gcstate->parallel_threads;
+}
+
+
 PyDoc_STRVAR(gc__doc__,
 "This module provides access to the garbage collector for reference cycles.\n"
 "\n"
@@ -1953,9 +3446,15 @@ PyDoc_STRVAR(gc__doc__,
 "get_debug() -- Get debugging flags.\n"
 "set_threshold() -- Set the collection thresholds.\n"
 "get_threshold() -- Return the current the collection thresholds.\n"
+"set_incremental() -- Set the pause of incremental collections.\n"
+"get_incremental() -- Return the pause of incremental collections.\n"
+"set_parallel() -- Set the number of threads of large collections.\n"
+"get_parallel() -- Return the number of threads of large collections.\n"
 "get_objects() -- Return a list of all objects tracked by the collector.\n"
 "is_tracked() -- Returns true if a given object is tracked.\n"
 "is_finalized() -- Returns true if a given object has been already finalized.\n"
+"defer_refcount() -- Defer the reference counting of an object to the collector.\n"
+"is_deferred() -- Returns true if the reference counting of an object is deferred.\n"
 "get_referrers() -- Return the list of objects that refer to an object.\n"
 "get_referents() -- Return the list of objects that an object refers to.\n"
 "freeze() -- Freeze all tracked objects and ignore them for future collections.\n"
@@ -1971,11 +3470,17 @@ static PyMethodDef GcMethods[] = {
     GC_GET_COUNT_METHODDEF
     {"set_threshold",  gc_set_threshold, METH_VARARGS, gc_set_thresh__doc__},
     GC_GET_THRESHOLD_METHODDEF
+    GC_SET_INCREMENTAL_METHODDEF
+    GC_GET_INCREMENTAL_METHODDEF
+    GC_SET_PARALLEL_METHODDEF
+    GC_GET_PARALLEL_METHODDEF
     GC_COLLECT_METHODDEF
     GC_GET_OBJECTS_METHODDEF
     GC_GET_STATS_METHODDEF
     GC_IS_TRACKED_METHODDEF
     GC_IS_FINALIZED_METHODDEF
+    GC_DEFER_REFCOUNT_METHODDEF
+    GC_IS_DEFERRED_METHODDEF
     {"get_referrers",  gc_get_referrers, METH_VARARGS,
         gc_get_referrers__doc__},
     {"get_referents",  gc_get_referents, METH_VARARGS,
@@ -2095,7 +3600,10 @@ _PyGC_CollectNoFail(void)
     }
     else {
         gcstate->collecting = 1;
-        n = collect(tstate, NUM_GENERATIONS - 1, NULL, NULL, 1);
+        _PyTime_t t0 = _PyTime_GetPerfCounter();
+        n = collect(tstate, NUM_GENERATIONS - 1, NULL, NULL, 1, 0);
+        gc_record_pause(&gcstate->generation_stats[NUM_GENERATIONS - 1],
+                        _PyTime_GetPerfCounter() - t0);
         gcstate->collecting = 0;
     }
     return n;
@@ -2144,6 +3652,13 @@ _PyGC_Fini(PyThreadState *tstate)
     GCState *gcstate = &tstate->interp->gc;
     Py_CLEAR(gcstate->garbage);
     Py_CLEAR(gcstate->callbacks);
+    _PyGC_UndeferAll(tstate);
+    PyMem_RawFree(gcstate->deferred);
+    PyMem_RawFree(gcstate->deferred_refcnt);
+    gcstate->deferred = NULL;
+    gcstate->deferred_refcnt = NULL;
+    gcstate->deferred_size = 0;
+    gcstate->deferred_free = -1;
 }
 
 /* for debugging */
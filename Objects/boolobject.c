@@ -175,11 +175,11 @@ PyTypeObject PyBool_Type = {
 /* The objects representing bool values False and True */
 
 struct _longobject _Py_FalseStruct = {
-    PyVarObject_HEAD_INIT(&PyBool_Type, 0)
+    { { _PyObject_EXTRA_INIT _Py_IMMORTAL_REFCNT, &PyBool_Type }, 0 },
     { 0 }
 };
 
 struct _longobject _Py_TrueStruct = {
-    PyVarObject_HEAD_INIT(&PyBool_Type, 1)
+    { { _PyObject_EXTRA_INIT _Py_IMMORTAL_REFCNT, &PyBool_Type }, 1 },
     { 1 }
 };
@@ -312,15 +312,15 @@ function_code_fastcall(PyThreadState *tstate, PyCodeObject *co,
     assert(globals != NULL);
 
     /* XXX Perhaps we should create a specialized
-       _PyFrame_New_NoTrack() that doesn't take locals, but does
+       _PyFrame_NewOnStack_NoTrack() that doesn't take locals, but does
        take builtins without sanity checking them.
        */
-    PyFrameObject *f = _PyFrame_New_NoTrack(tstate, co, globals, NULL);
+    PyFrameObject *f = _PyFrame_NewOnStack_NoTrack(tstate, co, globals, NULL);
     if (f == NULL) {
         return NULL;
     }
 
-    PyObject **fastlocals = f->f_localsplus;
+    PyObject **fastlocals = f->f_localsptr;
 
     for (Py_ssize_t i = 0; i < nargs; i++) {
         Py_INCREF(*args);
@@ -328,15 +328,7 @@ function_code_fastcall(PyThreadState *tstate, PyCodeObject *co,
     }
     PyObject *result = _PyEval_EvalFrame(tstate, f, 0);
 
-    if (Py_REFCNT(f) > 1) {
-        Py_DECREF(f);
-        _PyObject_GC_TRACK(f);
-    }
-    else {
-        ++tstate->recursion_depth;
-        Py_DECREF(f);
-        --tstate->recursion_depth;
-    }
+    _PyFrame_Release(tstate, f);
     return result;
 }
 
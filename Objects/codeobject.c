@@ -268,6 +268,10 @@ PyCode_NewWithPosOnlyArgs(int argcount, int posonlyargcount, int kwonlyargcount,
     co->co_opcache = NULL;
     co->co_opcache_flag = 0;
     co->co_opcache_size = 0;
+    co->co_quickened = NULL;
+#ifdef Py_OPCODE_STATS
+    co->co_stats = NULL;
+#endif
     return co;
 }
 
@@ -301,8 +305,10 @@ _PyCode_InitOpcache(PyCodeObject *co)
         unsigned char opcode = _Py_OPCODE(opcodes[i]);
         i++;  // 'i' is now aligned to (next_instr - first_instr)
 
-        // TODO: LOAD_METHOD, LOAD_ATTR
-        if (opcode == LOAD_GLOBAL) {
+        if (opcode == LOAD_GLOBAL || opcode == LOAD_ATTR ||
+            opcode == STORE_ATTR || opcode == LOAD_METHOD ||
+            opcode == BINARY_ADD || opcode == BINARY_SUBSCR)
+        {
             opts++;
             co->co_opcache_map[i] = (unsigned char)opts;
             if (opts > 254) {
@@ -328,6 +334,49 @@ _PyCode_InitOpcache(PyCodeObject *co)
     return 0;
 }
 
+int
+_PyCode_Quicken(PyCodeObject *co)
+{
+    Py_ssize_t co_size = PyBytes_Size(co->co_code) / sizeof(_Py_CODEUNIT);
+    _Py_CODEUNIT *opcodes = (_Py_CODEUNIT*)PyBytes_AS_STRING(co->co_code);
+    _Py_CODEUNIT *quickened = NULL;
+
+    for (Py_ssize_t i = 0; i + 1 < co_size; i++) {
+        int opcode = _Py_OPCODE(opcodes[i]);
+        int next = _Py_OPCODE(opcodes[i + 1]);
+        int super;
+
+        /* Pairs are matched on the original code, so that the second
+           instruction of a pair can itself start another pair: it keeps
+           being executed by the superinstruction of the first one. */
+#define SUPER(FIRST, SECOND, SUPERINSTRUCTION) \
+        if (opcode == FIRST && next == SECOND) { \
+            super = SUPERINSTRUCTION; \
+        } \
+        else
+        _Py_SUPERINSTRUCTIONS(SUPER)
+        {
+            continue;
+        }
+#undef SUPER
+
+        if (quickened == NULL) {
+            quickened = (_Py_CODEUNIT *)PyMem_Malloc(
+                co_size * sizeof(_Py_CODEUNIT));
+            if (quickened == NULL) {
+                PyErr_NoMemory();
+                return -1;
+            }
+            memcpy(quickened, opcodes, co_size * sizeof(_Py_CODEUNIT));
+        }
+        /* Only the opcode changes, the oparg byte is left in place */
+        ((unsigned char *)&quickened[i])[0] = (unsigned char)super;
+    }
+
+    co->co_quickened = quickened;
+    return 0;
+}
+
 PyCodeObject *
 PyCode_NewEmpty(const char *filename, const char *funcname, int firstlineno)
 {
@@ -559,6 +608,9 @@ code_dealloc(PyCodeObject *co)
     if (co->co_opcache_map != NULL) {
         PyMem_FREE(co->co_opcache_map);
     }
+    if (co->co_quickened != NULL) {
+        PyMem_FREE(co->co_quickened);
+    }
     co->co_opcache_flag = 0;
     co->co_opcache_size = 0;
 
@@ -615,6 +667,9 @@ code_sizeof(PyCodeObject *co, PyObject *Py_UNUSED(args))
         // co_opcache
         res += co->co_opcache_size * sizeof(_PyOpcache);
     }
+    if (co->co_quickened != NULL) {
+        res += PyBytes_GET_SIZE(co->co_code);
+    }
     return PyLong_FromSsize_t(res);
 }
 
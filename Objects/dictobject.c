@@ -26,6 +26,9 @@ layout:
 | dk_indices    |
 |               |
 +---------------+
+| dk_tags       |
+|               |
++---------------+
 | dk_entries    |
 |               |
 +---------------+
@@ -45,6 +48,13 @@ DK_ENTRIES(dk) can be used to get pointer to entries.
 NOTE: Since negative value is used for DKIX_EMPTY and DKIX_DUMMY, type of
 dk_indices entry is signed integer and int16 is used for table which
 dk_size == 256.
+
+dk_tags holds one byte per slot of dk_indices: DK_TAG_EMPTY, DK_TAG_DUMMY or
+a 7-bit tag computed from the hash of the key.  It is followed by copies of
+the first DK_GROUP_WIDTH-1 tags (at most dk_size of them), and padded with
+DK_TAG_EMPTY so that dk_entries is aligned.
+DK_TAGS(dk) can be used to get pointer to tags.  See the description of
+group probing below.
 */
 
 
@@ -111,6 +121,7 @@ converting the dict to the combined table.
 #define PyDict_MINSIZE 8
 
 #include "Python.h"
+#include "pycore_bitutils.h" // _Py_bit_ctz64()
 #include "pycore_gc.h"       // _PyObject_GC_IS_TRACKED()
 #include "pycore_object.h"   // _PyObject_GC_TRACK()
 #include "pycore_pyerrors.h" // _PyErr_Fetch()
@@ -118,6 +129,15 @@ converting the dict to the combined table.
 #include "dict-common.h"
 #include "stringlib/eq.h"    // unicode_eq()
 
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  include <emmintrin.h>     // _mm_cmpeq_epi8()
+#  define DK_GROUP_SSE2
+#elif (defined(__ARM_NEON) || defined(_M_ARM64)) && !defined(__ARM_BIG_ENDIAN)
+#  include <arm_neon.h>      // vceqq_u8()
+#  define DK_GROUP_NEON
+#endif
+
 /*[clinic input]
 class dict "PyDictObject *" "&PyDict_Type"
 [clinic start generated code]*/
@@ -131,8 +151,6 @@ To avoid slowing down lookups on a near-full table, we resize the table when
 it's USABLE_FRACTION (currently two-thirds) full.
 */
 
-#define PERTURB_SHIFT 5
-
 /*
 Major subtleties ahead:  Most hash schemes depend on having a "good" hash
 function, in the sense of simulating randomness.  Python doesn't:  its most
@@ -155,74 +173,38 @@ the list [i << 16 for i in range(20000)] as a set of keys.  Since ints are
 their own hash codes, and this fits in a dict of size 2**15, the last 15 bits
  of every hash code are all 0:  they *all* map to the same table index.
 
-But catering to unusual cases should not slow the usual ones, so we just take
-the last i bits anyway.  It's up to collision resolution to do the rest.  If
-we *usually* find the key we're looking for on the first try (and, it turns
-out, we usually do -- the table load factor is kept under 2/3, so the odds
-are solidly in our favor), then it makes best sense to keep the initial index
-computation dirt cheap.
-
-The first half of collision resolution is to visit table indices via this
-recurrence:
-
-    j = ((5*j) + 1) mod 2**i
-
-For any initial j in range(2**i), repeating that 2**i times generates each
-int in range(2**i) exactly once (see any text on random-number generation for
-proof).  By itself, this doesn't help much:  like linear probing (setting
-j += 1, or j -= 1, on each loop trip), it scans the table entries in a fixed
-order.  This would be bad, except that's not the only thing we do, and it's
-actually *good* in the common cases where hash keys are consecutive.  In an
-example that's really too small to make this entirely clear, for a table of
-size 2**3 the order of indices is:
-
-    0 -> 1 -> 6 -> 7 -> 4 -> 5 -> 2 -> 3 -> 0 [and here it's repeating]
-
-If two things come in at index 5, the first place we look after is index 2,
-not 6, so if another comes in at index 6 the collision at 5 didn't hurt it.
-Linear probing is deadly in this case because there the fixed probe order
-is the *same* as the order consecutive keys are likely to arrive.  But it's
-extremely unlikely hash codes will follow a 5*j+1 recurrence by accident,
-and certain that consecutive hash codes do not.
-
-The other half of the strategy is to get the other bits of the hash code
-into play.  This is done by initializing a (unsigned) vrbl "perturb" to the
-full hash code, and changing the recurrence to:
-
-    perturb >>= PERTURB_SHIFT;
-    j = (5*j) + 1 + perturb;
-    use j % 2**i as the next table index;
-
-Now the probe sequence depends (eventually) on every bit in the hash code,
-and the pseudo-scrambling property of recurring on 5*j+1 is more valuable,
-because it quickly magnifies small differences in the bits that didn't affect
-the initial index.  Note that because perturb is unsigned, if the recurrence
-is executed often enough perturb eventually becomes and remains 0.  At that
-point (very rarely reached) the recurrence is on (just) 5*j+1 again, and
-that's certain to find an empty slot eventually (since it generates every int
-in range(2**i), and we make sure there's always at least one empty slot).
-
-Selecting a good value for PERTURB_SHIFT is a balancing act.  You want it
-small so that the high bits of the hash code continue to affect the probe
-sequence across iterations; but you want it large so that in really bad cases
-the high-order hash bits have an effect on early iterations.  5 was "the
-best" in minimizing total collisions across experiments Tim Peters ran (on
-both normal and pathological cases), but 4 and 6 weren't significantly worse.
-
-Historical: Reimer Behrends contributed the idea of using a polynomial-based
-approach, using repeated multiplication by x in GF(2**n) where an irreducible
-polynomial for each table size was chosen such that x was a primitive root.
-Christian Tismer later extended that to use division by x instead, as an
-efficient way to get the high bits of the hash code into play.  This scheme
-also gave excellent collision statistics, but was more expensive:  two
-if-tests were required inside the loop; computing "the next" index took about
-the same number of operations but without as much potential parallelism
-(e.g., computing 5*j can go on at the same time as computing 1+perturb in the
-above, and then shifting perturb can be done while the table index is being
-masked); and the PyDictObject struct required a member to hold the table's
-polynomial.  In Tim's experiments the current scheme ran faster, produced
-equally good collision statistics, needed less code & used less memory.
-
+So the initial index is taken from the last i bits of the hash code after
+the higher 16-bit chunks have been xor'ed into it (dk_hash_start()).  That
+keeps contiguous ints contiguous and gets the high bits into play from the
+very first probe, at the cost of a couple of shifts.
+
+Collisions are resolved by group probing.  Each slot of dk_indices has a
+one byte tag in dk_tags:  DK_TAG_EMPTY or DK_TAG_DUMMY (both have the high
+bit set), or the top 7 bits of the hash code multiplied by a large odd
+constant (dk_hash_tag()).  A lookup loads the DK_GROUP_WIDTH tags starting at
+the initial index and compares all of them with the tag of the key at once
+(with SSE2 or NEON when available).  Only the slots whose tag matches are
+looked up in dk_entries, so a collision costs one key comparison in 128 on
+average.  If the group has no match and contains an empty slot, the key is
+not in the table; otherwise the next group is tried.  Insertion uses the
+first empty or dummy slot in the same order, so that lookups can stop at the
+first group holding an empty slot.
+
+Since the tags of a group must be contiguous in memory, the first
+DK_GROUP_WIDTH-1 tags are repeated after the last one, so a group can start
+at any slot.  A table smaller than a group is repeated only once and padded
+with DK_TAG_EMPTY, and lookups only consider the first dk_size tags of its
+group (dk_group_slots()), so that each slot is seen once.  Larger groups
+are visited with triangular steps:  i, i + W, i + 3*W, i + 6*W, ... where W
+is DK_GROUP_WIDTH.  For a table of size 2**k >= W, this visits every group
+of W aligned slots in 2**k / W steps, and a table never gets full, so the
+search terminates.
+
+Up to Python 3.9 the table was probed one slot at a time, using the
+recurrence j = (5*j) + 1 + perturb, where perturb starts as the hash code and
+is shifted right by 5 bits at each step.  That got every bit of the hash code
+into play as well, but each probe was a dependent load of dk_indices and
+often of dk_entries too.
 */
 
 /* forward declarations */
@@ -308,12 +290,177 @@ _PyDict_DebugMallocStats(FILE *out)
         1 : DK_SIZE(dk) <= 0xffff ?            \
             2 : sizeof(int32_t))
 #endif
+
+/* Number of tags compared at once by a lookup (see group probing above). */
+#define DK_GROUP_WIDTH 16
+
+#define DK_TAG_EMPTY ((uint8_t)0x80)
+#define DK_TAG_DUMMY ((uint8_t)0xfe)
+
+/* Size in bytes of dk_indices and dk_tags of a table of size slots using
+   indices of ixsize bytes.  dk_entries is pointer aligned. */
+#define DK_TABLE_SIZE(size, ixsize) \
+    _Py_SIZE_ROUND_UP((size) * ((ixsize) + 1) + DK_GROUP_WIDTH - 1, \
+                      SIZEOF_VOID_P)
+
+#define DK_TAGS(dk) \
+    ((uint8_t*)(&((int8_t*)((dk)->dk_indices))[DK_SIZE(dk) * DK_IXSIZE(dk)]))
 #define DK_ENTRIES(dk) \
-    ((PyDictKeyEntry*)(&((int8_t*)((dk)->dk_indices))[DK_SIZE(dk) * DK_IXSIZE(dk)]))
+    ((PyDictKeyEntry*)(&((int8_t*)((dk)->dk_indices))[ \
+        DK_TABLE_SIZE(DK_SIZE(dk), DK_IXSIZE(dk))]))
 
 #define DK_MASK(dk) (((dk)->dk_size)-1)
 #define IS_POWER_OF_2(x) (((x) & (x-1)) == 0)
 
+/* Initial slot of the probe sequence of hash, before masking. */
+static inline size_t
+dk_hash_start(Py_hash_t hash)
+{
+    size_t h = (size_t)hash;
+#if SIZEOF_SIZE_T > 4
+    h ^= h >> 32;
+#endif
+    return h ^ (h >> 16);
+}
+
+/* 7-bit tag of hash stored in dk_tags. */
+static inline uint8_t
+dk_hash_tag(Py_hash_t hash)
+{
+#if SIZEOF_SIZE_T > 4
+    const size_t multiplier = (size_t)0x9e3779b97f4a7c15ULL;
+#else
+    const size_t multiplier = (size_t)0x9e3779b9UL;
+#endif
+    return (uint8_t)(((size_t)hash * multiplier) >> (SIZEOF_SIZE_T * 8 - 7));
+}
+
+/* A group of DK_GROUP_WIDTH tags, and a bitmask of slots of a group.
+   Slot n of the group is bit n << DK_BITMASK_SHIFT of the bitmask, and no
+   other bit is set. */
+#if defined(DK_GROUP_SSE2)
+typedef __m128i dk_group_t;
+typedef uint32_t dk_bitmask_t;
+#define DK_BITMASK_SHIFT 0
+
+static inline dk_group_t
+dk_group_load(const uint8_t *tags)
+{
+    return _mm_loadu_si128((const __m128i *)tags);
+}
+
+/* Slots whose tag is tag. */
+static inline dk_bitmask_t
+dk_group_match(dk_group_t group, uint8_t tag)
+{
+    return (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8((char)tag)));
+}
+
+/* Slots which are empty or dummy. */
+static inline dk_bitmask_t
+dk_group_match_free(dk_group_t group)
+{
+    return (uint32_t)_mm_movemask_epi8(group);
+}
+
+#elif defined(DK_GROUP_NEON)
+typedef uint8x16_t dk_group_t;
+typedef uint64_t dk_bitmask_t;
+#define DK_BITMASK_SHIFT 2
+
+static inline dk_group_t
+dk_group_load(const uint8_t *tags)
+{
+    return vld1q_u8(tags);
+}
+
+/* NEON has no movemask: narrow each byte of cmp (0 or 0xff) to a nibble. */
+static inline dk_bitmask_t
+dk_group_bitmask(uint8x16_t cmp)
+{
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+    return (vget_lane_u64(vreinterpret_u64_u8(nibbles), 0)
+            & UINT64_C(0x8888888888888888));
+}
+
+/* Slots whose tag is tag. */
+static inline dk_bitmask_t
+dk_group_match(dk_group_t group, uint8_t tag)
+{
+    return dk_group_bitmask(vceqq_u8(group, vdupq_n_u8(tag)));
+}
+
+/* Slots which are empty or dummy. */
+static inline dk_bitmask_t
+dk_group_match_free(dk_group_t group)
+{
+    return dk_group_bitmask(vtstq_u8(group, vdupq_n_u8(0x80)));
+}
+
+#else
+typedef const uint8_t *dk_group_t;
+typedef uint32_t dk_bitmask_t;
+#define DK_BITMASK_SHIFT 0
+
+static inline dk_group_t
+dk_group_load(const uint8_t *tags)
+{
+    return tags;
+}
+
+/* Slots whose tag is tag. */
+static inline dk_bitmask_t
+dk_group_match(dk_group_t group, uint8_t tag)
+{
+    dk_bitmask_t mask = 0;
+    for (int n = 0; n < DK_GROUP_WIDTH; n++) {
+        mask |= (dk_bitmask_t)(group[n] == tag) << n;
+    }
+    return mask;
+}
+
+/* Slots which are empty or dummy. */
+static inline dk_bitmask_t
+dk_group_match_free(dk_group_t group)
+{
+    dk_bitmask_t mask = 0;
+    for (int n = 0; n < DK_GROUP_WIDTH; n++) {
+        mask |= (dk_bitmask_t)(group[n] >> 7) << n;
+    }
+    return mask;
+}
+#endif
+
+/* Slots which are empty. */
+static inline dk_bitmask_t
+dk_group_match_empty(dk_group_t group)
+{
+    return dk_group_match(group, DK_TAG_EMPTY);
+}
+
+/* Offset in the group of the first slot of a non-zero bitmask. */
+static inline size_t
+dk_bitmask_first(dk_bitmask_t mask)
+{
+    return (size_t)_Py_bit_ctz64(mask) >> DK_BITMASK_SHIFT;
+}
+
+/* Remove the first slot of a non-zero bitmask. */
+#define DK_BITMASK_NEXT(mask) ((mask) & ((mask) - 1))
+
+/* Slots of a group which are considered by lookups in a table of size
+   slots: all of them, or the first size ones when the table is smaller than
+   a group. */
+static inline dk_bitmask_t
+dk_group_slots(size_t size)
+{
+    if (size >= DK_GROUP_WIDTH) {
+        return (dk_bitmask_t)-1;
+    }
+    return ((dk_bitmask_t)1 << (size << DK_BITMASK_SHIFT)) - 1;
+}
+
 static void free_keys_object(PyDictKeysObject *keys);
 
 static inline void
@@ -366,13 +513,24 @@ dictkeys_get_index(const PyDictKeysObject *keys, Py_ssize_t i)
     return ix;
 }
 
-/* write to indices. */
+/* write to indices and tags.  tag must be DK_TAG_DUMMY if ix is
+   DKIX_DUMMY, or dk_hash_tag() of the hash of the entry otherwise. */
 static inline void
-dictkeys_set_index(PyDictKeysObject *keys, Py_ssize_t i, Py_ssize_t ix)
+dictkeys_set_index(PyDictKeysObject *keys, Py_ssize_t i, Py_ssize_t ix,
+                   uint8_t tag)
 {
     Py_ssize_t s = DK_SIZE(keys);
+    uint8_t *tags = DK_TAGS(keys);
 
     assert(ix >= DKIX_DUMMY);
+    assert(ix != DKIX_EMPTY);
+    assert((ix == DKIX_DUMMY) == (tag == DK_TAG_DUMMY));
+
+    tags[i] = tag;
+    /* Keep the copy which follows the last slot up to date. */
+    if (i < DK_GROUP_WIDTH - 1) {
+        tags[i + s] = tag;
+    }
 
     if (s <= 0xff) {
         int8_t *indices = (int8_t*)(keys->dk_indices);
@@ -450,8 +608,11 @@ static PyDictKeysObject empty_keys_struct = {
         lookdict_split, /* dk_lookup */
         0, /* dk_usable (immutable) */
         0, /* dk_nentries */
-        {DKIX_EMPTY, DKIX_EMPTY, DKIX_EMPTY, DKIX_EMPTY,
-         DKIX_EMPTY, DKIX_EMPTY, DKIX_EMPTY, DKIX_EMPTY}, /* dk_indices */
+        {DKIX_EMPTY, /* dk_indices */
+#define T ((char)DK_TAG_EMPTY)
+         T, T, T, T, T, T, T, T, T, T, T, T, T, T, T, T, /* dk_tags */
+         T, T, T, T, T, T, T}, /* padding */
+#undef T
 };
 
 static PyObject *empty_values[1] = { NULL };
@@ -497,9 +658,27 @@ _PyDict_CheckConsistency(PyObject *op, int check_content)
         PyDictKeyEntry *entries = DK_ENTRIES(keys);
         Py_ssize_t i;
 
+        const uint8_t *tags = DK_TAGS(keys);
         for (i=0; i < keys->dk_size; i++) {
             Py_ssize_t ix = dictkeys_get_index(keys, i);
             CHECK(DKIX_DUMMY <= ix && ix <= usable);
+            if (ix == DKIX_EMPTY) {
+                CHECK(tags[i] == DK_TAG_EMPTY);
+            }
+            else if (ix == DKIX_DUMMY) {
+                CHECK(tags[i] == DK_TAG_DUMMY);
+            }
+            else {
+                CHECK(tags[i] == dk_hash_tag(entries[ix].me_hash));
+            }
+        }
+        for (; i < keys->dk_size + DK_GROUP_WIDTH - 1; i++) {
+            if (i < 2 * keys->dk_size) {
+                CHECK(tags[i] == tags[i - keys->dk_size]);
+            }
+            else {
+                CHECK(tags[i] == DK_TAG_EMPTY);
+            }
         }
 
         for (i=0; i < usable; i++) {
@@ -575,7 +754,7 @@ new_keys_object(Py_ssize_t size)
     else
     {
         dk = PyObject_MALLOC(sizeof(PyDictKeysObject)
-                             + es * size
+                             + DK_TABLE_SIZE(size, es)
                              + sizeof(PyDictKeyEntry) * usable);
         if (dk == NULL) {
             PyErr_NoMemory();
@@ -591,6 +770,7 @@ new_keys_object(Py_ssize_t size)
     dk->dk_lookup = lookdict_unicode_nodummy;
     dk->dk_nentries = 0;
     memset(&dk->dk_indices[0], 0xff, es * size);
+    memset(DK_TAGS(dk), DK_TAG_EMPTY, DK_TABLE_SIZE(size, es) - es * size);
     memset(DK_ENTRIES(dk), 0, sizeof(PyDictKeyEntry) * usable);
     return dk;
 }
@@ -739,20 +919,25 @@ PyDict_New(void)
 static Py_ssize_t
 lookdict_index(PyDictKeysObject *k, Py_hash_t hash, Py_ssize_t index)
 {
+    const uint8_t *tags = DK_TAGS(k);
+    uint8_t tag = dk_hash_tag(hash);
     size_t mask = DK_MASK(k);
-    size_t perturb = (size_t)hash;
-    size_t i = (size_t)hash & mask;
-
-    for (;;) {
-        Py_ssize_t ix = dictkeys_get_index(k, i);
-        if (ix == index) {
-            return i;
+    dk_bitmask_t slots = dk_group_slots(DK_SIZE(k));
+    size_t i = dk_hash_start(hash) & mask;
+
+    for (size_t step = DK_GROUP_WIDTH;; step += DK_GROUP_WIDTH) {
+        dk_group_t group = dk_group_load(&tags[i]);
+        dk_bitmask_t match = dk_group_match(group, tag) & slots;
+        for (; match; match = DK_BITMASK_NEXT(match)) {
+            size_t j = (i + dk_bitmask_first(match)) & mask;
+            if (dictkeys_get_index(k, j) == index) {
+                return j;
+            }
         }
-        if (ix == DKIX_EMPTY) {
+        if (dk_group_match_empty(group)) {
             return DKIX_EMPTY;
         }
-        perturb >>= PERTURB_SHIFT;
-        i = mask & (i*5 + perturb + 1);
+        i = (i + step) & mask;
     }
     Py_UNREACHABLE();
 }
@@ -763,8 +948,9 @@ This is based on Algorithm D from Knuth Vol. 3, Sec. 6.4.
 Open addressing is preferred over chaining since the link overhead for
 chaining would be substantial (100% with typical malloc overhead).
 
-The initial probe index is computed as hash mod the table size. Subsequent
-probe indices are computed as explained earlier.
+The initial probe index and the groups of slots probed are computed as
+explained earlier.  Only the slots of a group whose tag matches the tag of
+the key are compared with the key.
 
 All arithmetic on hash should ignore overflow.
 
@@ -785,24 +971,28 @@ static Py_ssize_t _Py_HOT_FUNCTION
 lookdict(PyDictObject *mp, PyObject *key,
          Py_hash_t hash, PyObject **value_addr)
 {
-    size_t i, mask, perturb;
+    size_t i, mask;
     PyDictKeysObject *dk;
     PyDictKeyEntry *ep0;
+    const uint8_t *tags;
+    dk_bitmask_t slots;
+    uint8_t tag = dk_hash_tag(hash);
 
 top:
     dk = mp->ma_keys;
     ep0 = DK_ENTRIES(dk);
+    tags = DK_TAGS(dk);
     mask = DK_MASK(dk);
-    perturb = hash;
-    i = (size_t)hash & mask;
-
-    for (;;) {
-        Py_ssize_t ix = dictkeys_get_index(dk, i);
-        if (ix == DKIX_EMPTY) {
-            *value_addr = NULL;
-            return ix;
-        }
-        if (ix >= 0) {
+    slots = dk_group_slots(DK_SIZE(dk));
+    i = dk_hash_start(hash) & mask;
+
+    for (size_t step = DK_GROUP_WIDTH;; step += DK_GROUP_WIDTH) {
+        dk_group_t group = dk_group_load(&tags[i]);
+        dk_bitmask_t match = dk_group_match(group, tag) & slots;
+        for (; match; match = DK_BITMASK_NEXT(match)) {
+            Py_ssize_t ix = dictkeys_get_index(
+                dk, (i + dk_bitmask_first(match)) & mask);
+            assert(ix >= 0);
             PyDictKeyEntry *ep = &ep0[ix];
             assert(ep->me_key != NULL);
             if (ep->me_key == key) {
@@ -830,8 +1020,11 @@ top:
                 }
             }
         }
-        perturb >>= PERTURB_SHIFT;
-        i = (i*5 + perturb + 1) & mask;
+        if (dk_group_match_empty(group)) {
+            *value_addr = NULL;
+            return DKIX_EMPTY;
+        }
+        i = (i + step) & mask;
     }
     Py_UNREACHABLE();
 }
@@ -851,18 +1044,21 @@ lookdict_unicode(PyDictObject *mp, PyObject *key,
         return lookdict(mp, key, hash, value_addr);
     }
 
-    PyDictKeyEntry *ep0 = DK_ENTRIES(mp->ma_keys);
-    size_t mask = DK_MASK(mp->ma_keys);
-    size_t perturb = (size_t)hash;
-    size_t i = (size_t)hash & mask;
-
-    for (;;) {
-        Py_ssize_t ix = dictkeys_get_index(mp->ma_keys, i);
-        if (ix == DKIX_EMPTY) {
-            *value_addr = NULL;
-            return DKIX_EMPTY;
-        }
-        if (ix >= 0) {
+    PyDictKeysObject *dk = mp->ma_keys;
+    PyDictKeyEntry *ep0 = DK_ENTRIES(dk);
+    const uint8_t *tags = DK_TAGS(dk);
+    uint8_t tag = dk_hash_tag(hash);
+    size_t mask = DK_MASK(dk);
+    dk_bitmask_t slots = dk_group_slots(DK_SIZE(dk));
+    size_t i = dk_hash_start(hash) & mask;
+
+    for (size_t step = DK_GROUP_WIDTH;; step += DK_GROUP_WIDTH) {
+        dk_group_t group = dk_group_load(&tags[i]);
+        dk_bitmask_t match = dk_group_match(group, tag) & slots;
+        for (; match; match = DK_BITMASK_NEXT(match)) {
+            Py_ssize_t ix = dictkeys_get_index(
+                dk, (i + dk_bitmask_first(match)) & mask);
+            assert(ix >= 0);
             PyDictKeyEntry *ep = &ep0[ix];
             assert(ep->me_key != NULL);
             assert(PyUnicode_CheckExact(ep->me_key));
@@ -872,8 +1068,11 @@ lookdict_unicode(PyDictObject *mp, PyObject *key,
                 return ix;
             }
         }
-        perturb >>= PERTURB_SHIFT;
-        i = mask & (i*5 + perturb + 1);
+        if (dk_group_match_empty(group)) {
+            *value_addr = NULL;
+            return DKIX_EMPTY;
+        }
+        i = (i + step) & mask;
     }
     Py_UNREACHABLE();
 }
@@ -894,28 +1093,38 @@ lookdict_unicode_nodummy(PyDictObject *mp, PyObject *key,
         return lookdict(mp, key, hash, value_addr);
     }
 
-    PyDictKeyEntry *ep0 = DK_ENTRIES(mp->ma_keys);
-    size_t mask = DK_MASK(mp->ma_keys);
-    size_t perturb = (size_t)hash;
-    size_t i = (size_t)hash & mask;
-
-    for (;;) {
-        Py_ssize_t ix = dictkeys_get_index(mp->ma_keys, i);
-        assert (ix != DKIX_DUMMY);
-        if (ix == DKIX_EMPTY) {
+    PyDictKeysObject *dk = mp->ma_keys;
+    PyDictKeyEntry *ep0 = DK_ENTRIES(dk);
+    const uint8_t *tags = DK_TAGS(dk);
+    uint8_t tag = dk_hash_tag(hash);
+    size_t mask = DK_MASK(dk);
+    dk_bitmask_t slots = dk_group_slots(DK_SIZE(dk));
+    size_t i = dk_hash_start(hash) & mask;
+
+    for (size_t step = DK_GROUP_WIDTH;; step += DK_GROUP_WIDTH) {
+        dk_group_t group = dk_group_load(&tags[i]);
+        dk_bitmask_t match = dk_group_match(group, tag) & slots;
+        for (; match; match = DK_BITMASK_NEXT(match)) {
+            Py_ssize_t ix = dictkeys_get_index(
+                dk, (i + dk_bitmask_first(match)) & mask);
+            assert(ix >= 0);
+            PyDictKeyEntry *ep = &ep0[ix];
+            assert(ep->me_key != NULL);
+            assert(PyUnicode_CheckExact(ep->me_key));
+            if (ep->me_key == key ||
+                (ep->me_hash == hash && unicode_eq(ep->me_key, key))) {
+                *value_addr = ep->me_value;
+                return ix;
+            }
+        }
+        /* A table without dummies can only have free slots which are
+           empty. */
+        assert(dk_group_match_free(group) == dk_group_match_empty(group));
+        if (dk_group_match_empty(group)) {
             *value_addr = NULL;
             return DKIX_EMPTY;
         }
-        PyDictKeyEntry *ep = &ep0[ix];
-        assert(ep->me_key != NULL);
-        assert(PyUnicode_CheckExact(ep->me_key));
-        if (ep->me_key == key ||
-            (ep->me_hash == hash && unicode_eq(ep->me_key, key))) {
-            *value_addr = ep->me_value;
-            return ix;
-        }
-        perturb >>= PERTURB_SHIFT;
-        i = mask & (i*5 + perturb + 1);
+        i = (i + step) & mask;
     }
     Py_UNREACHABLE();
 }
@@ -939,28 +1148,38 @@ lookdict_split(PyDictObject *mp, PyObject *key,
         return ix;
     }
 
-    PyDictKeyEntry *ep0 = DK_ENTRIES(mp->ma_keys);
-    size_t mask = DK_MASK(mp->ma_keys);
-    size_t perturb = (size_t)hash;
-    size_t i = (size_t)hash & mask;
-
-    for (;;) {
-        Py_ssize_t ix = dictkeys_get_index(mp->ma_keys, i);
-        assert (ix != DKIX_DUMMY);
-        if (ix == DKIX_EMPTY) {
+    PyDictKeysObject *dk = mp->ma_keys;
+    PyDictKeyEntry *ep0 = DK_ENTRIES(dk);
+    const uint8_t *tags = DK_TAGS(dk);
+    uint8_t tag = dk_hash_tag(hash);
+    size_t mask = DK_MASK(dk);
+    dk_bitmask_t slots = dk_group_slots(DK_SIZE(dk));
+    size_t i = dk_hash_start(hash) & mask;
+
+    for (size_t step = DK_GROUP_WIDTH;; step += DK_GROUP_WIDTH) {
+        dk_group_t group = dk_group_load(&tags[i]);
+        dk_bitmask_t match = dk_group_match(group, tag) & slots;
+        for (; match; match = DK_BITMASK_NEXT(match)) {
+            Py_ssize_t ix = dictkeys_get_index(
+                dk, (i + dk_bitmask_first(match)) & mask);
+            assert(ix >= 0);
+            PyDictKeyEntry *ep = &ep0[ix];
+            assert(ep->me_key != NULL);
+            assert(PyUnicode_CheckExact(ep->me_key));
+            if (ep->me_key == key ||
+                (ep->me_hash == hash && unicode_eq(ep->me_key, key))) {
+                *value_addr = mp->ma_values[ix];
+                return ix;
+            }
+        }
+        /* A table without dummies can only have free slots which are
+           empty. */
+        assert(dk_group_match_free(group) == dk_group_match_empty(group));
+        if (dk_group_match_empty(group)) {
             *value_addr = NULL;
             return DKIX_EMPTY;
         }
-        PyDictKeyEntry *ep = &ep0[ix];
-        assert(ep->me_key != NULL);
-        assert(PyUnicode_CheckExact(ep->me_key));
-        if (ep->me_key == key ||
-            (ep->me_hash == hash && unicode_eq(ep->me_key, key))) {
-            *value_addr = mp->ma_values[ix];
-            return ix;
-        }
-        perturb >>= PERTURB_SHIFT;
-        i = mask & (i*5 + perturb + 1);
+        i = (i + step) & mask;
     }
     Py_UNREACHABLE();
 }
@@ -1035,15 +1254,19 @@ find_empty_slot(PyDictKeysObject *keys, Py_hash_t hash)
 {
     assert(keys != NULL);
 
+    const uint8_t *tags = DK_TAGS(keys);
     const size_t mask = DK_MASK(keys);
-    size_t i = hash & mask;
-    Py_ssize_t ix = dictkeys_get_index(keys, i);
-    for (size_t perturb = hash; ix >= 0;) {
-        perturb >>= PERTURB_SHIFT;
-        i = (i*5 + perturb + 1) & mask;
-        ix = dictkeys_get_index(keys, i);
+    size_t i = dk_hash_start(hash) & mask;
+    for (size_t step = DK_GROUP_WIDTH;; step += DK_GROUP_WIDTH) {
+        dk_bitmask_t avail = dk_group_match_free(dk_group_load(&tags[i]));
+        if (avail) {
+            i = (i + dk_bitmask_first(avail)) & mask;
+            assert(dictkeys_get_index(keys, i) < 0);
+            return i;
+        }
+        i = (i + step) & mask;
     }
-    return i;
+    Py_UNREACHABLE();
 }
 
 static int
@@ -1098,7 +1321,8 @@ insertdict(PyDictObject *mp, PyObject *key, Py_hash_t hash, PyObject *value)
         }
         Py_ssize_t hashpos = find_empty_slot(mp->ma_keys, hash);
         ep = &DK_ENTRIES(mp->ma_keys)[mp->ma_keys->dk_nentries];
-        dictkeys_set_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries);
+        dictkeys_set_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries,
+                           dk_hash_tag(hash));
         ep->me_key = key;
         ep->me_hash = hash;
         if (mp->ma_values) {
@@ -1165,9 +1389,9 @@ insert_to_emptydict(PyDictObject *mp, PyObject *key, Py_hash_t hash,
     Py_INCREF(value);
     MAINTAIN_TRACKING(mp, key, value);
 
-    size_t hashpos = (size_t)hash & (PyDict_MINSIZE-1);
+    size_t hashpos = dk_hash_start(hash) & (PyDict_MINSIZE-1);
     PyDictKeyEntry *ep = DK_ENTRIES(mp->ma_keys);
-    dictkeys_set_index(mp->ma_keys, hashpos, 0);
+    dictkeys_set_index(mp->ma_keys, hashpos, 0, dk_hash_tag(hash));
     ep->me_key = key;
     ep->me_hash = hash;
     ep->me_value = value;
@@ -1184,15 +1408,10 @@ Internal routine used by dictresize() to build a hashtable of entries.
 static void
 build_indices(PyDictKeysObject *keys, PyDictKeyEntry *ep, Py_ssize_t n)
 {
-    size_t mask = (size_t)DK_SIZE(keys) - 1;
     for (Py_ssize_t ix = 0; ix != n; ix++, ep++) {
         Py_hash_t hash = ep->me_hash;
-        size_t i = hash & mask;
-        for (size_t perturb = hash; dictkeys_get_index(keys, i) != DKIX_EMPTY;) {
-            perturb >>= PERTURB_SHIFT;
-            i = mask & (i*5 + perturb + 1);
-        }
-        dictkeys_set_index(keys, i, ix);
+        size_t i = find_empty_slot(keys, hash);
+        dictkeys_set_index(keys, i, ix, dk_hash_tag(hash));
     }
 }
 
@@ -1550,6 +1769,100 @@ _PyDict_LoadGlobal(PyDictObject *globals, PyDictObject *builtins, PyObject *key)
     return value;
 }
 
+/* Fast lookup for the opcode cache of LOAD_ATTR.
+
+   key must be an exact str.  The entry at index hint is tried first, using
+   an identity comparison of the key; on a mismatch a regular lookup is done.
+   Return the index of the entry and set *value to a borrowed reference if the
+   key exists.  Otherwise set *value to NULL and return DKIX_EMPTY, or
+   DKIX_ERROR with an exception set.
+ */
+Py_ssize_t
+_PyDict_GetItemHint(PyDictObject *mp, PyObject *key,
+                    Py_ssize_t hint, PyObject **value)
+{
+    assert(PyDict_CheckExact((PyObject*)mp));
+    assert(PyUnicode_CheckExact(key));
+
+    if (hint >= 0 && hint < mp->ma_keys->dk_nentries) {
+        PyDictKeyEntry *ep = &DK_ENTRIES(mp->ma_keys)[hint];
+        if (ep->me_key == key) {
+            PyObject *res;
+            if (mp->ma_values != NULL) {
+                res = mp->ma_values[hint];
+            }
+            else {
+                res = ep->me_value;
+            }
+            if (res != NULL) {
+                *value = res;
+                return hint;
+            }
+        }
+    }
+
+    Py_hash_t hash = ((PyASCIIObject *) key)->hash;
+    if (hash == -1) {
+        hash = PyObject_Hash(key);
+        if (hash == -1) {
+            *value = NULL;
+            return DKIX_ERROR;
+        }
+    }
+    Py_ssize_t ix = (mp->ma_keys->dk_lookup)(mp, key, hash, value);
+    if (ix >= 0 && *value == NULL) {
+        /* pending slot of a split table */
+        return DKIX_EMPTY;
+    }
+    return ix;
+}
+
+/* Fast update for the opcode cache of STORE_ATTR.
+
+   If the entry at index hint holds key (compared by identity) and has a
+   value, replace that value by value and return 1.  Otherwise, return 0
+   without modifying the dict; the caller must fall back to a regular
+   insertion.  This never resizes the dict and never fails.
+ */
+int
+_PyDict_SetItemHint(PyDictObject *mp, PyObject *key,
+                    Py_ssize_t hint, PyObject *value)
+{
+    PyObject *old_value;
+
+    assert(PyDict_CheckExact((PyObject*)mp));
+    assert(value != NULL);
+
+    if (hint < 0 || hint >= mp->ma_keys->dk_nentries) {
+        return 0;
+    }
+    PyDictKeyEntry *ep = &DK_ENTRIES(mp->ma_keys)[hint];
+    if (ep->me_key != key) {
+        return 0;
+    }
+    if (mp->ma_values != NULL) {
+        old_value = mp->ma_values[hint];
+        if (old_value == NULL) {
+            return 0;
+        }
+        Py_INCREF(value);
+        mp->ma_values[hint] = value;
+    }
+    else {
+        old_value = ep->me_value;
+        if (old_value == NULL) {
+            return 0;
+        }
+        Py_INCREF(value);
+        ep->me_value = value;
+    }
+    MAINTAIN_TRACKING(mp, key, value);
+    mp->ma_version_tag = DICT_NEXT_VERSION();
+    ASSERT_CONSISTENT(mp);
+    Py_DECREF(old_value); /* which **CAN** re-enter (see issue #22653) */
+    return 1;
+}
+
 /* CAUTION: PyDict_SetItem() must guarantee that it won't resize the
  * dictionary if it's merely replacing the value for an existing key.
  * This means that it's safe to loop over a dictionary with PyDict_Next()
@@ -1618,7 +1931,7 @@ delitem_common(PyDictObject *mp, Py_hash_t hash, Py_ssize_t ix,
     mp->ma_used--;
     mp->ma_version_tag = DICT_NEXT_VERSION();
     ep = &DK_ENTRIES(mp->ma_keys)[ix];
-    dictkeys_set_index(mp->ma_keys, hashpos, DKIX_DUMMY);
+    dictkeys_set_index(mp->ma_keys, hashpos, DKIX_DUMMY, DK_TAG_DUMMY);
     ENSURE_ALLOWS_DELETIONS(mp);
     old_key = ep->me_key;
     ep->me_key = NULL;
@@ -1687,7 +2000,7 @@ int
 _PyDict_DelItemIf(PyObject *op, PyObject *key,
                   int (*predicate)(PyObject *value))
 {
-    Py_ssize_t hashpos, ix;
+    Py_ssize_t ix;
     PyDictObject *mp;
     Py_hash_t hash;
     PyObject *old_value;
@@ -1723,11 +2036,8 @@ _PyDict_DelItemIf(PyObject *op, PyObject *key,
     if (res == -1)
         return -1;
 
-    hashpos = lookdict_index(mp->ma_keys, hash, ix);
-    assert(hashpos >= 0);
-
     if (res > 0)
-        return delitem_common(mp, hashpos, ix, old_value);
+        return delitem_common(mp, hash, ix, old_value);
     else
         return 0;
 }
@@ -1888,7 +2198,7 @@ _PyDict_Pop_KnownHash(PyObject *dict, PyObject *key, Py_hash_t hash, PyObject *d
     assert(old_value != NULL);
     mp->ma_used--;
     mp->ma_version_tag = DICT_NEXT_VERSION();
-    dictkeys_set_index(mp->ma_keys, hashpos, DKIX_DUMMY);
+    dictkeys_set_index(mp->ma_keys, hashpos, DKIX_DUMMY, DK_TAG_DUMMY);
     ep = &DK_ENTRIES(mp->ma_keys)[ix];
     ENSURE_ALLOWS_DELETIONS(mp);
     old_key = ep->me_key;
@@ -2980,7 +3290,8 @@ PyDict_SetDefault(PyObject *d, PyObject *key, PyObject *defaultobj)
         Py_ssize_t hashpos = find_empty_slot(mp->ma_keys, hash);
         ep0 = DK_ENTRIES(mp->ma_keys);
         ep = &ep0[mp->ma_keys->dk_nentries];
-        dictkeys_set_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries);
+        dictkeys_set_index(mp->ma_keys, hashpos, mp->ma_keys->dk_nentries,
+                           dk_hash_tag(hash));
         Py_INCREF(key);
         Py_INCREF(value);
         MAINTAIN_TRACKING(mp, key, value);
@@ -3119,7 +3430,7 @@ dict_popitem_impl(PyDictObject *self)
     j = lookdict_index(self->ma_keys, ep->me_hash, i);
     assert(j >= 0);
     assert(dictkeys_get_index(self->ma_keys, j) == i);
-    dictkeys_set_index(self->ma_keys, j, DKIX_DUMMY);
+    dictkeys_set_index(self->ma_keys, j, DKIX_DUMMY, DK_TAG_DUMMY);
 
     PyTuple_SET_ITEM(res, 0, ep->me_key);
     PyTuple_SET_ITEM(res, 1, ep->me_value);
@@ -3188,7 +3499,7 @@ _PyDict_SizeOf(PyDictObject *mp)
        in the type object. */
     if (mp->ma_keys->dk_refcnt == 1)
         res += (sizeof(PyDictKeysObject)
-                + DK_IXSIZE(mp->ma_keys) * size
+                + DK_TABLE_SIZE(size, DK_IXSIZE(mp->ma_keys))
                 + sizeof(PyDictKeyEntry) * usable);
     return res;
 }
@@ -3197,7 +3508,7 @@ Py_ssize_t
 _PyDict_KeysSize(PyDictKeysObject *keys)
 {
     return (sizeof(PyDictKeysObject)
-            + DK_IXSIZE(keys) * DK_SIZE(keys)
+            + DK_TABLE_SIZE(DK_SIZE(keys), DK_IXSIZE(keys))
             + USABLE_FRACTION(DK_SIZE(keys)) * sizeof(PyDictKeyEntry));
 }
 
@@ -3,6 +3,7 @@
 #include "Python.h"
 #include "pycore_object.h"
 #include "pycore_gc.h"       // _PyObject_GC_IS_TRACKED()
+#include "pycore_pystate.h"       // _PyThreadState_PushLocals()
 
 #include "code.h"
 #include "frameobject.h"
@@ -539,12 +540,12 @@ static PyGetSetDef frame_getsetlist[] = {
    In zombie mode, no field of PyFrameObject holds a reference, but
    the following fields are still valid:
 
-     * ob_type, ob_size, f_code, f_valuestack;
+     * ob_type, ob_size, f_code;
 
      * f_locals, f_trace are NULL;
 
-     * f_localsplus does not require re-allocation and
-       the local variables in f_localsplus are NULL.
+     * f_localsplus does not require re-allocation if ob_size is large
+       enough for the new frame.
 
    2. We also maintain a separate free list of stack frames (just like
    floats are allocated in a special way -- see floatobject.c).  When
@@ -554,6 +555,9 @@ static PyGetSetDef frame_getsetlist[] = {
     f_back              next item on free list, or NULL
     f_stacksize         size of value stack
     ob_size             size of localsplus
+   Frames whose locals live on the thread's data stack only need room
+   for the locals in f_localsplus (see _PyFrame_Release()), so they are
+   smaller than frames owning their value stack.
    Note that the value and block stacks are preserved -- this can save
    another malloc() call or two (and two free() calls as well!).
    Also note that, unlike for integers, each frame object is a
@@ -580,7 +584,7 @@ frame_dealloc(PyFrameObject *f)
     Py_TRASHCAN_SAFE_BEGIN(f)
     /* Kill all local variables */
     PyObject **valuestack = f->f_valuestack;
-    for (PyObject **p = f->f_localsplus; p < valuestack; p++) {
+    for (PyObject **p = f->f_localsptr; p < valuestack; p++) {
         Py_CLEAR(*p);
     }
 
@@ -596,6 +600,8 @@ frame_dealloc(PyFrameObject *f)
     Py_DECREF(f->f_globals);
     Py_CLEAR(f->f_locals);
     Py_CLEAR(f->f_trace);
+    f->f_localsptr = f->f_localsplus;
+    f->f_datastack = 0;
 
     PyCodeObject *co = f->f_code;
     if (co->co_zombieframe == NULL) {
@@ -641,7 +647,7 @@ frame_traverse(PyFrameObject *f, visitproc visit, void *arg)
     Py_VISIT(f->f_trace);
 
     /* locals */
-    PyObject **fastlocals = f->f_localsplus;
+    PyObject **fastlocals = f->f_localsptr;
     for (Py_ssize_t i = frame_nslots(f); --i >= 0; ++fastlocals) {
         Py_VISIT(*fastlocals);
     }
@@ -670,7 +676,7 @@ frame_tp_clear(PyFrameObject *f)
     Py_CLEAR(f->f_trace);
 
     /* locals */
-    PyObject **fastlocals = f->f_localsplus;
+    PyObject **fastlocals = f->f_localsptr;
     for (Py_ssize_t i = frame_nslots(f); --i >= 0; ++fastlocals) {
         Py_CLEAR(*fastlocals);
     }
@@ -777,55 +783,69 @@ PyTypeObject PyFrame_Type = {
 _Py_IDENTIFIER(__builtins__);
 
 static inline PyFrameObject*
-frame_alloc(PyCodeObject *code)
+frame_alloc(PyCodeObject *code, PyObject **localsptr)
 {
     PyFrameObject *f;
 
+    Py_ssize_t ncells = PyTuple_GET_SIZE(code->co_cellvars);
+    Py_ssize_t nfrees = PyTuple_GET_SIZE(code->co_freevars);
+    Py_ssize_t nslots = code->co_nlocals + ncells + nfrees;
+    /* A frame on the data stack keeps room for its locals only */
+    Py_ssize_t extras = nslots;
+    if (localsptr == NULL) {
+        extras += code->co_stacksize;
+    }
+
     f = code->co_zombieframe;
-    if (f != NULL) {
+    if (f != NULL && Py_SIZE(f) >= extras) {
         code->co_zombieframe = NULL;
         _Py_NewReference((PyObject *)f);
         assert(f->f_code == code);
-        return f;
-    }
-
-    Py_ssize_t ncells = PyTuple_GET_SIZE(code->co_cellvars);
-    Py_ssize_t nfrees = PyTuple_GET_SIZE(code->co_freevars);
-    Py_ssize_t extras = code->co_stacksize + code->co_nlocals + ncells + nfrees;
-    struct _Py_frame_state *state = get_frame_state();
-    if (state->free_list == NULL)
-    {
-        f = PyObject_GC_NewVar(PyFrameObject, &PyFrame_Type, extras);
-        if (f == NULL) {
-            return NULL;
-        }
     }
     else {
+        struct _Py_frame_state *state = get_frame_state();
+        if (state->free_list == NULL)
+        {
+            f = PyObject_GC_NewVar(PyFrameObject, &PyFrame_Type, extras);
+            if (f == NULL) {
+                return NULL;
+            }
+        }
+        else {
 #ifdef Py_DEBUG
-        // frame_alloc() must not be called after _PyFrame_Fini()
-        assert(state->numfree != -1);
+            // frame_alloc() must not be called after _PyFrame_Fini()
+            assert(state->numfree != -1);
 #endif
-        assert(state->numfree > 0);
-        --state->numfree;
-        f = state->free_list;
-        state->free_list = state->free_list->f_back;
-        if (Py_SIZE(f) < extras) {
-            PyFrameObject *new_f = PyObject_GC_Resize(PyFrameObject, f, extras);
-            if (new_f == NULL) {
-                PyObject_GC_Del(f);
-                return NULL;
+            assert(state->numfree > 0);
+            --state->numfree;
+            f = state->free_list;
+            state->free_list = state->free_list->f_back;
+            if (Py_SIZE(f) < extras) {
+                PyFrameObject *new_f = PyObject_GC_Resize(PyFrameObject, f, extras);
+                if (new_f == NULL) {
+                    PyObject_GC_Del(f);
+                    return NULL;
+                }
+                f = new_f;
             }
-            f = new_f;
+            _Py_NewReference((PyObject *)f);
         }
-        _Py_NewReference((PyObject *)f);
+        f->f_code = code;
     }
 
-    f->f_code = code;
-    extras = code->co_nlocals + ncells + nfrees;
-    f->f_valuestack = f->f_localsplus + extras;
-    for (Py_ssize_t i=0; i<extras; i++) {
-        f->f_localsplus[i] = NULL;
+    if (localsptr == NULL) {
+        /* The data stack slots are already NULL */
+        localsptr = f->f_localsplus;
+        for (Py_ssize_t i=0; i<nslots; i++) {
+            localsptr[i] = NULL;
+        }
+        f->f_datastack = 0;
+    }
+    else {
+        f->f_datastack = 1;
     }
+    f->f_localsptr = localsptr;
+    f->f_valuestack = localsptr + nslots;
     f->f_locals = NULL;
     f->f_trace = NULL;
     return f;
@@ -874,9 +894,9 @@ frame_get_builtins(PyFrameObject *back, PyObject *globals)
 }
 
 
-PyFrameObject* _Py_HOT_FUNCTION
-_PyFrame_New_NoTrack(PyThreadState *tstate, PyCodeObject *code,
-                     PyObject *globals, PyObject *locals)
+static inline PyFrameObject*
+frame_new(PyThreadState *tstate, PyCodeObject *code,
+          PyObject *globals, PyObject *locals, int on_stack)
 {
 #ifdef Py_DEBUG
     if (code == NULL || globals == NULL || !PyDict_Check(globals) ||
@@ -892,9 +912,25 @@ _PyFrame_New_NoTrack(PyThreadState *tstate, PyCodeObject *code,
         return NULL;
     }
 
-    PyFrameObject *f = frame_alloc(code);
+    PyObject **localsptr = NULL;
+    if (on_stack) {
+        int size = (code->co_nlocals
+                    + (int)PyTuple_GET_SIZE(code->co_cellvars)
+                    + (int)PyTuple_GET_SIZE(code->co_freevars)
+                    + code->co_stacksize);
+        localsptr = _PyThreadState_PushLocals(tstate, size);
+        if (localsptr == NULL) {
+            Py_DECREF(builtins);
+            return NULL;
+        }
+    }
+
+    PyFrameObject *f = frame_alloc(code, localsptr);
     if (f == NULL) {
         Py_DECREF(builtins);
+        if (localsptr != NULL) {
+            _PyThreadState_PopLocals(tstate, localsptr);
+        }
         return NULL;
     }
 
@@ -913,6 +949,9 @@ _PyFrame_New_NoTrack(PyThreadState *tstate, PyCodeObject *code,
         locals = PyDict_New();
         if (locals == NULL) {
             Py_DECREF(f);
+            if (localsptr != NULL) {
+                _PyThreadState_PopLocals(tstate, localsptr);
+            }
             return NULL;
         }
         f->f_locals = locals;
@@ -937,6 +976,70 @@ _PyFrame_New_NoTrack(PyThreadState *tstate, PyCodeObject *code,
     return f;
 }
 
+PyFrameObject* _Py_HOT_FUNCTION
+_PyFrame_New_NoTrack(PyThreadState *tstate, PyCodeObject *code,
+                     PyObject *globals, PyObject *locals)
+{
+    return frame_new(tstate, code, globals, locals, 0);
+}
+
+PyFrameObject* _Py_HOT_FUNCTION
+_PyFrame_NewOnStack_NoTrack(PyThreadState *tstate, PyCodeObject *code,
+                            PyObject *globals, PyObject *locals)
+{
+    return frame_new(tstate, code, globals, locals, 1);
+}
+
+/* Finish a frame created by _PyFrame_NewOnStack_NoTrack() once its
+   evaluation is over.  If the frame is still referenced (by a traceback,
+   sys._getframe(), ...), its locals are moved from the data stack into the
+   frame object itself and the GC starts tracking it; otherwise the frame is
+   freed.  Either way, the data stack slots are released. */
+void _Py_HOT_FUNCTION
+_PyFrame_Release(PyThreadState *tstate, PyFrameObject *f)
+{
+    assert(f->f_datastack);
+    PyObject **localsptr = f->f_localsptr;
+
+    if (Py_REFCNT(f) > 1) {
+        /* The value stack of a finished frame is empty, only the locals
+           have to be copied. */
+        assert(f->f_stacktop == NULL || f->f_stacktop == f->f_valuestack);
+        Py_ssize_t nslots = f->f_valuestack - localsptr;
+        memcpy(f->f_localsplus, localsptr, nslots * sizeof(PyObject *));
+        f->f_localsptr = f->f_localsplus;
+        f->f_valuestack = f->f_localsplus + nslots;
+        if (f->f_stacktop != NULL) {
+            f->f_stacktop = f->f_valuestack;
+        }
+        f->f_datastack = 0;
+        Py_DECREF(f);
+        _PyObject_GC_TRACK(f);
+    }
+    else {
+        /* decref'ing the frame can cause __del__ methods to get invoked,
+           which can call back into Python.  While we're done with the
+           current Python frame (f), the associated C stack is still in
+           use, so recursion_depth must be boosted for the duration.
+           The locals are cleared here rather than in frame_dealloc(): the
+           trashcan may defer the deallocation until after the data stack
+           slots were popped and reused. */
+        ++tstate->recursion_depth;
+        PyObject **valuestack = f->f_valuestack;
+        f->f_localsptr = f->f_valuestack = f->f_localsplus;
+        if (f->f_stacktop != NULL) {
+            f->f_stacktop = f->f_valuestack;
+        }
+        f->f_datastack = 0;
+        for (PyObject **p = localsptr; p < valuestack; p++) {
+            Py_CLEAR(*p);
+        }
+        Py_DECREF(f);
+        --tstate->recursion_depth;
+    }
+    _PyThreadState_PopLocals(tstate, localsptr);
+}
+
 PyFrameObject*
 PyFrame_New(PyThreadState *tstate, PyCodeObject *code,
             PyObject *globals, PyObject *locals)
@@ -1100,7 +1203,7 @@ PyFrame_FastToLocalsWithError(PyFrameObject *f)
                      Py_TYPE(map)->tp_name);
         return -1;
     }
-    fast = f->f_localsplus;
+    fast = f->f_localsptr;
     j = PyTuple_GET_SIZE(map);
     if (j > co->co_nlocals)
         j = co->co_nlocals;
@@ -1164,7 +1267,7 @@ PyFrame_LocalsToFast(PyFrameObject *f, int clear)
     if (!PyTuple_Check(map))
         return;
     PyErr_Fetch(&error_type, &error_value, &error_traceback);
-    fast = f->f_localsplus;
+    fast = f->f_localsptr;
     j = PyTuple_GET_SIZE(map);
     if (j > co->co_nlocals)
         j = co->co_nlocals;
@@ -5716,6 +5716,11 @@ _PyLong_Init(PyThreadState *tstate)
 
         Py_SET_SIZE(v, size);
         v->ob_digit[0] = (digit)abs(ival);
+        /* Small ints are freed by _PyLong_Fini() in subinterpreters, only
+           those of the main interpreter can be immortal. */
+        if (_Py_IsMainInterpreter(tstate)) {
+            _Py_SetImmortal((PyObject *)v);
+        }
 
         tstate->interp->small_ints[i] = v;
     }
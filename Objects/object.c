@@ -1627,7 +1627,7 @@ PyTypeObject _PyNone_Type = {
 
 PyObject _Py_NoneStruct = {
   _PyObject_EXTRA_INIT
-  1, &_PyNone_Type
+  _Py_IMMORTAL_REFCNT, &_PyNone_Type
 };
 
 /* NotImplemented is an object that can be used to signal that an
@@ -1728,7 +1728,7 @@ PyTypeObject _PyNotImplemented_Type = {
 
 PyObject _Py_NotImplementedStruct = {
     _PyObject_EXTRA_INIT
-    1, &_PyNotImplemented_Type
+    _Py_IMMORTAL_REFCNT, &_PyNotImplemented_Type
 };
 
 PyStatus
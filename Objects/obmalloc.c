@@ -1,5 +1,6 @@
 #include "Python.h"
 #include "pycore_pymem.h"         // _PyTraceMalloc_Config
+#include "pycore_pystate.h"       // _PyThreadState_GET()
 
 #include <stdbool.h>
 
@@ -77,6 +78,7 @@ static void _PyMem_SetupDebugHooksDomain(PyMemAllocatorDomain domain);
 static void* _PyObject_Malloc(void *ctx, size_t size);
 static void* _PyObject_Calloc(void *ctx, size_t nelem, size_t elsize);
 static void _PyObject_Free(void *ctx, void *p);
+static void arena_release_retained(void);
 static void* _PyObject_Realloc(void *ctx, void *ptr, size_t size);
 #endif
 
@@ -143,15 +145,42 @@ _PyObject_ArenaVirtualFree(void *ctx, void *ptr, size_t size)
 }
 
 #elif defined(ARENAS_USE_MMAP)
+/* Size of the transparent huge pages of the kernel */
+#define HUGE_PAGE_SIZE (2 << 20)
+
+/* If non-zero, map arenas whose size is a multiple of HUGE_PAGE_SIZE on
+   huge page boundaries and ask the kernel to back them with huge pages.
+   Set by the "hugepages" option of PYTHONMALLOCARENAS. */
+static int arena_hugepages = 0;
+
 static void *
 _PyObject_ArenaMmap(void *ctx, size_t size)
 {
     void *ptr;
-    ptr = mmap(NULL, size, PROT_READ|PROT_WRITE,
+    size_t mapsize = size;
+    int huge = (arena_hugepages && size % HUGE_PAGE_SIZE == 0);
+
+    if (huge) {
+        /* Map a huge page more and unmap the unaligned ends */
+        mapsize += HUGE_PAGE_SIZE;
+    }
+    ptr = mmap(NULL, mapsize, PROT_READ|PROT_WRITE,
                MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
     if (ptr == MAP_FAILED)
         return NULL;
     assert(ptr != NULL);
+    if (huge) {
+        uintptr_t addr = (uintptr_t)ptr;
+        size_t lead = _Py_SIZE_ROUND_UP(addr, HUGE_PAGE_SIZE) - addr;
+        if (lead != 0) {
+            munmap(ptr, lead);
+        }
+        ptr = (char *)ptr + lead;
+        munmap((char *)ptr + size, HUGE_PAGE_SIZE - lead);
+#ifdef MADV_HUGEPAGE
+        (void)madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+    }
     return ptr;
 }
 
@@ -555,6 +584,10 @@ PyObject_GetArenaAllocator(PyObjectArenaAllocator *allocator)
 void
 PyObject_SetArenaAllocator(PyObjectArenaAllocator *allocator)
 {
+#ifdef WITH_PYMALLOC
+    /* The retained arenas were allocated by the previous allocator */
+    arena_release_retained();
+#endif
     _PyObject_Arena = *allocator;
 }
 
@@ -906,11 +939,17 @@ static int running_on_valgrind = -1;
  *
  * Arenas are allocated with mmap() on systems supporting anonymous memory
  * mappings to reduce heap fragmentation.
+ *
+ * ARENA_SIZE is the default size of the arenas.  The "size" option of the
+ * PYTHONMALLOCARENAS environment variable can set it to a larger power of 2
+ * up to MAX_ARENA_SIZE before the first arena is allocated, see
+ * arena_config_init().
  */
 #define ARENA_SIZE              (256 << 10)     /* 256KB */
+#define MAX_ARENA_SIZE          (8 << 20)       /* 8MB */
 
 #ifdef WITH_MEMORY_LIMITS
-#define MAX_ARENAS              (SMALL_MEMORY_LIMIT / ARENA_SIZE)
+#define MAX_ARENAS              (SMALL_MEMORY_LIMIT / arena_size)
 #endif
 
 /*
@@ -920,11 +959,18 @@ static int running_on_valgrind = -1;
 #define POOL_SIZE               SYSTEM_PAGE_SIZE        /* must be 2^N */
 #define POOL_SIZE_MASK          SYSTEM_PAGE_SIZE_MASK
 
-#define MAX_POOLS_IN_ARENA  (ARENA_SIZE / POOL_SIZE)
-#if MAX_POOLS_IN_ARENA * POOL_SIZE != ARENA_SIZE
+#define MAX_POOLS_IN_ARENA  (MAX_ARENA_SIZE / POOL_SIZE)
+#if ARENA_SIZE / POOL_SIZE * POOL_SIZE != ARENA_SIZE
 #   error "arena size not an exact multiple of pool size"
 #endif
 
+/*
+ * Up to this number of wholly free arenas can be kept for reuse instead of
+ * being returned to the system, see the "retain" option of
+ * PYTHONMALLOCARENAS.
+ */
+#define MAX_RETAINED_ARENAS     64
+
 /*
  * -- End of tunable settings section --
  */
@@ -1208,12 +1254,32 @@ static size_t ntimes_arena_allocated = 0;
 /* High water mark (max value ever seen) for narenas_currently_allocated. */
 static size_t narenas_highwater = 0;
 
+/* Size of the arenas, a power of 2 between ARENA_SIZE and MAX_ARENA_SIZE.
+ * It can't change once an arena was allocated. */
+static size_t arena_size = ARENA_SIZE;
+
+/* Wholly free arenas kept for reuse: new_arena() takes them before asking
+ * _PyObject_Arena for memory.  They aren't associated with arena_objects.
+ */
+static void *retained_arenas[MAX_RETAINED_ARENAS];
+static uint nretained_arenas = 0;
+/* Maximum number of retained arenas */
+static uint arena_retain = 0;
+/* If non-zero, give back the pages of retained arenas with MADV_FREE */
+static int arena_madvise = 0;
+/* Total number of times a retained arena was reused. */
+static size_t ntimes_arena_reused = 0;
+
 static Py_ssize_t raw_allocated_blocks;
 
+static size_t tcache_count(size_t counts[NB_SMALL_SIZE_CLASSES]);
+
 Py_ssize_t
 _Py_GetAllocatedBlocks(void)
 {
-    Py_ssize_t n = raw_allocated_blocks;
+    size_t counts[NB_SMALL_SIZE_CLASSES];
+    /* blocks in thread caches are free */
+    Py_ssize_t n = raw_allocated_blocks - (Py_ssize_t)tcache_count(counts);
     /* add up allocated blocks for used pools */
     for (uint i = 0; i < maxarenas; ++i) {
         /* Skip arenas which are not allocated. */
@@ -1234,6 +1300,118 @@ _Py_GetAllocatedBlocks(void)
 }
 
 
+/* Parse the PYTHONMALLOCARENAS environment variable, a comma separated list
+ * of "name=value" options, before the first arena is allocated.  Sizes can
+ * have a "K" or "M" suffix.
+ */
+static void
+arena_config_init(void)
+{
+    const char *opt = Py_GETENV("PYTHONMALLOCARENAS");
+    if (opt == NULL || *opt == '\0') {
+        return;
+    }
+    for (;;) {
+        const char *end = strchr(opt, ',');
+        if (end == NULL) {
+            end = opt + strlen(opt);
+        }
+        const char *value = memchr(opt, '=', end - opt);
+        if (value == NULL) {
+            goto error;
+        }
+        size_t namelen = value - opt;
+        value++;
+        if (!Py_ISDIGIT(*value)) {
+            goto error;
+        }
+        char *endvalue;
+        size_t n = strtoul(value, &endvalue, 10);
+        if (n > MAX_ARENA_SIZE) {
+            goto error;
+        }
+        if (*endvalue == 'K') {
+            n <<= 10;
+            endvalue++;
+        }
+        else if (*endvalue == 'M') {
+            n <<= 20;
+            endvalue++;
+        }
+        if (endvalue != end) {
+            goto error;
+        }
+
+        if (namelen == 4 && strncmp(opt, "size", 4) == 0) {
+            if (n < ARENA_SIZE || n > MAX_ARENA_SIZE || (n & (n - 1)) != 0) {
+                goto error;
+            }
+            arena_size = n;
+        }
+        else if (namelen == 6 && strncmp(opt, "retain", 6) == 0) {
+            if (n > MAX_RETAINED_ARENAS) {
+                goto error;
+            }
+            arena_retain = (uint)n;
+        }
+        else if (namelen == 7 && strncmp(opt, "madvise", 7) == 0) {
+            if (n > 1) {
+                goto error;
+            }
+            arena_madvise = (int)n;
+        }
+        else if (namelen == 9 && strncmp(opt, "hugepages", 9) == 0) {
+            if (n > 1) {
+                goto error;
+            }
+#ifdef ARENAS_USE_MMAP
+            arena_hugepages = (int)n;
+#endif
+        }
+        else {
+            goto error;
+        }
+        if (*end == '\0') {
+            return;
+        }
+        opt = end + 1;
+    }
+
+error:
+    Py_FatalError("PYTHONMALLOCARENAS: invalid option");
+}
+
+/* Give back the memory of a wholly free arena, or keep it for new_arena()
+ * if fewer than arena_retain arenas are retained.
+ */
+static void
+arena_release(void *address)
+{
+    if (nretained_arenas < arena_retain) {
+#if defined(ARENAS_USE_MMAP) && defined(MADV_FREE)
+        if (arena_madvise && _PyObject_Arena.free == _PyObject_ArenaMunmap) {
+            /* The kernel reclaims the pages when it needs memory, but the
+               address range stays mapped. */
+            (void)madvise(address, arena_size, MADV_FREE);
+        }
+#endif
+        retained_arenas[nretained_arenas++] = address;
+        return;
+    }
+    _PyObject_Arena.free(_PyObject_Arena.ctx, address, arena_size);
+}
+
+/* Give back the memory of all retained arenas */
+static void
+arena_release_retained(void)
+{
+    while (nretained_arenas > 0) {
+        void *address = retained_arenas[--nretained_arenas];
+        _PyObject_Arena.free(_PyObject_Arena.ctx, address, arena_size);
+    }
+}
+
+
 /* Allocate a new arena.  If we run out of memory, return NULL.  Else
  * allocate a new arena, and return the address of an arena_object
  * describing the new arena.  It's expected that the caller will set
@@ -1250,6 +1428,8 @@ new_arena(void)
     if (debug_stats == -1) {
         const char *opt = Py_GETENV("PYTHONMALLOCSTATS");
         debug_stats = (opt != NULL && *opt != '\0');
+        /* This is the first arena */
+        arena_config_init();
     }
     if (debug_stats)
         _PyObject_DebugMallocStats(stderr);
@@ -1301,26 +1481,32 @@ new_arena(void)
     arenaobj = unused_arena_objects;
     unused_arena_objects = arenaobj->nextarena;
     assert(arenaobj->address == 0);
-    address = _PyObject_Arena.alloc(_PyObject_Arena.ctx, ARENA_SIZE);
-    if (address == NULL) {
-        /* The allocation failed: return NULL after putting the
-         * arenaobj back.
-         */
-        arenaobj->nextarena = unused_arena_objects;
-        unused_arena_objects = arenaobj;
-        return NULL;
+    if (nretained_arenas > 0) {
+        address = retained_arenas[--nretained_arenas];
+        ++ntimes_arena_reused;
+    }
+    else {
+        address = _PyObject_Arena.alloc(_PyObject_Arena.ctx, arena_size);
+        if (address == NULL) {
+            /* The allocation failed: return NULL after putting the
+             * arenaobj back.
+             */
+            arenaobj->nextarena = unused_arena_objects;
+            unused_arena_objects = arenaobj;
+            return NULL;
+        }
+        ++ntimes_arena_allocated;
     }
     arenaobj->address = (uintptr_t)address;
 
     ++narenas_currently_allocated;
-    ++ntimes_arena_allocated;
     if (narenas_currently_allocated > narenas_highwater)
         narenas_highwater = narenas_currently_allocated;
     arenaobj->freepools = NULL;
     /* pool_address <- first pool-aligned address in the arena
        nfreepools <- number of whole pools that fit after alignment */
     arenaobj->pool_address = (block*)arenaobj->address;
-    arenaobj->nfreepools = MAX_POOLS_IN_ARENA;
+    arenaobj->nfreepools = (uint)(arena_size / POOL_SIZE);
     excess = (uint)(arenaobj->address & POOL_SIZE_MASK);
     if (excess != 0) {
         --arenaobj->nfreepools;
@@ -1419,7 +1605,7 @@ address_in_range(void *p, poolp pool)
     // only once.
     uint arenaindex = *((volatile uint *)&pool->arenaindex);
     return arenaindex < maxarenas &&
-        (uintptr_t)p - arenas[arenaindex].address < ARENA_SIZE &&
+        (uintptr_t)p - arenas[arenaindex].address < arena_size &&
         arenas[arenaindex].address != 0;
 }
 
@@ -1516,7 +1702,7 @@ allocate_from_new_pool(uint size)
             assert(usable_arenas->freepools != NULL ||
                    usable_arenas->pool_address <=
                    (block*)usable_arenas->address +
-                       ARENA_SIZE - POOL_SIZE);
+                       arena_size - POOL_SIZE);
         }
     }
     else {
@@ -1525,7 +1711,7 @@ allocate_from_new_pool(uint size)
         assert(usable_arenas->freepools == NULL);
         pool = (poolp)usable_arenas->pool_address;
         assert((block*)pool <= (block*)usable_arenas->address +
-                                 ARENA_SIZE - POOL_SIZE);
+                                 arena_size - POOL_SIZE);
         pool->arenaindex = (uint)(usable_arenas - arenas);
         assert(&arenas[pool->arenaindex] == usable_arenas);
         pool->szidx = DUMMY_SIZE_IDX;
@@ -1578,6 +1764,56 @@ allocate_from_new_pool(uint size)
     return bp;
 }
 
+/*==========================================================================*/
+
+/* Thread caches.
+
+   When enabled (see _PyObject_SetThreadCaches()), each thread state has a
+   small cache of free blocks per size class: pymalloc_free() pushes the
+   block onto the cache of the current thread and pymalloc_alloc() pops it
+   from there, without writing to the pool of the block nor to the shared
+   usedpools table.  Threads handing the GIL over to each other then reuse
+   their own blocks instead of bouncing the same pool headers between CPUs.
+   Once the list of a size class is full, blocks go back to their pool.
+
+   A cached block still counts as allocated in its pool, so its pool and
+   arena cannot be released.  This also keeps pools from becoming empty
+   and being carved out again from the start, which is why the caches are
+   disabled by default: a single thread only pays for them.  The blocks of
+   a cache are returned to their pools in one batch when its thread state
+   is cleared (see _PyObject_ClearThreadCache()) or when caches are
+   disabled.
+
+   Caches are only used while a thread state is current, that is with the
+   GIL held, which also protects the pools when a cache is flushed.
+*/
+
+/* Bytes cached per size class: 512 blocks of 16 bytes, 16 of 512 bytes */
+#define TCACHE_BYTES            (8 * 1024)
+#define TCACHE_MAXBLOCKS(I)     (TCACHE_BYTES / INDEX2SIZE(I))
+
+static int tcache_enabled = 0;
+
+struct _obmalloc_tcache {
+    block *freeblock[NB_SMALL_SIZE_CLASSES];
+    /* # of blocks which can still be cached per size class */
+    uint room[NB_SMALL_SIZE_CLASSES];
+};
+
+/* Cache of thread states which were cleared: it has no room for blocks */
+static struct _obmalloc_tcache tcache_disabled;
+
+static inline struct _obmalloc_tcache *
+tcache_get(void)
+{
+    PyThreadState *tstate = _PyThreadState_GET();
+    if (tstate == NULL) {
+        return NULL;
+    }
+    return tstate->obmalloc_cache;
+}
+
+
 /* pymalloc allocator
 
    Return a pointer to newly allocated memory if pymalloc allocated memory.
@@ -1606,9 +1842,18 @@ pymalloc_alloc(void *ctx, size_t nbytes)
     }
 
     uint size = (uint)(nbytes - 1) >> ALIGNMENT_SHIFT;
-    poolp pool = usedpools[size + size];
     block *bp;
 
+    if (UNLIKELY(tcache_enabled)) {
+        struct _obmalloc_tcache *cache = tcache_get();
+        if (cache != NULL && (bp = cache->freeblock[size]) != NULL) {
+            cache->freeblock[size] = *(block **)bp;
+            cache->room[size]++;
+            return (void *)bp;
+        }
+    }
+
+    poolp pool = usedpools[size + size];
     if (LIKELY(pool != pool->nextpool)) {
         /*
          * There is a used pool for this size class.
@@ -1769,8 +2014,7 @@ insert_to_freepool(poolp pool)
         unused_arena_objects = ao;
 
         /* Free the entire arena. */
-        _PyObject_Arena.free(_PyObject_Arena.ctx,
-                             (void *)ao->address, ARENA_SIZE);
+        arena_release((void *)ao->address);
         ao->address = 0;                        /* mark unassociated */
         --narenas_currently_allocated;
 
@@ -1848,26 +2092,10 @@ insert_to_freepool(poolp pool)
            || ao->prevarena->nextarena == ao);
 }
 
-/* Free a memory block allocated by pymalloc_alloc().
-   Return 1 if it was freed.
-   Return 0 if the block was not allocated by pymalloc_alloc(). */
-static inline int
-pymalloc_free(void *ctx, void *p)
+/* Return the block p of pool to the free list of the pool. */
+static inline void
+pool_free_block(poolp pool, void *p)
 {
-    assert(p != NULL);
-
-#ifdef WITH_VALGRIND
-    if (UNLIKELY(running_on_valgrind > 0)) {
-        return 0;
-    }
-#endif
-
-    poolp pool = POOL_ADDR(p);
-    if (UNLIKELY(!address_in_range(p, pool))) {
-        return 0;
-    }
-    /* We allocated this address. */
-
     /* Link p to the start of the pool's freeblock list.  Since
      * the pool had at least the p block outstanding, the pool
      * wasn't empty (so it's already in a usedpools[] list, or
@@ -1888,7 +2116,7 @@ pymalloc_free(void *ctx, void *p)
          * blocks of the same size class.
          */
         insert_to_usedpool(pool);
-        return 1;
+        return;
     }
 
     /* freeblock wasn't NULL, so the pool wasn't full,
@@ -1896,7 +2124,7 @@ pymalloc_free(void *ctx, void *p)
      */
     if (LIKELY(pool->ref.count != 0)) {
         /* pool isn't empty:  leave it in usedpools */
-        return 1;
+        return;
     }
 
     /* Pool is now empty:  unlink from usedpools, and
@@ -1905,6 +2133,146 @@ pymalloc_free(void *ctx, void *p)
      * (being not referenced, they are perhaps paged out).
      */
     insert_to_freepool(pool);
+}
+
+/* Return the blocks of the list bp to their pools. */
+static void
+tcache_release_blocks(block *bp)
+{
+    while (bp != NULL) {
+        block *next = *(block **)bp;
+        pool_free_block(POOL_ADDR(bp), bp);
+        bp = next;
+    }
+}
+
+static struct _obmalloc_tcache *
+tcache_new(PyThreadState *tstate)
+{
+    /* Don't use PyMem_RawCalloc(): it can be hooked by tracemalloc, which
+       may be calling us. */
+    struct _obmalloc_tcache *cache = calloc(1, sizeof(*cache));
+    if (cache != NULL) {
+        for (uint i = 0; i < NB_SMALL_SIZE_CLASSES; i++) {
+            cache->room[i] = TCACHE_MAXBLOCKS(i);
+        }
+    }
+    tstate->obmalloc_cache = cache;
+    return cache;
+}
+
+/* Return the blocks of the cache of tstate to their pools, free the cache
+   and replace it with new_cache. */
+static void
+tcache_flush(PyThreadState *tstate, struct _obmalloc_tcache *new_cache)
+{
+    struct _obmalloc_tcache *cache = tstate->obmalloc_cache;
+    tstate->obmalloc_cache = new_cache;
+    if (cache == NULL || cache == &tcache_disabled) {
+        return;
+    }
+    for (uint i = 0; i < NB_SMALL_SIZE_CLASSES; i++) {
+        tcache_release_blocks(cache->freeblock[i]);
+    }
+    free(cache);
+}
+
+void
+_PyObject_ClearThreadCache(PyThreadState *tstate)
+{
+    /* A cleared thread state may still free memory: don't cache it */
+    tcache_flush(tstate, &tcache_disabled);
+}
+
+void
+_PyObject_SetThreadCaches(int enabled)
+{
+    if (enabled || !tcache_enabled) {
+        tcache_enabled = enabled;
+        return;
+    }
+    tcache_enabled = 0;
+    PyInterpreterState *interp = PyInterpreterState_Head();
+    for (; interp != NULL; interp = PyInterpreterState_Next(interp)) {
+        PyThreadState *tstate = PyInterpreterState_ThreadHead(interp);
+        for (; tstate != NULL; tstate = PyThreadState_Next(tstate)) {
+            if (tstate->obmalloc_cache != &tcache_disabled) {
+                /* Created again if caches are enabled again */
+                tcache_flush(tstate, NULL);
+            }
+        }
+    }
+}
+
+int
+_PyObject_GetThreadCaches(void)
+{
+    return tcache_enabled;
+}
+
+/* Count the blocks of each size class held in the caches of all
+   threads, and return the total. */
+static size_t
+tcache_count(size_t counts[NB_SMALL_SIZE_CLASSES])
+{
+    size_t total = 0;
+    for (uint i = 0; i < NB_SMALL_SIZE_CLASSES; i++) {
+        counts[i] = 0;
+    }
+    PyInterpreterState *interp = PyInterpreterState_Head();
+    for (; interp != NULL; interp = PyInterpreterState_Next(interp)) {
+        PyThreadState *tstate = PyInterpreterState_ThreadHead(interp);
+        for (; tstate != NULL; tstate = PyThreadState_Next(tstate)) {
+            struct _obmalloc_tcache *cache = tstate->obmalloc_cache;
+            if (cache == NULL || cache == &tcache_disabled) {
+                continue;
+            }
+            for (uint i = 0; i < NB_SMALL_SIZE_CLASSES; i++) {
+                uint n = TCACHE_MAXBLOCKS(i) - cache->room[i];
+                counts[i] += n;
+                total += n;
+            }
+        }
+    }
+    return total;
+}
+
+/* Free a memory block allocated by pymalloc_alloc().
+   Return 1 if it was freed.
+   Return 0 if the block was not allocated by pymalloc_alloc(). */
+static inline int
+pymalloc_free(void *ctx, void *p)
+{
+    assert(p != NULL);
+
+#ifdef WITH_VALGRIND
+    if (UNLIKELY(running_on_valgrind > 0)) {
+        return 0;
+    }
+#endif
+
+    poolp pool = POOL_ADDR(p);
+    if (UNLIKELY(!address_in_range(p, pool))) {
+        return 0;
+    }
+    /* We allocated this address. */
+
+    PyThreadState *tstate;
+    if (UNLIKELY(tcache_enabled) && (tstate = _PyThreadState_GET()) != NULL) {
+        struct _obmalloc_tcache *cache = tstate->obmalloc_cache;
+        if (UNLIKELY(cache == NULL)) {
+            cache = tcache_new(tstate);
+        }
+        uint size = pool->szidx;
+        if (LIKELY(cache != NULL && cache->room[size] != 0)) {
+            *(block **)p = cache->freeblock[size];
+            cache->freeblock[size] = (block *)p;
+            cache->room[size]--;
+            return 1;
+        }
+    }
+
+    pool_free_block(pool, p);
     return 1;
 }
 
@@ -2023,6 +2391,28 @@ _Py_GetAllocatedBlocks(void)
     return 0;
 }
 
+void
+_PyObject_ClearThreadCache(PyThreadState *tstate)
+{
+}
+
+void
+_PyObject_SetThreadCaches(int enabled)
+{
+}
+
+int
+_PyObject_GetThreadCaches(void)
+{
+    return 0;
+}
+
+PyObject *
+_PyObject_GetMallocStats(void)
+{
+    Py_RETURN_NONE;
+}
+
 #endif /* WITH_PYMALLOC */
 
 
@@ -2584,52 +2974,32 @@ pool_is_in_list(const poolp target, poolp list)
 }
 #endif
 
-/* Print summary info to "out" about the state of pymalloc's structures.
- * In Py_DEBUG mode, also perform some expensive internal consistency
- * checks.
- *
- * Return 0 if the memory debug hooks are not installed or no statistics was
- * written into out, return 1 otherwise.
- */
-int
-_PyObject_DebugMallocStats(FILE *out)
-{
-    if (!_PyMem_PymallocEnabled()) {
-        return 0;
-    }
-
-    uint i;
-    const uint numclasses = SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT;
+/* Counters of pymalloc's pools and blocks, see pymalloc_count() */
+struct pymalloc_counts {
     /* # of pools, allocated blocks, and free blocks per class index */
-    size_t numpools[SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT];
-    size_t numblocks[SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT];
-    size_t numfreeblocks[SMALL_REQUEST_THRESHOLD >> ALIGNMENT_SHIFT];
-    /* total # of allocated bytes in used and full pools */
-    size_t allocated_bytes = 0;
-    /* total # of available bytes in used pools */
-    size_t available_bytes = 0;
+    size_t numpools[NB_SMALL_SIZE_CLASSES];
+    size_t numblocks[NB_SMALL_SIZE_CLASSES];
+    size_t numfreeblocks[NB_SMALL_SIZE_CLASSES];
+    /* # of blocks in thread caches per class index, they are also counted
+       in numblocks */
+    size_t numcachedblocks[NB_SMALL_SIZE_CLASSES];
     /* # of free pools + pools not yet carved out of current arena */
-    uint numfreepools = 0;
+    size_t numfreepools;
     /* # of bytes for arena alignment padding */
-    size_t arena_alignment = 0;
-    /* # of bytes in used and full pools used for pool_headers */
-    size_t pool_header_bytes = 0;
-    /* # of bytes in used and full pools wasted due to quantization,
-     * i.e. the necessarily leftover space at the ends of used and
-     * full pools.
-     */
-    size_t quantization = 0;
+    size_t arena_alignment;
     /* # of arenas actually allocated. */
-    size_t narenas = 0;
-    /* running total -- should equal narenas * ARENA_SIZE */
-    size_t total;
-    char buf[128];
+    size_t narenas;
+};
 
-    fprintf(out, "Small block threshold = %d, in %u size classes.\n",
-            SMALL_REQUEST_THRESHOLD, numclasses);
+/* Fill "c" by marching over all the arenas.  In Py_DEBUG mode, also perform
+ * some expensive internal consistency checks.
+ */
+static void
+pymalloc_count(struct pymalloc_counts *c)
+{
+    uint i;
 
-    for (i = 0; i < numclasses; ++i)
-        numpools[i] = numblocks[i] = numfreeblocks[i] = 0;
+    memset(c, 0, sizeof(*c));
 
     /* Because full pools aren't linked to from anything, it's easiest
      * to march over all the arenas.  If we're lucky, most of the memory
@@ -2642,13 +3012,13 @@ _PyObject_DebugMallocStats(FILE *out)
         /* Skip arenas which are not allocated. */
         if (arenas[i].address == (uintptr_t)NULL)
             continue;
-        narenas += 1;
+        c->narenas += 1;
 
-        numfreepools += arenas[i].nfreepools;
+        c->numfreepools += arenas[i].nfreepools;
 
         /* round up to pool alignment */
         if (base & (uintptr_t)POOL_SIZE_MASK) {
-            arena_alignment += POOL_SIZE;
+            c->arena_alignment += POOL_SIZE;
             base &= ~(uintptr_t)POOL_SIZE_MASK;
             base += POOL_SIZE;
         }
@@ -2668,17 +3038,58 @@ _PyObject_DebugMallocStats(FILE *out)
 #endif
                 continue;
             }
-            ++numpools[sz];
-            numblocks[sz] += p->ref.count;
+            ++c->numpools[sz];
+            c->numblocks[sz] += p->ref.count;
             freeblocks = NUMBLOCKS(sz) - p->ref.count;
-            numfreeblocks[sz] += freeblocks;
+            c->numfreeblocks[sz] += freeblocks;
 #ifdef Py_DEBUG
             if (freeblocks > 0)
                 assert(pool_is_in_list(p, usedpools[sz + sz]));
 #endif
         }
     }
-    assert(narenas == narenas_currently_allocated);
+    assert(c->narenas == narenas_currently_allocated);
+    (void)tcache_count(c->numcachedblocks);
+}
+
+/* Print summary info to "out" about the state of pymalloc's structures.
+ * In Py_DEBUG mode, also perform some expensive internal consistency
+ * checks.
+ *
+ * Return 0 if the memory debug hooks are not installed or no statistics was
+ * written into out, return 1 otherwise.
+ */
+int
+_PyObject_DebugMallocStats(FILE *out)
+{
+    if (!_PyMem_PymallocEnabled()) {
+        return 0;
+    }
+
+    uint i;
+    const uint numclasses = NB_SMALL_SIZE_CLASSES;
+    struct pymalloc_counts c;
+    /* total # of allocated bytes in used and full pools */
+    size_t allocated_bytes = 0;
+    /* total # of bytes in thread caches */
+    size_t cached_bytes = 0;
+    /* total # of available bytes in used pools */
+    size_t available_bytes = 0;
+    /* # of bytes in used and full pools used for pool_headers */
+    size_t pool_header_bytes = 0;
+    /* # of bytes in used and full pools wasted due to quantization,
+     * i.e. the necessarily leftover space at the ends of used and
+     * full pools.
+     */
+    size_t quantization = 0;
+    /* running total -- should equal narenas * arena_size */
+    size_t total;
+    char buf[128];
+
+    fprintf(out, "Small block threshold = %d, in %u size classes.\n",
+            SMALL_REQUEST_THRESHOLD, numclasses);
+
+    pymalloc_count(&c);
 
     fputc('\n', out);
     fputs("class   size   num pools   blocks in use  avail blocks\n"
@@ -2686,9 +3097,9 @@ _PyObject_DebugMallocStats(FILE *out)
           out);
 
     for (i = 0; i < numclasses; ++i) {
-        size_t p = numpools[i];
-        size_t b = numblocks[i];
-        size_t f = numfreeblocks[i];
+        size_t p = c.numpools[i];
+        size_t b = c.numblocks[i];
+        size_t f = c.numfreeblocks[i];
         uint size = INDEX2SIZE(i);
         if (p == 0) {
             assert(b == 0 && f == 0);
@@ -2696,7 +3107,9 @@ _PyObject_DebugMallocStats(FILE *out)
         }
         fprintf(out, "%5u %6u %11zu %15zu %13zu\n",
                 i, size, p, b, f);
-        allocated_bytes += b * size;
+        /* cached blocks are counted in use by their pool */
+        allocated_bytes += (b - c.numcachedblocks[i]) * size;
+        cached_bytes += c.numcachedblocks[i] * size;
         available_bytes += f * size;
         pool_header_bytes += p * POOL_OVERHEAD;
         quantization += p * ((POOL_SIZE - POOL_OVERHEAD) % size);
@@ -2708,29 +3121,142 @@ _PyObject_DebugMallocStats(FILE *out)
     }
 #endif
     (void)printone(out, "# arenas allocated total", ntimes_arena_allocated);
-    (void)printone(out, "# arenas reclaimed", ntimes_arena_allocated - narenas);
+    (void)printone(out, "# arenas reclaimed",
+                   ntimes_arena_allocated - c.narenas - nretained_arenas);
     (void)printone(out, "# arenas highwater mark", narenas_highwater);
-    (void)printone(out, "# arenas allocated current", narenas);
+    (void)printone(out, "# arenas allocated current", c.narenas);
+    (void)printone(out, "# arenas reused", ntimes_arena_reused);
 
     PyOS_snprintf(buf, sizeof(buf),
-                  "%zu arenas * %d bytes/arena",
-                  narenas, ARENA_SIZE);
-    (void)printone(out, buf, narenas * ARENA_SIZE);
+                  "%zu arenas * %zu bytes/arena",
+                  c.narenas, arena_size);
+    (void)printone(out, buf, c.narenas * arena_size);
+
+    PyOS_snprintf(buf, sizeof(buf),
+                  "%u retained arenas (max %u)",
+                  nretained_arenas, arena_retain);
+    (void)printone(out, buf, (size_t)nretained_arenas * arena_size);
+#ifdef ARENAS_USE_MMAP
+    int hugepages = arena_hugepages;
+#else
+    int hugepages = 0;
+#endif
+    fprintf(out, "Arena options: size=%zu, retain=%u, madvise=%d, "
+            "hugepages=%d\n",
+            arena_size, arena_retain, arena_madvise, hugepages);
 
     fputc('\n', out);
 
     total = printone(out, "# bytes in allocated blocks", allocated_bytes);
+    total += printone(out, "# bytes in thread caches", cached_bytes);
     total += printone(out, "# bytes in available blocks", available_bytes);
 
     PyOS_snprintf(buf, sizeof(buf),
-        "%u unused pools * %d bytes", numfreepools, POOL_SIZE);
-    total += printone(out, buf, (size_t)numfreepools * POOL_SIZE);
+        "%zu unused pools * %d bytes", c.numfreepools, POOL_SIZE);
+    total += printone(out, buf, c.numfreepools * POOL_SIZE);
 
     total += printone(out, "# bytes lost to pool headers", pool_header_bytes);
     total += printone(out, "# bytes lost to quantization", quantization);
-    total += printone(out, "# bytes lost to arena alignment", arena_alignment);
+    total += printone(out, "# bytes lost to arena alignment",
+                      c.arena_alignment);
     (void)printone(out, "Total", total);
     return 1;
 }
 
+/* Return a dict describing the state of pymalloc's structures, the same
+ * information as _PyObject_DebugMallocStats() prints, or None if pymalloc
+ * is not used.
+ */
+PyObject *
+_PyObject_GetMallocStats(void)
+{
+    if (!_PyMem_PymallocEnabled()) {
+        Py_RETURN_NONE;
+    }
+
+    /* Count before allocating the result which changes the counts */
+    struct pymalloc_counts c;
+    pymalloc_count(&c);
+
+    size_t allocated_bytes = 0;
+    size_t cached_bytes = 0;
+    size_t available_bytes = 0;
+    size_t pool_header_bytes = 0;
+    size_t quantization = 0;
+    for (uint i = 0; i < NB_SMALL_SIZE_CLASSES; ++i) {
+        size_t p = c.numpools[i];
+        uint size = INDEX2SIZE(i);
+        allocated_bytes += (c.numblocks[i] - c.numcachedblocks[i]) * size;
+        cached_bytes += c.numcachedblocks[i] * size;
+        available_bytes += c.numfreeblocks[i] * size;
+        pool_header_bytes += p * POOL_OVERHEAD;
+        quantization += p * ((POOL_SIZE - POOL_OVERHEAD) % size);
+    }
+    size_t arena_bytes = c.narenas * arena_size;
+    /* Share of the arenas not used by allocated blocks */
+    double fragmentation = 0.0;
+    if (arena_bytes != 0) {
+        fragmentation = 1.0 - (double)allocated_bytes / (double)arena_bytes;
+    }
+
+    PyObject *size_classes = PyDict_New();
+    if (size_classes == NULL) {
+        return NULL;
+    }
+    for (uint i = 0; i < NB_SMALL_SIZE_CLASSES; ++i) {
+        if (c.numpools[i] == 0) {
+            continue;
+        }
+        PyObject *item = Py_BuildValue(
+            "(nnnn)",
+            (Py_ssize_t)c.numpools[i],
+            (Py_ssize_t)(c.numblocks[i] - c.numcachedblocks[i]),
+            (Py_ssize_t)c.numfreeblocks[i],
+            (Py_ssize_t)c.numcachedblocks[i]);
+        if (item == NULL) {
+            goto error;
+        }
+        PyObject *key = PyLong_FromLong(INDEX2SIZE(i));
+        if (key == NULL) {
+            Py_DECREF(item);
+            goto error;
+        }
+        int res = PyDict_SetItem(size_classes, key, item);
+        Py_DECREF(key);
+        Py_DECREF(item);
+        if (res < 0) {
+            goto error;
+        }
+    }
+
+    PyObject *stats = Py_BuildValue(
+        "{s:n,s:n,s:n,s:n,s:n,s:n,s:n,s:n,"
+        "s:n,s:n,s:n,s:n,s:n,s:n,s:n,s:n,s:d,s:O}",
+        "arena_size", (Py_ssize_t)arena_size,
+        "pool_size", (Py_ssize_t)POOL_SIZE,
+        "arenas", (Py_ssize_t)c.narenas,
+        "arenas_highwater", (Py_ssize_t)narenas_highwater,
+        "arenas_allocated_total", (Py_ssize_t)ntimes_arena_allocated,
+        "arenas_reclaimed",
+        (Py_ssize_t)(ntimes_arena_allocated - c.narenas - nretained_arenas),
+        "arenas_reused", (Py_ssize_t)ntimes_arena_reused,
+        "arenas_retained", (Py_ssize_t)nretained_arenas,
+        "free_pools", (Py_ssize_t)c.numfreepools,
+        "allocated_bytes", (Py_ssize_t)allocated_bytes,
+        "cached_bytes", (Py_ssize_t)cached_bytes,
+        "available_bytes", (Py_ssize_t)available_bytes,
+        "free_pool_bytes", (Py_ssize_t)(c.numfreepools * POOL_SIZE),
+        "pool_header_bytes", (Py_ssize_t)pool_header_bytes,
+        "quantization_bytes", (Py_ssize_t)quantization,
+        "arena_alignment_bytes", (Py_ssize_t)c.arena_alignment,
+        "fragmentation", fragmentation,
+        "size_classes", size_classes);
+    Py_DECREF(size_classes);
+    return stats;
+
+error:
+    Py_DECREF(size_classes);
+    return NULL;
+}
+
 #endif /* #ifdef WITH_PYMALLOC */
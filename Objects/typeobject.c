@@ -19,10 +19,12 @@ class object "PyObject *" "&PyBaseObject_Type"
 
 #include "clinic/typeobject.c.h"
 
-/* bpo-40521: Type method cache is shared by all subinterpreters */
-#ifndef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
-#  define MCACHE
-#endif
+/* The type method cache is per interpreter, but version tags are shared by
+   all interpreters since static types are.  When interpreters run in
+   parallel (EXPERIMENTAL_ISOLATED_SUBINTERPRETERS), tags are allocated under
+   version_tag_lock and never recycled, so that an interpreter never has to
+   clear the cache of another one. */
+#define MCACHE
 
 #ifdef MCACHE
 /* Support type attribute cache */
@@ -32,37 +34,38 @@ class object "PyObject *" "&PyBaseObject_Type"
    MCACHE_MAX_ATTR_SIZE, since it might be a problem if very large
    strings are used as attribute names. */
 #define MCACHE_MAX_ATTR_SIZE    100
+
+/* Each interpreter starts with a cache of 1 << MCACHE_SIZE_EXP entries.
+   The cache is doubled, up to 1 << MCACHE_MAX_SIZE_EXP entries, when
+   there have been more collisions than entries since the last resize and
+   more than one lookup out of MCACHE_GROW_RATIO ended in a collision. */
 #define MCACHE_SIZE_EXP         12
-#define MCACHE_HASH(version, name_hash)                                 \
+#define MCACHE_MAX_SIZE_EXP     16
+#define MCACHE_GROW_RATIO       16
+
+#define MCACHE_HASH(cache, version, name_hash)                          \
         (((unsigned int)(version) ^ (unsigned int)(name_hash))          \
-         & ((1 << MCACHE_SIZE_EXP) - 1))
+         & ((1U << (cache)->size_exp) - 1))
 
-#define MCACHE_HASH_METHOD(type, name)                                  \
-        MCACHE_HASH((type)->tp_version_tag,                     \
+#define MCACHE_HASH_METHOD(cache, type, name)                           \
+        MCACHE_HASH((cache), (type)->tp_version_tag,                    \
                     ((PyASCIIObject *)(name))->hash)
 #define MCACHE_CACHEABLE_NAME(name)                             \
         PyUnicode_CheckExact(name) &&                           \
         PyUnicode_IS_READY(name) &&                             \
         PyUnicode_GET_LENGTH(name) <= MCACHE_MAX_ATTR_SIZE
 
-struct method_cache_entry {
-    unsigned int version;
-    PyObject *name;             /* reference to exactly a str or None */
-    PyObject *value;            /* borrowed */
-};
-
-static struct method_cache_entry method_cache[1 << MCACHE_SIZE_EXP];
+/* Version tags are shared by all interpreters, since static types are */
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+static unsigned int next_version_tag = 1;
+static PyThread_type_lock version_tag_lock = NULL;
+#else
 static unsigned int next_version_tag = 0;
 #endif
+#endif
 
 #define MCACHE_STATS 0
 
-#if MCACHE_STATS
-static size_t method_cache_hits = 0;
-static size_t method_cache_misses = 0;
-static size_t method_cache_collisions = 0;
-#endif
-
 /* bpo-40521: Interned strings are shared by all subinterpreters */
 #ifndef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
 #  define INTERN_NAME_STRINGS
@@ -220,30 +223,152 @@ _PyType_GetTextSignatureFromInternalDoc(const char *name, const char *internal_d
     return PyUnicode_FromStringAndSize(start, end - start);
 }
 
-unsigned int
-PyType_ClearCache(void)
+static struct type_cache *
+get_type_cache(void)
 {
+    PyInterpreterState *interp = _PyInterpreterState_GET();
+    return &interp->type_cache;
+}
+
+static void
+type_cache_clear(struct type_cache *cache)
+{
+    if (cache->hashtable == NULL) {
+        return;
+    }
+    size_t size = (size_t)1 << cache->size_exp;
+    for (size_t i = 0; i < size; i++) {
+        struct type_cache_entry *entry = &cache->hashtable[i];
+        entry->version = 0;
+        Py_CLEAR(entry->name);
+        entry->value = NULL;
+    }
+}
+
+#if defined(MCACHE) && !defined(EXPERIMENTAL_ISOLATED_SUBINTERPRETERS)
+/* Version tags are about to be reused: drop the entries of all
+   interpreters, they would match types with recycled tags. */
+static void
+type_cache_clear_all(void)
+{
+    PyInterpreterState *interp = PyInterpreterState_Head();
+    for (; interp != NULL; interp = PyInterpreterState_Next(interp)) {
+        type_cache_clear(&interp->type_cache);
+    }
+}
+#endif
+
 #ifdef MCACHE
-    Py_ssize_t i;
-    unsigned int cur_version_tag = next_version_tag - 1;
+/* Grow the cache to 1 << size_exp entries, moving the existing entries.
+   On memory allocation failure, keep the current table. */
+static void
+type_cache_resize(struct type_cache *cache, unsigned int size_exp)
+{
+    size_t size = (size_t)1 << size_exp;
+    struct type_cache_entry *hashtable;
 
-#if MCACHE_STATS
-    size_t total = method_cache_hits + method_cache_collisions + method_cache_misses;
-    fprintf(stderr, "-- Method cache hits        = %zd (%d%%)\n",
-            method_cache_hits, (int) (100.0 * method_cache_hits / total));
-    fprintf(stderr, "-- Method cache true misses = %zd (%d%%)\n",
-            method_cache_misses, (int) (100.0 * method_cache_misses / total));
-    fprintf(stderr, "-- Method cache collisions  = %zd (%d%%)\n",
-            method_cache_collisions, (int) (100.0 * method_cache_collisions / total));
-    fprintf(stderr, "-- Method cache size        = %zd KiB\n",
-            sizeof(method_cache) / 1024);
+    hashtable = PyMem_Calloc(size, sizeof(struct type_cache_entry));
+    if (hashtable == NULL) {
+        return;
+    }
+
+    struct type_cache_entry *old = cache->hashtable;
+    size_t old_size = (size_t)1 << cache->size_exp;
+    cache->hashtable = hashtable;
+    cache->size_exp = size_exp;
+    for (size_t i = 0; i < old_size; i++) {
+        if (old[i].name == NULL) {
+            continue;
+        }
+        unsigned int h = MCACHE_HASH(cache, old[i].version,
+                                     ((PyASCIIObject *)old[i].name)->hash);
+        struct type_cache_entry *entry = &hashtable[h];
+        Py_XSETREF(entry->name, old[i].name);  /* steal the reference */
+        entry->version = old[i].version;
+        entry->value = old[i].value;
+    }
+    PyMem_Free(old);
+
+    cache->resizes++;
+    cache->resize_lookups = cache->hits + cache->misses + cache->collisions;
+    cache->resize_collisions = cache->collisions;
+}
+
+static void
+type_cache_maybe_grow(struct type_cache *cache)
+{
+    if (cache->size_exp >= MCACHE_MAX_SIZE_EXP) {
+        return;
+    }
+    size_t collisions = cache->collisions - cache->resize_collisions;
+    if (collisions <= ((size_t)1 << cache->size_exp)) {
+        return;
+    }
+    size_t lookups = (cache->hits + cache->misses + cache->collisions
+                      - cache->resize_lookups);
+    if (collisions * MCACHE_GROW_RATIO > lookups) {
+        type_cache_resize(cache, cache->size_exp + 1);
+    }
+}
 #endif
 
-    for (i = 0; i < (1 << MCACHE_SIZE_EXP); i++) {
-        method_cache[i].version = 0;
-        Py_CLEAR(method_cache[i].name);
-        method_cache[i].value = NULL;
+PyStatus
+_PyType_InitCache(PyThreadState *tstate)
+{
+    struct type_cache *cache = &tstate->interp->type_cache;
+#ifdef MCACHE
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    if (version_tag_lock == NULL) {
+        /* The main interpreter is initialized first */
+        assert(_Py_IsMainInterpreter(tstate));
+        version_tag_lock = PyThread_allocate_lock();
+        if (version_tag_lock == NULL) {
+            return _PyStatus_NO_MEMORY();
+        }
+    }
+#endif
+    cache->hashtable = PyMem_Calloc((size_t)1 << MCACHE_SIZE_EXP,
+                                    sizeof(struct type_cache_entry));
+    if (cache->hashtable == NULL) {
+        return _PyStatus_NO_MEMORY();
     }
+    cache->size_exp = MCACHE_SIZE_EXP;
+#else
+    cache->hashtable = NULL;
+    cache->size_exp = 0;
+#endif
+    return _PyStatus_OK();
+}
+
+/* Return a dict with the size and the statistics of the type method cache
+   of the current interpreter. */
+PyObject *
+_PyType_GetCacheInfo(void)
+{
+    struct type_cache *cache = get_type_cache();
+    size_t size = 0;
+    if (cache->hashtable != NULL) {
+        size = (size_t)1 << cache->size_exp;
+    }
+    return Py_BuildValue("{snsnsnsnsn}",
+                         "size", (Py_ssize_t)size,
+                         "hits", (Py_ssize_t)cache->hits,
+                         "misses", (Py_ssize_t)cache->misses,
+                         "collisions", (Py_ssize_t)cache->collisions,
+                         "resizes", (Py_ssize_t)cache->resizes);
+}
+
+unsigned int
+PyType_ClearCache(void)
+{
+#if defined(MCACHE) && defined(EXPERIMENTAL_ISOLATED_SUBINTERPRETERS)
+    /* Tags are never recycled: only drop the entries of this interpreter */
+    type_cache_clear(get_type_cache());
+    return next_version_tag - 1;
+#elif defined(MCACHE)
+    unsigned int cur_version_tag = next_version_tag - 1;
+
+    type_cache_clear_all();
     next_version_tag = 0;
     /* mark all version tags as invalid */
     PyType_Modified(&PyBaseObject_Type);
@@ -254,10 +379,37 @@ PyType_ClearCache(void)
 }
 
 void
-_PyType_Fini(void)
+_PyType_Fini(PyThreadState *tstate)
 {
-    PyType_ClearCache();
-    clear_slotdefs();
+    struct type_cache *cache = &tstate->interp->type_cache;
+
+#if MCACHE_STATS
+    size_t total = cache->hits + cache->collisions + cache->misses;
+    fprintf(stderr, "-- Method cache hits        = %zd (%d%%)\n",
+            cache->hits, (int) (100.0 * cache->hits / total));
+    fprintf(stderr, "-- Method cache true misses = %zd (%d%%)\n",
+            cache->misses, (int) (100.0 * cache->misses / total));
+    fprintf(stderr, "-- Method cache collisions  = %zd (%d%%)\n",
+            cache->collisions, (int) (100.0 * cache->collisions / total));
+    fprintf(stderr, "-- Method cache resizes     = %zd\n",
+            cache->resizes);
+    fprintf(stderr, "-- Method cache size        = %zd KiB\n",
+            (sizeof(struct type_cache_entry) << cache->size_exp) / 1024);
+#endif
+
+    type_cache_clear(cache);
+    PyMem_Free(cache->hashtable);
+    cache->hashtable = NULL;
+    cache->size_exp = 0;
+    if (_Py_IsMainInterpreter(tstate)) {
+        clear_slotdefs();
+#if defined(MCACHE) && defined(EXPERIMENTAL_ISOLATED_SUBINTERPRETERS)
+        if (version_tag_lock != NULL) {
+            PyThread_free_lock(version_tag_lock);
+            version_tag_lock = NULL;
+        }
+#endif
+    }
 }
 
 void
@@ -380,23 +532,31 @@ assign_version_tag(PyTypeObject *type)
     if (!_PyType_HasFeature(type, Py_TPFLAGS_READY))
         return 0;
 
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    /* Once the tags are exhausted, new types are not cached anymore */
+    PyThread_acquire_lock(version_tag_lock, WAIT_LOCK);
+    unsigned int tag = next_version_tag;
+    if (tag != 0) {
+        next_version_tag++;
+    }
+    PyThread_release_lock(version_tag_lock);
+    if (tag == 0) {
+        return 0;
+    }
+    type->tp_version_tag = tag;
+#else
     type->tp_version_tag = next_version_tag++;
     /* for stress-testing: next_version_tag &= 0xFF; */
 
     if (type->tp_version_tag == 0) {
         /* wrap-around or just starting Python - clear the whole
-           cache by filling names with references to Py_None.
-           Values are also set to NULL for added protection, as they
-           are borrowed reference */
-        for (i = 0; i < (1 << MCACHE_SIZE_EXP); i++) {
-            method_cache[i].value = NULL;
-            Py_INCREF(Py_None);
-            Py_XSETREF(method_cache[i].name, Py_None);
-        }
+           cache of every interpreter. */
+        type_cache_clear_all();
         /* mark all version tags as invalid */
         PyType_Modified(&PyBaseObject_Type);
         return 1;
     }
+#endif
     bases = type->tp_bases;
     n = PyTuple_GET_SIZE(bases);
     for (i = 0; i < n; i++) {
@@ -3223,16 +3383,17 @@ _PyType_Lookup(PyTypeObject *type, PyObject *name)
     int error;
 
 #ifdef MCACHE
+    struct type_cache *cache = get_type_cache();
     if (MCACHE_CACHEABLE_NAME(name) &&
-        _PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
+        _PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG) &&
+        cache->hashtable != NULL) {
         /* fast path */
-        unsigned int h = MCACHE_HASH_METHOD(type, name);
-        if (method_cache[h].version == type->tp_version_tag &&
-            method_cache[h].name == name) {
-#if MCACHE_STATS
-            method_cache_hits++;
-#endif
-            return method_cache[h].value;
+        struct type_cache_entry *entry =
+            &cache->hashtable[MCACHE_HASH_METHOD(cache, type, name)];
+        if (entry->version == type->tp_version_tag &&
+            entry->name == name) {
+            cache->hits++;
+            return entry->value;
         }
     }
 #endif
@@ -3258,19 +3419,22 @@ _PyType_Lookup(PyTypeObject *type, PyObject *name)
     }
 
 #ifdef MCACHE
-    if (MCACHE_CACHEABLE_NAME(name) && assign_version_tag(type)) {
-        unsigned int h = MCACHE_HASH_METHOD(type, name);
-        method_cache[h].version = type->tp_version_tag;
-        method_cache[h].value = res;  /* borrowed */
+    if (MCACHE_CACHEABLE_NAME(name) && assign_version_tag(type) &&
+        cache->hashtable != NULL) {
+        struct type_cache_entry *entry =
+            &cache->hashtable[MCACHE_HASH_METHOD(cache, type, name)];
+        entry->version = type->tp_version_tag;
+        entry->value = res;  /* borrowed */
         Py_INCREF(name);
         assert(((PyASCIIObject *)(name))->hash != -1);
-#if MCACHE_STATS
-        if (method_cache[h].name != Py_None && method_cache[h].name != name)
-            method_cache_collisions++;
-        else
-            method_cache_misses++;
-#endif
-        Py_SETREF(method_cache[h].name, name);
+        if (entry->name != NULL && entry->name != name) {
+            cache->collisions++;
+        }
+        else {
+            cache->misses++;
+        }
+        Py_XSETREF(entry->name, name);
+        type_cache_maybe_grow(cache);
     }
 #endif
     return res;
@@ -8050,14 +8214,14 @@ super_init_without_args(PyFrameObject *f, PyCodeObject *co,
         return -1;
     }
 
-    PyObject *obj = f->f_localsplus[0];
+    PyObject *obj = f->f_localsptr[0];
     Py_ssize_t i, n;
     if (obj == NULL && co->co_cell2arg) {
         /* The first argument might be a cell. */
         n = PyTuple_GET_SIZE(co->co_cellvars);
         for (i = 0; i < n; i++) {
             if (co->co_cell2arg[i] == 0) {
-                PyObject *cell = f->f_localsplus[co->co_nlocals + i];
+                PyObject *cell = f->f_localsptr[co->co_nlocals + i];
                 assert(PyCell_Check(cell));
                 obj = PyCell_GET(cell);
                 break;
@@ -8085,7 +8249,7 @@ super_init_without_args(PyFrameObject *f, PyCodeObject *co,
         if (_PyUnicode_EqualToASCIIId(name, &PyId___class__)) {
             Py_ssize_t index = co->co_nlocals +
                 PyTuple_GET_SIZE(co->co_cellvars) + i;
-            PyObject *cell = f->f_localsplus[index];
+            PyObject *cell = f->f_localsptr[index];
             if (cell == NULL || !PyCell_Check(cell)) {
                 PyErr_SetString(PyExc_RuntimeError,
                   "super(): bad __class__ cell");
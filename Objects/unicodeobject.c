@@ -209,13 +209,9 @@ extern "C" {
 #  define INTERNED_STRINGS
 #endif
 
-/* This dictionary holds all interned unicode strings.  Note that references
-   to strings in this dictionary are *not* counted in the string's ob_refcnt.
-   When the interned string reaches a refcnt of 0 the string deallocation
-   function will delete the reference from this dictionary.
-
-   Another way to look at this is that to say that the actual reference
-   count of a string is:  s->ob_refcnt + (s->state ? 2 : 0)
+/* This dictionary holds all interned unicode strings.  Interned strings
+   are immortal (see _Py_SetImmortal()): they are never deallocated and
+   stay in this dictionary until the interpreter exits.
 */
 #ifdef INTERNED_STRINGS
 static PyObject *interned = NULL;
@@ -15705,10 +15701,14 @@ PyUnicode_InternInPlace(PyObject **p)
         return;
     }
 
-    /* The two references in interned are not counted by refcnt.
-       The deallocator will take care of this */
-    Py_SET_REFCNT(s, Py_REFCNT(s) - 2);
-    _PyUnicode_STATE(s).interned = SSTATE_INTERNED_MORTAL;
+    /* Interned strings are immortal: they are used as identifiers all over
+       the place, their reference count is not updated anymore. */
+    _Py_SetImmortal(s);
+    _PyUnicode_STATE(s).interned = SSTATE_INTERNED_IMMORTAL;
+#else
+    /* Strings are not shared, but callers still expect the hash of an
+       interned string (like an identifier) to be initialized */
+    (void)PyObject_Hash(s);
 #endif
 }
 
@@ -15732,6 +15732,17 @@ PyUnicode_InternFromString(const char *cp)
     return s;
 }
 
+Py_ssize_t
+_PyUnicode_InternedSize(void)
+{
+#ifdef INTERNED_STRINGS
+    if (interned != NULL) {
+        return PyDict_GET_SIZE(interned);
+    }
+#endif
+    return 0;
+}
+
 
 #if defined(WITH_VALGRIND) || defined(__INSURE__)
 static void
@@ -29,6 +29,7 @@
 #include "opcode.h"
 #include "pydtrace.h"
 #include "setobject.h"
+#include "structmember.h"         // struct PyMemberDef, T_OBJECT_EX
 
 #include <ctype.h>
 
@@ -48,6 +49,11 @@ _Py_IDENTIFIER(__name__);
 Py_LOCAL_INLINE(PyObject *) call_function(
     PyThreadState *tstate, PyObject ***pp_stack,
     Py_ssize_t oparg, PyObject *kwnames);
+Py_LOCAL_INLINE(int) can_inline_call(
+    PyThreadState *tstate, PyObject *func, Py_ssize_t nargs);
+static PyFrameObject * inline_call_frame(
+    PyThreadState *tstate, PyObject *func,
+    PyObject **args, Py_ssize_t nargs);
 static PyObject * do_call_core(
     PyThreadState *tstate, PyObject *func,
     PyObject *callargs, PyObject *kwdict);
@@ -83,6 +89,10 @@ static PyObject * special_lookup(PyThreadState *, PyObject *, _Py_Identifier *);
 static int check_args_iterable(PyThreadState *, PyObject *func, PyObject *vararg);
 static void format_kwargs_error(PyThreadState *, PyObject *func, PyObject *kwargs);
 static void format_awaitable_error(PyThreadState *, PyTypeObject *, int, int);
+static int opcache_attr_fill(_PyOpcache_Attr *, PyObject *, PyObject *);
+static int binary_add_kind(PyObject *, PyObject *);
+static int binary_subscr_kind(PyObject *, PyObject *);
+static Py_ssize_t subscr_fast_index(PyThreadState *, PyObject *, Py_ssize_t);
 
 #define NAME_ERROR_MSG \
     "name '%.200s' is not defined"
@@ -111,7 +121,20 @@ static long dxp[256];
 #else
 #define OPCACHE_MIN_RUNS 1024  /* create opcache when code executed this time */
 #endif
+#ifdef Py_OPCODE_STATS
+#define OPCACHE_STATS 1  /* Part of the --with-opcode-stats statistics */
+#else
 #define OPCACHE_STATS 0  /* Enable stats */
+#endif
+
+/* Number of cache misses tolerated by a LOAD_ATTR, STORE_ATTR or
+   LOAD_METHOD instruction before it is deoptimized for good. */
+#define OPCACHE_ATTR_MAX_TRIES 20
+
+/* Number of operand type mismatches tolerated by a specialized BINARY_ADD
+   or BINARY_SUBSCR instruction before it falls back to the generic path
+   for good. */
+#define OPCACHE_BINARY_MAX_TRIES 20
 
 #if OPCACHE_STATS
 static size_t opcache_code_objects = 0;
@@ -120,6 +143,21 @@ static size_t opcache_code_objects_extra_mem = 0;
 static size_t opcache_global_opts = 0;
 static size_t opcache_global_hits = 0;
 static size_t opcache_global_misses = 0;
+
+static size_t opcache_attr_opts = 0;
+static size_t opcache_attr_hits = 0;
+static size_t opcache_attr_misses = 0;
+static size_t opcache_attr_deopts = 0;
+
+static size_t opcache_method_opts = 0;
+static size_t opcache_method_hits = 0;
+static size_t opcache_method_misses = 0;
+static size_t opcache_method_deopts = 0;
+
+static size_t opcache_binary_opts = 0;
+static size_t opcache_binary_hits = 0;
+static size_t opcache_binary_misses = 0;
+static size_t opcache_binary_deopts = 0;
 #endif
 
 
@@ -300,7 +338,7 @@ _PyEval_InitGIL(PyThreadState *tstate)
     PyThread_init_thread();
     create_gil(gil);
 
-    take_gil(tstate);
+    take_gil(tstate, 1);
 
     assert(gil_created(gil));
     return _PyStatus_OK();
@@ -339,10 +377,174 @@ PyEval_InitThreads(void)
     /* Do nothing: kept for backward compatibility */
 }
 
+#ifdef Py_OPCODE_STATS
+/* --with-opcode-stats: statistics on the execution of opcodes.
+
+   Besides the opcode and opcode pair counts of sys.getdxp() and the opcode
+   cache counters, every code object records its own counts in a
+   _PyCodeStats.  At exit, all of them are appended as a single line of
+   JSON to the file named by the PYTHONOPCODESTATS environment variable. */
+
+static _PyCodeStats *code_stats_head = NULL;
+
+static char *
+code_stats_strdup(PyObject *str)
+{
+    PyObject *bytes = _PyUnicode_AsUTF8String(str, "backslashreplace");
+    if (bytes == NULL) {
+        return NULL;
+    }
+    char *copy = _PyMem_RawStrdup(PyBytes_AS_STRING(bytes));
+    Py_DECREF(bytes);
+    if (copy == NULL) {
+        PyErr_NoMemory();
+    }
+    return copy;
+}
+
+static int
+code_stats_init(PyCodeObject *co)
+{
+    _PyCodeStats *stats = PyMem_RawCalloc(1, sizeof(_PyCodeStats));
+    if (stats == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+    stats->filename = code_stats_strdup(co->co_filename);
+    stats->name = code_stats_strdup(co->co_name);
+    if (stats->filename == NULL || stats->name == NULL) {
+        PyMem_RawFree(stats->filename);
+        PyMem_RawFree(stats->name);
+        PyMem_RawFree(stats);
+        return -1;
+    }
+    stats->firstlineno = co->co_firstlineno;
+    stats->next = code_stats_head;
+    code_stats_head = stats;
+    co->co_stats = stats;
+    return 0;
+}
+
+static void
+opcode_stats_write_string(FILE *out, const char *str)
+{
+    fputc('"', out);
+    for (; *str != '\0'; str++) {
+        unsigned char ch = (unsigned char)*str;
+        if (ch == '"' || ch == '\\') {
+            fprintf(out, "\\%c", ch);
+        }
+        else if (ch < 0x20) {
+            fprintf(out, "\\u%04x", ch);
+        }
+        else {
+            fputc(ch, out);
+        }
+    }
+    fputc('"', out);
+}
+
+static void
+opcode_stats_write_opcache(FILE *out, const char *name, size_t hits,
+                           size_t misses, size_t opts, size_t deopts)
+{
+    opcode_stats_write_string(out, name);
+    fprintf(out, ": {\"hits\": %zu, \"misses\": %zu, "
+                 "\"opts\": %zu, \"deopts\": %zu}",
+            hits, misses, opts, deopts);
+}
+
+/* Append the statistics as a line of JSON to the PYTHONOPCODESTATS file:
+
+   {"version": str,
+    "opcodes": [count of opcode 0, ..., count of opcode 255],
+    "pairs": [[first opcode, second opcode, count], ...],
+    "opcache": {instruction: {"hits", "misses", "opts", "deopts"}, ...},
+    "code": [{"filename", "name", "firstlineno", "entries", "instructions",
+              "opcache_hits", "opcache_misses", "opcache_opts",
+              "opcache_deopts"}, ...]}
+
+   Opcode counts only cover what happened since the last sys.getdxp() call,
+   which resets them. */
+static void
+opcode_stats_dump(void)
+{
+    PyInterpreterState *interp = _PyInterpreterState_GET();
+    const char *filename = _Py_GetEnv(interp->config.use_environment,
+                                      "PYTHONOPCODESTATS");
+    if (filename == NULL) {
+        return;
+    }
+    FILE *out = fopen(filename, "a");
+    if (out == NULL) {
+        fprintf(stderr, "Cannot write opcode statistics to %s: %s\n",
+                filename, strerror(errno));
+        return;
+    }
+
+    fprintf(out, "{\"version\": \"%s\", \"opcodes\": [", PY_VERSION);
+    for (int op = 0; op < 256; op++) {
+        fprintf(out, "%s%ld", op ? ", " : "", dxp[op]);
+    }
+
+    fputs("], \"pairs\": [", out);
+    int first = 1;
+    for (int op1 = 0; op1 < 256; op1++) {
+        for (int op2 = 0; op2 < 256; op2++) {
+            if (dxpairs[op1][op2] != 0) {
+                fprintf(out, "%s[%d, %d, %ld]", first ? "" : ", ",
+                        op1, op2, dxpairs[op1][op2]);
+                first = 0;
+            }
+        }
+    }
+
+    fputs("], \"opcache\": {", out);
+    opcode_stats_write_opcache(out, "LOAD_GLOBAL", opcache_global_hits,
+                               opcache_global_misses, opcache_global_opts, 0);
+    fputs(", ", out);
+    opcode_stats_write_opcache(out, "LOAD_ATTR/STORE_ATTR",
+                               opcache_attr_hits, opcache_attr_misses,
+                               opcache_attr_opts, opcache_attr_deopts);
+    fputs(", ", out);
+    opcode_stats_write_opcache(out, "LOAD_METHOD", opcache_method_hits,
+                               opcache_method_misses, opcache_method_opts,
+                               opcache_method_deopts);
+    fputs(", ", out);
+    opcode_stats_write_opcache(out, "BINARY_ADD/BINARY_SUBSCR",
+                               opcache_binary_hits, opcache_binary_misses,
+                               opcache_binary_opts, opcache_binary_deopts);
+
+    fputs("}, \"code\": [", out);
+    for (_PyCodeStats *stats = code_stats_head; stats != NULL;
+         stats = stats->next)
+    {
+        fputs("{\"filename\": ", out);
+        opcode_stats_write_string(out, stats->filename);
+        fputs(", \"name\": ", out);
+        opcode_stats_write_string(out, stats->name);
+        fprintf(out, ", \"firstlineno\": %d, \"entries\": %zu, "
+                     "\"instructions\": %zu, \"opcache_hits\": %zu, "
+                     "\"opcache_misses\": %zu, \"opcache_opts\": %zu, "
+                     "\"opcache_deopts\": %zu}%s",
+                stats->firstlineno, stats->entries, stats->instructions,
+                stats->opcache_hits, stats->opcache_misses,
+                stats->opcache_opts, stats->opcache_deopts,
+                stats->next != NULL ? ", " : "");
+    }
+    fputs("]}\n", out);
+    fclose(out);
+}
+#endif  /* Py_OPCODE_STATS */
+
 void
 _PyEval_Fini(void)
 {
-#if OPCACHE_STATS
+#ifdef Py_OPCODE_STATS
+    /* The statistics of the code objects are not freed: code objects which
+       are still alive keep updating them */
+    opcode_stats_dump();
+#elif OPCACHE_STATS
     fprintf(stderr, "-- Opcode cache number of objects  = %zd\n",
             opcache_code_objects);
 
@@ -365,6 +567,60 @@ _PyEval_Fini(void)
             opcache_global_opts);
 
     fprintf(stderr, "\n");
+
+    fprintf(stderr, "-- Opcode cache LOAD/STORE_ATTR hits   = %zd (%d%%)\n",
+            opcache_attr_hits,
+            (int) (100.0 * opcache_attr_hits /
+                (opcache_attr_hits + opcache_attr_misses)));
+
+    fprintf(stderr, "-- Opcode cache LOAD/STORE_ATTR misses = %zd (%d%%)\n",
+            opcache_attr_misses,
+            (int) (100.0 * opcache_attr_misses /
+                (opcache_attr_hits + opcache_attr_misses)));
+
+    fprintf(stderr, "-- Opcode cache LOAD/STORE_ATTR opts   = %zd\n",
+            opcache_attr_opts);
+
+    fprintf(stderr, "-- Opcode cache LOAD/STORE_ATTR deopts = %zd\n",
+            opcache_attr_deopts);
+
+    fprintf(stderr, "\n");
+
+    fprintf(stderr, "-- Opcode cache LOAD_METHOD hits   = %zd (%d%%)\n",
+            opcache_method_hits,
+            (int) (100.0 * opcache_method_hits /
+                (opcache_method_hits + opcache_method_misses)));
+
+    fprintf(stderr, "-- Opcode cache LOAD_METHOD misses = %zd (%d%%)\n",
+            opcache_method_misses,
+            (int) (100.0 * opcache_method_misses /
+                (opcache_method_hits + opcache_method_misses)));
+
+    fprintf(stderr, "-- Opcode cache LOAD_METHOD opts   = %zd\n",
+            opcache_method_opts);
+
+    fprintf(stderr, "-- Opcode cache LOAD_METHOD deopts = %zd\n",
+            opcache_method_deopts);
+
+    fprintf(stderr, "\n");
+
+    fprintf(stderr, "-- Opcode cache BINARY_ADD/SUBSCR hits   = %zd (%d%%)\n",
+            opcache_binary_hits,
+            (int) (100.0 * opcache_binary_hits /
+                (opcache_binary_hits + opcache_binary_misses)));
+
+    fprintf(stderr, "-- Opcode cache BINARY_ADD/SUBSCR misses = %zd (%d%%)\n",
+            opcache_binary_misses,
+            (int) (100.0 * opcache_binary_misses /
+                (opcache_binary_hits + opcache_binary_misses)));
+
+    fprintf(stderr, "-- Opcode cache BINARY_ADD/SUBSCR opts   = %zd\n",
+            opcache_binary_opts);
+
+    fprintf(stderr, "-- Opcode cache BINARY_ADD/SUBSCR deopts = %zd\n",
+            opcache_binary_deopts);
+
+    fprintf(stderr, "\n");
 #endif
 }
 
@@ -375,7 +631,7 @@ PyEval_AcquireLock(void)
     PyThreadState *tstate = _PyRuntimeState_GetThreadState(runtime);
     _Py_EnsureTstateNotNULL(tstate);
 
-    take_gil(tstate);
+    take_gil(tstate, 1);
 }
 
 void
@@ -404,7 +660,7 @@ PyEval_AcquireThread(PyThreadState *tstate)
 {
     _Py_EnsureTstateNotNULL(tstate);
 
-    take_gil(tstate);
+    take_gil(tstate, 1);
 
     struct _gilstate_runtime_state *gilstate = &tstate->interp->runtime->gilstate;
 #ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
@@ -450,7 +706,7 @@ _PyEval_ReInitThreads(PyThreadState *tstate)
     }
     recreate_gil(gil);
 
-    take_gil(tstate);
+    take_gil(tstate, 1);
 
     struct _pending_calls *pending = &tstate->interp->ceval.pending;
     if (_PyThread_at_fork_reinit(&pending->lock) < 0) {
@@ -501,7 +757,7 @@ PyEval_RestoreThread(PyThreadState *tstate)
 {
     _Py_EnsureTstateNotNULL(tstate);
 
-    take_gil(tstate);
+    take_gil(tstate, 1);
 
     struct _gilstate_runtime_state *gilstate = &tstate->interp->runtime->gilstate;
     _PyThreadState_Swap(gilstate, tstate);
@@ -914,7 +1170,7 @@ eval_frame_handle_pending(PyThreadState *tstate)
 
         /* Other threads may run now */
 
-        take_gil(tstate);
+        take_gil(tstate, 0);
 
 #ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
         (void)_PyThreadState_Swap(&runtime->gilstate, tstate);
@@ -952,6 +1208,10 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
     int oparg;         /* Current opcode argument, if any */
     PyObject **fastlocals, **freevars;
     PyObject *retval = NULL;            /* Return value */
+    /* The frame this C call evaluates; the frames of inlined calls (see
+       can_inline_call()) run on top of it in the same loop. */
+    PyFrameObject * const entry_frame = f;
+    PyFrameObject *new_frame;
     struct _ceval_state * const ceval2 = &tstate->interp->ceval;
     _Py_atomic_int * const eval_breaker = &ceval2->eval_breaker;
     PyCodeObject *co;
@@ -1141,6 +1401,28 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
 #endif
 #define PREDICTED(op)           PREDICT_ID(op):
 
+/* Superinstructions (see _superinstructions in Lib/opcode.py) run their
+   first instruction, then jump straight into the second one as a
+   successful PREDICT() does, skipping the eval breaker and tracing checks
+   in between.  They only do so when these checks cannot have any effect;
+   otherwise the second instruction is dispatched normally so that tracing
+   sees every instruction. */
+#ifdef LLTRACE
+#define SUPERINSTRUCTION_INLINE() \
+    (!lltrace && !_Py_TracingPossible(ceval2) && !PyDTrace_LINE_ENABLED())
+#else
+#define SUPERINSTRUCTION_INLINE() \
+    (!_Py_TracingPossible(ceval2) && !PyDTrace_LINE_ENABLED())
+#endif
+
+#define SUPERINSTRUCTION_NEXT(op) \
+    do { \
+        f->f_lasti = INSTR_OFFSET(); \
+        NEXTOPARG(); \
+        opcode = op; \
+        goto PREDICT_ID(op); \
+    } while (0)
+
 
 /* Stack manipulation macros */
 
@@ -1176,7 +1458,7 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
 #define STACK_SHRINK(n) do { \
                             assert(n >= 0); \
                             (void)(lltrace && prtrace(tstate, TOP(), "stackadj")); \
-                            (void)(BASIC_STACKADJ(-n)); \
+                            (void)(BASIC_STACKADJ(-(n))); \
                             assert(STACK_LEVEL() <= co->co_stacksize); \
                         } while (0)
 #define EXT_POP(STACK_POINTER) ((void)(lltrace && \
@@ -1186,7 +1468,7 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
 #define PUSH(v)                BASIC_PUSH(v)
 #define POP()                  BASIC_POP()
 #define STACK_GROW(n)          BASIC_STACKADJ(n)
-#define STACK_SHRINK(n)        BASIC_STACKADJ(-n)
+#define STACK_SHRINK(n)        BASIC_STACKADJ(-(n))
 #define EXT_POP(STACK_POINTER) (*--(STACK_POINTER))
 #endif
 
@@ -1247,21 +1529,181 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
         } \
     } while (0)
 
+    /* Disable the cache of the current instruction for good */
+#define OPCACHE_DEOPT() \
+    do { \
+        if (co_opcache != NULL) { \
+            co_opcache->optimized = -1; \
+            assert(co->co_opcache_map[next_instr - first_instr] > 0); \
+            co->co_opcache_map[next_instr - first_instr] = 0; \
+            co_opcache = NULL; \
+        } \
+    } while (0)
+
+    /* Count a cache miss, deoptimize after too many of them */
+#define OPCACHE_MAYBE_DEOPT_ATTR() \
+    do { \
+        if (co_opcache != NULL && --co_opcache->optimized <= 0) { \
+            OPCACHE_STAT_ATTR_DEOPT(); \
+            OPCACHE_DEOPT(); \
+        } \
+    } while (0)
+
+#define OPCACHE_DEOPT_ATTR() \
+    do { \
+        if (co_opcache != NULL) { \
+            OPCACHE_STAT_ATTR_DEOPT(); \
+            OPCACHE_DEOPT(); \
+        } \
+    } while (0)
+
+#define OPCACHE_MAYBE_DEOPT_METHOD() \
+    do { \
+        if (co_opcache != NULL && --co_opcache->optimized <= 0) { \
+            OPCACHE_STAT_METHOD_DEOPT(); \
+            OPCACHE_DEOPT(); \
+        } \
+    } while (0)
+
+#define OPCACHE_DEOPT_METHOD() \
+    do { \
+        if (co_opcache != NULL) { \
+            OPCACHE_STAT_METHOD_DEOPT(); \
+            OPCACHE_DEOPT(); \
+        } \
+    } while (0)
+
+#define OPCACHE_MAYBE_DEOPT_BINARY() \
+    do { \
+        if (co_opcache != NULL && --co_opcache->optimized <= 0) { \
+            OPCACHE_STAT_BINARY_DEOPT(); \
+            OPCACHE_DEOPT(); \
+        } \
+    } while (0)
+
+    /* Specialize a BINARY_ADD or BINARY_SUBSCR instruction for the operand
+       types it has just seen, or give up on it if they are not supported */
+#define OPCACHE_BINARY_FILL(k) \
+    do { \
+        if (co_opcache != NULL) { \
+            int kind_ = (k); \
+            if (kind_ != _PyOpcache_BINARY_GENERIC) { \
+                co_opcache->u.binop.kind = kind_; \
+                if (co_opcache->optimized == 0) { \
+                    OPCACHE_STAT_BINARY_OPT(); \
+                    co_opcache->optimized = OPCACHE_BINARY_MAX_TRIES; \
+                } \
+            } \
+            else if (co_opcache->optimized == 0) { \
+                OPCACHE_STAT_BINARY_DEOPT(); \
+                OPCACHE_DEOPT(); \
+            } \
+        } \
+    } while (0)
+
+    /* The type cached by LOAD_ATTR, STORE_ATTR or LOAD_METHOD is still
+       valid for tp */
+#define OPCACHE_TYPE_MATCHES(at, tp) \
+    ((at)->type == (tp) && \
+     _PyType_HasFeature((tp), Py_TPFLAGS_VALID_VERSION_TAG) && \
+     (at)->tp_version_tag == (tp)->tp_version_tag)
+
 #if OPCACHE_STATS
 
+#ifdef Py_OPCODE_STATS
+#define OPCACHE_STAT_CODE(field) (co->co_stats->field++)
+#else
+#define OPCACHE_STAT_CODE(field) ((void)0)
+#endif
+
 #define OPCACHE_STAT_GLOBAL_HIT() \
     do { \
         if (co->co_opcache != NULL) opcache_global_hits++; \
+        OPCACHE_STAT_CODE(opcache_hits); \
     } while (0)
 
 #define OPCACHE_STAT_GLOBAL_MISS() \
     do { \
         if (co->co_opcache != NULL) opcache_global_misses++; \
+        OPCACHE_STAT_CODE(opcache_misses); \
     } while (0)
 
 #define OPCACHE_STAT_GLOBAL_OPT() \
     do { \
         if (co->co_opcache != NULL) opcache_global_opts++; \
+        OPCACHE_STAT_CODE(opcache_opts); \
+    } while (0)
+
+#define OPCACHE_STAT_ATTR_HIT() \
+    do { \
+        if (co->co_opcache != NULL) opcache_attr_hits++; \
+        OPCACHE_STAT_CODE(opcache_hits); \
+    } while (0)
+
+#define OPCACHE_STAT_ATTR_MISS() \
+    do { \
+        if (co->co_opcache != NULL) opcache_attr_misses++; \
+        OPCACHE_STAT_CODE(opcache_misses); \
+    } while (0)
+
+#define OPCACHE_STAT_ATTR_OPT() \
+    do { \
+        if (co->co_opcache != NULL) opcache_attr_opts++; \
+        OPCACHE_STAT_CODE(opcache_opts); \
+    } while (0)
+
+#define OPCACHE_STAT_ATTR_DEOPT() \
+    do { \
+        if (co->co_opcache != NULL) opcache_attr_deopts++; \
+        OPCACHE_STAT_CODE(opcache_deopts); \
+    } while (0)
+
+#define OPCACHE_STAT_METHOD_HIT() \
+    do { \
+        if (co->co_opcache != NULL) opcache_method_hits++; \
+        OPCACHE_STAT_CODE(opcache_hits); \
+    } while (0)
+
+#define OPCACHE_STAT_METHOD_MISS() \
+    do { \
+        if (co->co_opcache != NULL) opcache_method_misses++; \
+        OPCACHE_STAT_CODE(opcache_misses); \
+    } while (0)
+
+#define OPCACHE_STAT_METHOD_OPT() \
+    do { \
+        if (co->co_opcache != NULL) opcache_method_opts++; \
+        OPCACHE_STAT_CODE(opcache_opts); \
+    } while (0)
+
+#define OPCACHE_STAT_METHOD_DEOPT() \
+    do { \
+        if (co->co_opcache != NULL) opcache_method_deopts++; \
+        OPCACHE_STAT_CODE(opcache_deopts); \
+    } while (0)
+
+#define OPCACHE_STAT_BINARY_HIT() \
+    do { \
+        if (co->co_opcache != NULL) opcache_binary_hits++; \
+        OPCACHE_STAT_CODE(opcache_hits); \
+    } while (0)
+
+#define OPCACHE_STAT_BINARY_MISS() \
+    do { \
+        if (co->co_opcache != NULL) opcache_binary_misses++; \
+        OPCACHE_STAT_CODE(opcache_misses); \
+    } while (0)
+
+#define OPCACHE_STAT_BINARY_OPT() \
+    do { \
+        if (co->co_opcache != NULL) opcache_binary_opts++; \
+        OPCACHE_STAT_CODE(opcache_opts); \
+    } while (0)
+
+#define OPCACHE_STAT_BINARY_DEOPT() \
+    do { \
+        if (co->co_opcache != NULL) opcache_binary_deopts++; \
+        OPCACHE_STAT_CODE(opcache_deopts); \
     } while (0)
 
 #else /* OPCACHE_STATS */
@@ -1269,14 +1711,30 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
 #define OPCACHE_STAT_GLOBAL_HIT()
 #define OPCACHE_STAT_GLOBAL_MISS()
 #define OPCACHE_STAT_GLOBAL_OPT()
+#define OPCACHE_STAT_ATTR_HIT()
+#define OPCACHE_STAT_ATTR_MISS()
+#define OPCACHE_STAT_ATTR_OPT()
+#define OPCACHE_STAT_ATTR_DEOPT()
+#define OPCACHE_STAT_METHOD_HIT()
+#define OPCACHE_STAT_METHOD_MISS()
+#define OPCACHE_STAT_METHOD_OPT()
+#define OPCACHE_STAT_METHOD_DEOPT()
+#define OPCACHE_STAT_BINARY_HIT()
+#define OPCACHE_STAT_BINARY_MISS()
+#define OPCACHE_STAT_BINARY_OPT()
+#define OPCACHE_STAT_BINARY_DEOPT()
 
 #endif
 
 /* Start of code */
 
+start_frame:
     /* push frame */
     if (_Py_EnterRecursiveCall(tstate, "")) {
-        return NULL;
+        if (f == entry_frame) {
+            return NULL;
+        }
+        goto pop_frame;
     }
 
     tstate->frame = f;
@@ -1321,8 +1779,8 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
     co = f->f_code;
     names = co->co_names;
     consts = co->co_consts;
-    fastlocals = f->f_localsplus;
-    freevars = f->f_localsplus + co->co_nlocals;
+    fastlocals = f->f_localsptr;
+    freevars = f->f_localsptr + co->co_nlocals;
     assert(PyBytes_Check(co->co_code));
     assert(PyBytes_GET_SIZE(co->co_code) <= INT_MAX);
     assert(PyBytes_GET_SIZE(co->co_code) % sizeof(_Py_CODEUNIT) == 0);
@@ -1360,6 +1818,13 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
             if (_PyCode_InitOpcache(co) < 0) {
                 goto exit_eval_frame;
             }
+#ifndef DYNAMIC_EXECUTION_PROFILE
+            /* Profiles count the instructions of co_code, which are the
+               input used to choose the superinstructions */
+            if (_PyCode_Quicken(co) < 0) {
+                goto exit_eval_frame;
+            }
+#endif
 #if OPCACHE_STATS
             opcache_code_objects_extra_mem +=
                 PyBytes_Size(co->co_code) / sizeof(_Py_CODEUNIT) +
@@ -1369,6 +1834,20 @@ _PyEval_EvalFrameDefault(PyThreadState *tstate, PyFrameObject *f, int throwflag)
         }
     }
 
+#ifdef Py_OPCODE_STATS
+    if (co->co_stats == NULL && code_stats_init(co) < 0) {
+        goto exit_eval_frame;
+    }
+    co->co_stats->entries++;
+#endif
+
+    if (co->co_quickened != NULL) {
+        /* The quickened code has the same layout as co_code, so f_lasti
+           is valid for both */
+        next_instr = co->co_quickened + (next_instr - first_instr);
+        first_instr = co->co_quickened;
+    }
+
 #ifdef LLTRACE
     lltrace = _PyDict_GetItemId(f->f_globals, &PyId___ltrace__) != NULL;
 #endif
@@ -1468,6 +1947,9 @@ main_loop:
 #endif
         dxp[opcode]++;
 #endif
+#ifdef Py_OPCODE_STATS
+        co->co_stats->instructions++;
+#endif
 
 #ifdef LLTRACE
         /* Instruction tracing */
@@ -1495,6 +1977,7 @@ main_loop:
         }
 
         case TARGET(LOAD_FAST): {
+            PREDICTED(LOAD_FAST);
             PyObject *value = GETLOCAL(oparg);
             if (value == NULL) {
                 format_exc_check_arg(tstate, PyExc_UnboundLocalError,
@@ -1507,6 +1990,38 @@ main_loop:
             FAST_DISPATCH();
         }
 
+        case TARGET(LOAD_FAST__LOAD_FAST): {
+            PyObject *value = GETLOCAL(oparg);
+            if (value == NULL) {
+                format_exc_check_arg(tstate, PyExc_UnboundLocalError,
+                                     UNBOUNDLOCAL_ERROR_MSG,
+                                     PyTuple_GetItem(co->co_varnames, oparg));
+                goto error;
+            }
+            Py_INCREF(value);
+            PUSH(value);
+            if (SUPERINSTRUCTION_INLINE()) {
+                SUPERINSTRUCTION_NEXT(LOAD_FAST);
+            }
+            FAST_DISPATCH();
+        }
+
+        case TARGET(LOAD_FAST__LOAD_ATTR): {
+            PyObject *value = GETLOCAL(oparg);
+            if (value == NULL) {
+                format_exc_check_arg(tstate, PyExc_UnboundLocalError,
+                                     UNBOUNDLOCAL_ERROR_MSG,
+                                     PyTuple_GetItem(co->co_varnames, oparg));
+                goto error;
+            }
+            Py_INCREF(value);
+            PUSH(value);
+            if (SUPERINSTRUCTION_INLINE()) {
+                SUPERINSTRUCTION_NEXT(LOAD_ATTR);
+            }
+            FAST_DISPATCH();
+        }
+
         case TARGET(LOAD_CONST): {
             PREDICTED(LOAD_CONST);
             PyObject *value = GETITEM(consts, oparg);
@@ -1522,6 +2037,15 @@ main_loop:
             FAST_DISPATCH();
         }
 
+        case TARGET(STORE_FAST__LOAD_FAST): {
+            PyObject *value = POP();
+            SETLOCAL(oparg, value);
+            if (SUPERINSTRUCTION_INLINE()) {
+                SUPERINSTRUCTION_NEXT(LOAD_FAST);
+            }
+            FAST_DISPATCH();
+        }
+
         case TARGET(POP_TOP): {
             PyObject *value = POP();
             Py_DECREF(value);
@@ -1708,12 +2232,48 @@ main_loop:
             PyObject *right = POP();
             PyObject *left = TOP();
             PyObject *sum;
-            /* NOTE(haypo): Please don't try to micro-optimize int+int on
-               CPython using bytecode, it is simply worthless.
-               See http://bugs.python.org/issue21955 and
-               http://bugs.python.org/issue10044 for the discussion. In short,
-               no patch shown any impact on a realistic benchmark, only a minor
-               speedup on microbenchmarks. */
+
+            /* Once the opcode cache is enabled, an instruction which keeps
+               adding two ints, two floats or two strs calls the slot of
+               the type directly instead of going through the generic
+               PyNumber_Add() dispatch (see bpo-21955 and bpo-10044 for
+               earlier attempts done without type feedback). */
+            OPCACHE_CHECK();
+            if (co_opcache != NULL && co_opcache->optimized > 0) {
+                switch (co_opcache->u.binop.kind) {
+                case _PyOpcache_BINARY_ADD_INT:
+                    if (PyLong_CheckExact(left) && PyLong_CheckExact(right)) {
+                        OPCACHE_STAT_BINARY_HIT();
+                        sum = PyLong_Type.tp_as_number->nb_add(left, right);
+                        Py_DECREF(left);
+                        goto binary_add_done;
+                    }
+                    break;
+                case _PyOpcache_BINARY_ADD_FLOAT:
+                    if (PyFloat_CheckExact(left) && PyFloat_CheckExact(right)) {
+                        OPCACHE_STAT_BINARY_HIT();
+                        sum = PyFloat_FromDouble(PyFloat_AS_DOUBLE(left) +
+                                                 PyFloat_AS_DOUBLE(right));
+                        Py_DECREF(left);
+                        goto binary_add_done;
+                    }
+                    break;
+                case _PyOpcache_BINARY_ADD_UNICODE:
+                    if (PyUnicode_CheckExact(left) &&
+                        PyUnicode_CheckExact(right))
+                    {
+                        OPCACHE_STAT_BINARY_HIT();
+                        sum = unicode_concatenate(tstate, left, right, f,
+                                                  next_instr);
+                        goto binary_add_done;
+                    }
+                    break;
+                }
+                OPCACHE_STAT_BINARY_MISS();
+                OPCACHE_MAYBE_DEOPT_BINARY();
+            }
+            OPCACHE_BINARY_FILL(binary_add_kind(left, right));
+
             if (PyUnicode_CheckExact(left) &&
                      PyUnicode_CheckExact(right)) {
                 sum = unicode_concatenate(tstate, left, right, f, next_instr);
@@ -1723,6 +2283,7 @@ main_loop:
                 sum = PyNumber_Add(left, right);
                 Py_DECREF(left);
             }
+        binary_add_done:
             Py_DECREF(right);
             SET_TOP(sum);
             if (sum == NULL)
@@ -1745,7 +2306,62 @@ main_loop:
         case TARGET(BINARY_SUBSCR): {
             PyObject *sub = POP();
             PyObject *container = TOP();
-            PyObject *res = PyObject_GetItem(container, sub);
+            PyObject *res;
+            Py_ssize_t i;
+
+            OPCACHE_CHECK();
+            if (co_opcache != NULL && co_opcache->optimized > 0) {
+                switch (co_opcache->u.binop.kind) {
+                case _PyOpcache_BINARY_SUBSCR_LIST_INT:
+                    if (PyList_CheckExact(container) && PyLong_CheckExact(sub)) {
+                        OPCACHE_STAT_BINARY_HIT();
+                        i = subscr_fast_index(tstate, sub,
+                                              PyList_GET_SIZE(container));
+                        if (i < 0) {
+                            /* Out of range: let list raise IndexError */
+                            goto binary_subscr_generic;
+                        }
+                        res = PyList_GET_ITEM(container, i);
+                        Py_INCREF(res);
+                        goto binary_subscr_done;
+                    }
+                    break;
+                case _PyOpcache_BINARY_SUBSCR_TUPLE_INT:
+                    if (PyTuple_CheckExact(container) && PyLong_CheckExact(sub)) {
+                        OPCACHE_STAT_BINARY_HIT();
+                        i = subscr_fast_index(tstate, sub,
+                                              PyTuple_GET_SIZE(container));
+                        if (i < 0) {
+                            goto binary_subscr_generic;
+                        }
+                        res = PyTuple_GET_ITEM(container, i);
+                        Py_INCREF(res);
+                        goto binary_subscr_done;
+                    }
+                    break;
+                case _PyOpcache_BINARY_SUBSCR_DICT:
+                    if (PyDict_CheckExact(container)) {
+                        OPCACHE_STAT_BINARY_HIT();
+                        /* An exact dict has no __missing__() */
+                        res = PyDict_GetItemWithError(container, sub);
+                        if (res != NULL) {
+                            Py_INCREF(res);
+                        }
+                        else if (!_PyErr_Occurred(tstate)) {
+                            _PyErr_SetKeyError(sub);
+                        }
+                        goto binary_subscr_done;
+                    }
+                    break;
+                }
+                OPCACHE_STAT_BINARY_MISS();
+                OPCACHE_MAYBE_DEOPT_BINARY();
+            }
+            OPCACHE_BINARY_FILL(binary_subscr_kind(container, sub));
+
+        binary_subscr_generic:
+            res = PyObject_GetItem(container, sub);
+        binary_subscr_done:
             Py_DECREF(container);
             Py_DECREF(sub);
             SET_TOP(res);
@@ -2453,7 +3069,62 @@ main_loop:
             PyObject *name = GETITEM(names, oparg);
             PyObject *owner = TOP();
             PyObject *v = SECOND();
+            PyTypeObject *type = Py_TYPE(owner);
             int err;
+
+            OPCACHE_CHECK();
+            if (co_opcache != NULL && co_opcache->optimized > 0) {
+                _PyOpcache_Attr *at = &co_opcache->u.attr;
+                if (OPCACHE_TYPE_MATCHES(at, type)) {
+                    if (at->hint < -1) {
+                        /* Slot of the instance */
+                        PyObject **addr = (PyObject **)((char *)owner +
+                                                        ~at->hint);
+                        PyObject *old = *addr;
+                        OPCACHE_STAT_ATTR_HIT();
+                        STACK_SHRINK(2);
+                        *addr = v;  /* steal the reference */
+                        Py_XDECREF(old);
+                        Py_DECREF(owner);
+                        DISPATCH();
+                    }
+                    PyObject *dict = *(PyObject **)((char *)owner +
+                                                    type->tp_dictoffset);
+                    if (dict != NULL && PyDict_CheckExact(dict) &&
+                        _PyDict_SetItemHint((PyDictObject *)dict, name,
+                                            at->hint, v))
+                    {
+                        OPCACHE_STAT_ATTR_HIT();
+                        STACK_SHRINK(2);
+                        Py_DECREF(v);
+                        Py_DECREF(owner);
+                        DISPATCH();
+                    }
+                }
+                OPCACHE_STAT_ATTR_MISS();
+                OPCACHE_MAYBE_DEOPT_ATTR();
+            }
+
+            if (co_opcache != NULL) {
+                int filled = 0;
+                if (type->tp_setattro == PyObject_GenericSetAttr) {
+                    filled = opcache_attr_fill(&co_opcache->u.attr,
+                                               owner, name);
+                    if (filled < 0) {
+                        goto error;
+                    }
+                }
+                if (filled) {
+                    if (co_opcache->optimized == 0) {
+                        OPCACHE_STAT_ATTR_OPT();
+                        co_opcache->optimized = OPCACHE_ATTR_MAX_TRIES;
+                    }
+                }
+                else if (co_opcache->optimized == 0) {
+                    OPCACHE_DEOPT_ATTR();
+                }
+            }
+
             STACK_SHRINK(2);
             err = PyObject_SetAttr(owner, name, v);
             Py_DECREF(v);
@@ -3012,9 +3683,85 @@ main_loop:
         }
 
         case TARGET(LOAD_ATTR): {
+            PREDICTED(LOAD_ATTR);
             PyObject *name = GETITEM(names, oparg);
             PyObject *owner = TOP();
-            PyObject *res = PyObject_GetAttr(owner, name);
+            PyTypeObject *type = Py_TYPE(owner);
+            PyObject *res;
+
+            OPCACHE_CHECK();
+            if (co_opcache != NULL && co_opcache->optimized > 0) {
+                _PyOpcache_Attr *at = &co_opcache->u.attr;
+                if (OPCACHE_TYPE_MATCHES(at, type)) {
+                    if (at->hint < -1) {
+                        /* Slot of the instance */
+                        res = *(PyObject **)((char *)owner + ~at->hint);
+                        if (res != NULL) {
+                            OPCACHE_STAT_ATTR_HIT();
+                            Py_INCREF(res);
+                            SET_TOP(res);
+                            Py_DECREF(owner);
+                            DISPATCH();
+                        }
+                        /* The slot is empty: let the slow path raise
+                           AttributeError, the cache stays valid. */
+                        goto load_attr_slow;
+                    }
+                    PyObject *dict = *(PyObject **)((char *)owner +
+                                                    type->tp_dictoffset);
+                    if (dict != NULL && PyDict_CheckExact(dict)) {
+                        Py_ssize_t hint;
+                        Py_INCREF(dict);
+                        hint = _PyDict_GetItemHint((PyDictObject *)dict, name,
+                                                   at->hint, &res);
+                        if (res != NULL) {
+                            if (hint == at->hint) {
+                                OPCACHE_STAT_ATTR_HIT();
+                            }
+                            else {
+                                /* The attribute moved in the dict */
+                                OPCACHE_STAT_ATTR_MISS();
+                                at->hint = hint;
+                                OPCACHE_MAYBE_DEOPT_ATTR();
+                            }
+                            Py_INCREF(res);
+                            SET_TOP(res);
+                            Py_DECREF(owner);
+                            Py_DECREF(dict);
+                            DISPATCH();
+                        }
+                        Py_DECREF(dict);
+                        if (hint < 0 && _PyErr_Occurred(tstate)) {
+                            goto error;
+                        }
+                    }
+                }
+                OPCACHE_STAT_ATTR_MISS();
+                OPCACHE_MAYBE_DEOPT_ATTR();
+            }
+
+            if (co_opcache != NULL) {
+                int filled = 0;
+                if (type->tp_getattro == PyObject_GenericGetAttr) {
+                    filled = opcache_attr_fill(&co_opcache->u.attr,
+                                               owner, name);
+                    if (filled < 0) {
+                        goto error;
+                    }
+                }
+                if (filled) {
+                    if (co_opcache->optimized == 0) {
+                        OPCACHE_STAT_ATTR_OPT();
+                        co_opcache->optimized = OPCACHE_ATTR_MAX_TRIES;
+                    }
+                }
+                else if (co_opcache->optimized == 0) {
+                    OPCACHE_DEOPT_ATTR();
+                }
+            }
+
+          load_attr_slow:
+            res = PyObject_GetAttr(owner, name);
             Py_DECREF(owner);
             SET_TOP(res);
             if (res == NULL)
@@ -3037,6 +3784,22 @@ main_loop:
             DISPATCH();
         }
 
+        case TARGET(COMPARE_OP__POP_JUMP_IF_FALSE): {
+            assert(oparg <= Py_GE);
+            PyObject *right = POP();
+            PyObject *left = TOP();
+            PyObject *res = PyObject_RichCompare(left, right, oparg);
+            SET_TOP(res);
+            Py_DECREF(left);
+            Py_DECREF(right);
+            if (res == NULL)
+                goto error;
+            if (SUPERINSTRUCTION_INLINE()) {
+                SUPERINSTRUCTION_NEXT(POP_JUMP_IF_FALSE);
+            }
+            DISPATCH();
+        }
+
         case TARGET(IS_OP): {
             PyObject *right = POP();
             PyObject *left = TOP();
@@ -3452,8 +4215,45 @@ main_loop:
             /* Designed to work in tandem with CALL_METHOD. */
             PyObject *name = GETITEM(names, oparg);
             PyObject *obj = TOP();
+            PyTypeObject *type = Py_TYPE(obj);
             PyObject *meth = NULL;
 
+            OPCACHE_CHECK();
+            if (co_opcache != NULL && co_opcache->optimized > 0) {
+                _PyOpcache_LoadMethod *lm = &co_opcache->u.lm;
+                if (OPCACHE_TYPE_MATCHES(lm, type)) {
+                    /* The type still has the method, but it may be
+                       shadowed by an attribute of the instance. */
+                    PyObject *dict = NULL;
+                    if (type->tp_dictoffset != 0) {
+                        dict = *_PyObject_GetDictPtr(obj);
+                    }
+                    if (dict != NULL && PyDict_CheckExact(dict)) {
+                        PyObject *attr;
+                        Py_INCREF(dict);
+                        (void)_PyDict_GetItemHint((PyDictObject *)dict, name,
+                                                  -1, &attr);
+                        Py_DECREF(dict);
+                        if (attr == NULL) {
+                            if (_PyErr_Occurred(tstate)) {
+                                goto error;
+                            }
+                            dict = NULL;
+                        }
+                    }
+                    if (dict == NULL) {
+                        OPCACHE_STAT_METHOD_HIT();
+                        meth = lm->descr;
+                        Py_INCREF(meth);
+                        SET_TOP(meth);
+                        PUSH(obj);  // self
+                        DISPATCH();
+                    }
+                }
+                OPCACHE_STAT_METHOD_MISS();
+                OPCACHE_MAYBE_DEOPT_METHOD();
+            }
+
             int meth_found = _PyObject_GetMethod(obj, name, &meth);
 
             if (meth == NULL) {
@@ -3461,6 +4261,26 @@ main_loop:
                 goto error;
             }
 
+            if (co_opcache != NULL) {
+                if (meth_found &&
+                    type->tp_getattro == PyObject_GenericGetAttr &&
+                    _PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG))
+                {
+                    /* meth was found by _PyType_Lookup() on type */
+                    _PyOpcache_LoadMethod *lm = &co_opcache->u.lm;
+                    if (co_opcache->optimized == 0) {
+                        OPCACHE_STAT_METHOD_OPT();
+                        co_opcache->optimized = OPCACHE_ATTR_MAX_TRIES;
+                    }
+                    lm->type = type;
+                    lm->tp_version_tag = type->tp_version_tag;
+                    lm->descr = meth;
+                }
+                else if (co_opcache->optimized == 0) {
+                    OPCACHE_DEOPT_METHOD();
+                }
+            }
+
             if (meth_found) {
                 /* We can bypass temporary bound method object.
                    meth is unbound method and obj is self.
@@ -3493,6 +4313,18 @@ main_loop:
 
             meth = PEEK(oparg + 2);
             if (meth == NULL) {
+                PyObject *func = PEEK(oparg + 1);
+                if (can_inline_call(tstate, func, oparg)) {
+                    new_frame = inline_call_frame(tstate, func,
+                                                  stack_pointer - oparg, oparg);
+                    if (new_frame == NULL) {
+                        goto error;
+                    }
+                    STACK_SHRINK(oparg);
+                    Py_DECREF(POP());
+                    (void)POP(); /* POP the NULL. */
+                    goto inline_call;
+                }
                 /* `meth` is NULL when LOAD_METHOD thinks that it's not
                    a method call.
 
@@ -3524,6 +4356,17 @@ main_loop:
                   We'll be passing `oparg + 1` to call_function, to
                   make it accept the `self` as a first argument.
                 */
+                if (can_inline_call(tstate, meth, oparg + 1)) {
+                    new_frame = inline_call_frame(tstate, meth,
+                                                  stack_pointer - oparg - 1,
+                                                  oparg + 1);
+                    if (new_frame == NULL) {
+                        goto error;
+                    }
+                    STACK_SHRINK(oparg + 1);
+                    Py_DECREF(POP());
+                    goto inline_call;
+                }
                 res = call_function(tstate, &sp, oparg + 1, NULL);
                 stack_pointer = sp;
             }
@@ -3537,6 +4380,17 @@ main_loop:
         case TARGET(CALL_FUNCTION): {
             PREDICTED(CALL_FUNCTION);
             PyObject **sp, *res;
+            PyObject *func = PEEK(oparg + 1);
+            if (can_inline_call(tstate, func, oparg)) {
+                new_frame = inline_call_frame(tstate, func,
+                                              stack_pointer - oparg, oparg);
+                if (new_frame == NULL) {
+                    goto error;
+                }
+                STACK_SHRINK(oparg);
+                Py_DECREF(POP());
+                goto inline_call;
+            }
             sp = stack_pointer;
             res = call_function(tstate, &sp, oparg, NULL);
             stack_pointer = sp;
@@ -3748,6 +4602,23 @@ main_loop:
            or goto error. */
         Py_UNREACHABLE();
 
+inline_call:
+        /* Suspend the caller and start evaluating new_frame, whose
+           arguments have been popped from the caller's stack.  f_lasti
+           points to the call (not to a preceding EXTENDED_ARG), so that
+           the caller resumes right after it. */
+        f->f_lasti = INSTR_OFFSET() - (int)sizeof(_Py_CODEUNIT);
+        f->f_stacktop = stack_pointer;
+        f->f_instr_lb = instr_lb;
+        f->f_instr_ub = instr_ub;
+        f->f_instr_prev = instr_prev;
+        instr_ub = -1;
+        instr_lb = 0;
+        instr_prev = -1;
+        f = new_frame;
+        throwflag = 0;
+        goto start_frame;
+
 error:
         /* Double-check exception status. */
 #ifdef NDEBUG
@@ -3863,9 +4734,45 @@ exit_eval_frame:
     if (PyDTrace_FUNCTION_RETURN_ENABLED())
         dtrace_function_return(f);
     _Py_LeaveRecursiveCall(tstate);
+pop_frame:
     f->f_executing = 0;
     tstate->frame = f->f_back;
 
+    if (f != entry_frame) {
+        /* Return to the caller of an inlined call */
+        PyFrameObject *callee = f;
+        f = f->f_back;
+        retval = _Py_CheckFunctionResult(tstate, NULL, retval, __func__);
+        _PyFrame_Release(tstate, callee);
+
+        co = f->f_code;
+        names = co->co_names;
+        consts = co->co_consts;
+        fastlocals = f->f_localsptr;
+        freevars = f->f_localsptr + co->co_nlocals;
+        if (co->co_quickened != NULL) {
+            first_instr = co->co_quickened;
+        }
+        else {
+            first_instr = (_Py_CODEUNIT *) PyBytes_AS_STRING(co->co_code);
+        }
+        next_instr = first_instr + f->f_lasti / sizeof(_Py_CODEUNIT) + 1;
+        stack_pointer = f->f_stacktop;
+        f->f_stacktop = NULL;
+        instr_lb = f->f_instr_lb;
+        instr_ub = f->f_instr_ub;
+        instr_prev = f->f_instr_prev;
+#ifdef LLTRACE
+        lltrace = _PyDict_GetItemId(f->f_globals, &PyId___ltrace__) != NULL;
+#endif
+        if (retval == NULL) {
+            goto error;
+        }
+        PUSH(retval);
+        retval = NULL;
+        goto main_loop;
+    }
+
     return _Py_CheckFunctionResult(tstate, NULL, retval, __func__);
 }
 
@@ -4129,13 +5036,20 @@ _PyEval_EvalCode(PyThreadState *tstate,
         return NULL;
     }
 
-    /* Create the frame */
-    PyFrameObject *f = _PyFrame_New_NoTrack(tstate, co, globals, locals);
+    /* Create the frame.  A generator or coroutine frame outlives the call,
+       so only other frames can use the thread's data stack. */
+    PyFrameObject *f;
+    if (co->co_flags & (CO_GENERATOR | CO_COROUTINE | CO_ASYNC_GENERATOR)) {
+        f = _PyFrame_New_NoTrack(tstate, co, globals, locals);
+    }
+    else {
+        f = _PyFrame_NewOnStack_NoTrack(tstate, co, globals, locals);
+    }
     if (f == NULL) {
         return NULL;
     }
-    PyObject **fastlocals = f->f_localsplus;
-    PyObject **freevars = f->f_localsplus + co->co_nlocals;
+    PyObject **fastlocals = f->f_localsptr;
+    PyObject **freevars = f->f_localsptr + co->co_nlocals;
 
     /* Create a dictionary for keyword parameters (**kwags) */
     PyObject *kwdict;
@@ -4366,19 +5280,24 @@ _PyEval_EvalCode(PyThreadState *tstate,
 
 fail: /* Jump here from prelude on failure */
 
-    /* decref'ing the frame can cause __del__ methods to get invoked,
-       which can call back into Python.  While we're done with the
-       current Python frame (f), the associated C stack is still in use,
-       so recursion_depth must be boosted for the duration.
-    */
-    if (Py_REFCNT(f) > 1) {
-        Py_DECREF(f);
-        _PyObject_GC_TRACK(f);
+    if (f->f_datastack) {
+        _PyFrame_Release(tstate, f);
     }
     else {
-        ++tstate->recursion_depth;
-        Py_DECREF(f);
-        --tstate->recursion_depth;
+        /* decref'ing the frame can cause __del__ methods to get invoked,
+           which can call back into Python.  While we're done with the
+           current Python frame (f), the associated C stack is still in
+           use, so recursion_depth must be boosted for the duration.
+        */
+        if (Py_REFCNT(f) > 1) {
+            Py_DECREF(f);
+            _PyObject_GC_TRACK(f);
+        }
+        else {
+            ++tstate->recursion_depth;
+            Py_DECREF(f);
+            --tstate->recursion_depth;
+        }
     }
     return retval;
 }
@@ -5121,6 +6040,68 @@ call_function(PyThreadState *tstate, PyObject ***pp_stack, Py_ssize_t oparg, PyO
     return x;
 }
 
+/* Return 1 if the eval loop can run a call of func with nargs positional
+   arguments itself, pushing the new frame instead of recursing through
+   _PyFunction_Vectorcall().  This covers the functions that
+   _PyFunction_Vectorcall() sends to function_code_fastcall(): plain
+   functions with positional parameters, no cell or free variables, that
+   are neither generators nor coroutines.  Missing arguments may come from
+   the defaults.  Calls are not inlined while tracing or profiling, so that
+   the hooks see every call, nor when a PEP 523 frame evaluator is set. */
+Py_LOCAL_INLINE(int) _Py_HOT_FUNCTION
+can_inline_call(PyThreadState *tstate, PyObject *func, Py_ssize_t nargs)
+{
+    if (!PyFunction_Check(func) || tstate->use_tracing) {
+        return 0;
+    }
+    PyFunctionObject *op = (PyFunctionObject *)func;
+    PyCodeObject *co = (PyCodeObject *)op->func_code;
+    if (co->co_kwonlyargcount != 0 ||
+        (co->co_flags & ~PyCF_MASK) != (CO_OPTIMIZED | CO_NEWLOCALS | CO_NOFREE) ||
+        op->vectorcall != _PyFunction_Vectorcall ||
+        tstate->interp->eval_frame != _PyEval_EvalFrameDefault)
+    {
+        return 0;
+    }
+    if (nargs == co->co_argcount) {
+        return 1;
+    }
+    Py_ssize_t ndefaults = (op->func_defaults == NULL ? 0 :
+                            PyTuple_GET_SIZE(op->func_defaults));
+    return nargs < co->co_argcount && co->co_argcount - nargs <= ndefaults;
+}
+
+/* Create the frame of an inlined call (see can_inline_call()) and move the
+   nargs arguments at args into it.  On success, the references to the
+   arguments are stolen; on failure, they are left untouched. */
+static PyFrameObject *
+inline_call_frame(PyThreadState *tstate, PyObject *func,
+                  PyObject **args, Py_ssize_t nargs)
+{
+    PyFunctionObject *op = (PyFunctionObject *)func;
+    PyCodeObject *co = (PyCodeObject *)op->func_code;
+    PyFrameObject *f = _PyFrame_NewOnStack_NoTrack(tstate, co,
+                                                   op->func_globals, NULL);
+    if (f == NULL) {
+        return NULL;
+    }
+
+    PyObject **fastlocals = f->f_localsptr;
+    for (Py_ssize_t i = 0; i < nargs; i++) {
+        fastlocals[i] = args[i];
+    }
+    if (nargs < co->co_argcount) {
+        Py_ssize_t ndefaults = PyTuple_GET_SIZE(op->func_defaults);
+        PyObject **defaults = (_PyTuple_ITEMS(op->func_defaults)
+                               + ndefaults - co->co_argcount);
+        for (Py_ssize_t i = nargs; i < co->co_argcount; i++) {
+            Py_INCREF(defaults[i]);
+            fastlocals[i] = defaults[i];
+        }
+    }
+    return f;
+}
+
 static PyObject *
 do_call_core(PyThreadState *tstate, PyObject *func, PyObject *callargs, PyObject *kwdict)
 {
@@ -5206,6 +6187,125 @@ _PyEval_SliceIndexNotNone(PyObject *v, Py_ssize_t *pi)
     return 1;
 }
 
+/* Fill the LOAD_ATTR/STORE_ATTR cache entry at for the attribute name of
+   owner, whose type uses the generic attribute protocol.
+
+   The attribute can be cached if it lives in a T_OBJECT_EX slot of the
+   instance, or in the instance dict without being shadowed by a data
+   descriptor of the type.  Return 1 if the entry was filled, 0 if the
+   attribute cannot be cached, -1 with an exception set on error. */
+static int
+opcache_attr_fill(_PyOpcache_Attr *at, PyObject *owner, PyObject *name)
+{
+    PyTypeObject *type = Py_TYPE(owner);
+    Py_ssize_t hint = -1;
+
+    if (!PyUnicode_CheckExact(name)) {
+        return 0;
+    }
+    if (type->tp_dict == NULL && PyType_Ready(type) < 0) {
+        return -1;
+    }
+    PyObject *descr = _PyType_Lookup(type, name);
+    if (descr != NULL && Py_IS_TYPE(descr, &PyMemberDescr_Type)) {
+        struct PyMemberDef *dmem = ((PyMemberDescrObject *)descr)->d_member;
+        if (dmem->type != T_OBJECT_EX || dmem->flags != 0 ||
+            !PyType_IsSubtype(type, PyDescr_TYPE(descr)))
+        {
+            return 0;
+        }
+        /* 0 would be confused with a dict hint */
+        assert(dmem->offset > 0);
+        hint = ~dmem->offset;
+    }
+    else if ((descr == NULL || Py_TYPE(descr)->tp_descr_set == NULL) &&
+             type->tp_dictoffset > 0)
+    {
+        PyObject *dict = *(PyObject **)((char *)owner + type->tp_dictoffset);
+        PyObject *value;
+        if (dict == NULL || !PyDict_CheckExact(dict)) {
+            return 0;
+        }
+        Py_INCREF(dict);
+        hint = _PyDict_GetItemHint((PyDictObject *)dict, name, -1, &value);
+        Py_DECREF(dict);
+        if (value == NULL) {
+            return PyErr_Occurred() ? -1 : 0;
+        }
+    }
+    else {
+        return 0;
+    }
+
+    /* The lookup of the type may have (re)assigned its version tag */
+    if (!_PyType_HasFeature(type, Py_TPFLAGS_VALID_VERSION_TAG)) {
+        return 0;
+    }
+    at->type = type;
+    at->tp_version_tag = type->tp_version_tag;
+    at->hint = hint;
+    return 1;
+}
+
+/* Return the _PyOpcache_BINARY_* specialization of BINARY_ADD for the
+   given operands */
+static int
+binary_add_kind(PyObject *left, PyObject *right)
+{
+    if (Py_TYPE(left) != Py_TYPE(right)) {
+        return _PyOpcache_BINARY_GENERIC;
+    }
+    if (PyLong_CheckExact(left)) {
+        return _PyOpcache_BINARY_ADD_INT;
+    }
+    if (PyFloat_CheckExact(left)) {
+        return _PyOpcache_BINARY_ADD_FLOAT;
+    }
+    if (PyUnicode_CheckExact(left)) {
+        return _PyOpcache_BINARY_ADD_UNICODE;
+    }
+    return _PyOpcache_BINARY_GENERIC;
+}
+
+/* Return the _PyOpcache_BINARY_* specialization of BINARY_SUBSCR for the
+   given operands */
+static int
+binary_subscr_kind(PyObject *container, PyObject *sub)
+{
+    if (PyDict_CheckExact(container)) {
+        return _PyOpcache_BINARY_SUBSCR_DICT;
+    }
+    if (PyLong_CheckExact(sub)) {
+        if (PyList_CheckExact(container)) {
+            return _PyOpcache_BINARY_SUBSCR_LIST_INT;
+        }
+        if (PyTuple_CheckExact(container)) {
+            return _PyOpcache_BINARY_SUBSCR_TUPLE_INT;
+        }
+    }
+    return _PyOpcache_BINARY_GENERIC;
+}
+
+/* Convert the exact int sub to an index into a sequence of size items,
+   counting negative indices from the end.  Return -1 if the index is out
+   of range; the caller then takes the generic path to raise the error. */
+static Py_ssize_t
+subscr_fast_index(PyThreadState *tstate, PyObject *sub, Py_ssize_t size)
+{
+    Py_ssize_t i = PyLong_AsSsize_t(sub);
+    if (i == -1 && _PyErr_Occurred(tstate)) {
+        _PyErr_Clear(tstate);
+        return -1;
+    }
+    if (i < 0) {
+        i += size;
+    }
+    if ((size_t)i >= (size_t)size) {
+        return -1;
+    }
+    return i;
+}
+
 static PyObject *
 import_name(PyThreadState *tstate, PyFrameObject *f,
             PyObject *name, PyObject *fromlist, PyObject *level)
@@ -5551,15 +6651,16 @@ unicode_concatenate(PyThreadState *tstate, PyObject *v, PyObject *w,
         NEXTOPARG();
         switch (opcode) {
         case STORE_FAST:
+        case STORE_FAST__LOAD_FAST:
         {
-            PyObject **fastlocals = f->f_localsplus;
+            PyObject **fastlocals = f->f_localsptr;
             if (GETLOCAL(oparg) == v)
                 SETLOCAL(oparg, NULL);
             break;
         }
         case STORE_DEREF:
         {
-            PyObject **freevars = (f->f_localsplus +
+            PyObject **freevars = (f->f_localsptr +
                                    f->f_code->co_nlocals);
             PyObject *c = freevars[oparg];
             if (PyCell_GET(c) ==  v) {
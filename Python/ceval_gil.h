@@ -47,6 +47,24 @@
      run and end up being the first to re-acquire it, making the "timeslices"
      much longer than expected.
      (Note: this mechanism is enabled with FORCE_SWITCHING above)
+
+   - In fair mode (sys._setgilmode('fair')), a thread which finds the GIL
+     taken appends itself to a wait queue and sleeps on its own condition
+     variable.  drop_gil() then hands the GIL over to the head of the queue
+     without unlocking it, so that a thread which just dropped the GIL or a
+     newcomer cannot take it before the threads already waiting.
+
+     There are two queues.  Threads which reacquire the GIL after releasing
+     it on their own, typically around a blocking I/O call, go to the
+     priority queue and set gil_drop_request immediately instead of waiting
+     for `interval` microseconds.  Threads which were asked to drop the GIL
+     go to the normal queue.  To avoid starving them, the head of the normal
+     queue is served first once it has waited for longer than `interval`
+     microseconds times the length of the normal queue plus one, i.e. more
+     than a round of switch intervals without priority threads.
+
+   - The time spent waiting in take_gil() is recorded in two histograms
+     (one per queue kind) which are returned by sys._getgilstats().
 */
 
 #include "condvar.h"
@@ -90,6 +108,117 @@
 
 #define DEFAULT_INTERVAL 5000
 
+struct _gil_waiter {
+    struct _gil_waiter *next;
+    /* Signalled with gil->mutex held when the GIL is handed over */
+    PyCOND_T cond;
+    int granted;
+    /* When the thread started waiting */
+    _PyTime_t since;
+};
+
+static void
+gil_enqueue(struct _gil_waitqueue *queue, struct _gil_waiter *waiter)
+{
+    waiter->next = NULL;
+    if (queue->tail != NULL) {
+        queue->tail->next = waiter;
+    }
+    else {
+        queue->head = waiter;
+    }
+    queue->tail = waiter;
+    queue->length++;
+}
+
+static void
+gil_dequeue(struct _gil_waitqueue *queue, struct _gil_waiter *waiter)
+{
+    struct _gil_waiter *prev = NULL;
+    struct _gil_waiter *w = queue->head;
+    while (w != waiter) {
+        assert(w != NULL);
+        prev = w;
+        w = w->next;
+    }
+    if (prev != NULL) {
+        prev->next = waiter->next;
+    }
+    else {
+        queue->head = waiter->next;
+    }
+    if (queue->tail == waiter) {
+        queue->tail = prev;
+    }
+    waiter->next = NULL;
+    queue->length--;
+}
+
+/* Pick the thread the GIL is handed over to in fair mode and remove it from
+   its queue, or return NULL if no thread is waiting.  gil->mutex must be
+   held. */
+static struct _gil_waiter *
+gil_next_waiter(struct _gil_runtime_state *gil)
+{
+    struct _gil_waitqueue *queue = &gil->waiters[1];
+    struct _gil_waiter *normal = gil->waiters[0].head;
+    if (queue->head == NULL) {
+        queue = &gil->waiters[0];
+    }
+    else if (normal != NULL) {
+        /* Don't let threads returning from I/O starve the others: serve
+           the normal queue once its head has waited for longer than a
+           round of switch intervals of the threads in front of it. */
+        _PyTime_t waited = _PyTime_GetMonotonicClock() - normal->since;
+        if (_PyTime_AsMicroseconds(waited, _PyTime_ROUND_FLOOR)
+            >= (_PyTime_t)(gil->interval * (gil->waiters[0].length + 1)))
+        {
+            queue = &gil->waiters[0];
+        }
+    }
+    struct _gil_waiter *waiter = queue->head;
+    if (waiter != NULL) {
+        gil_dequeue(queue, waiter);
+    }
+    return waiter;
+}
+
+static void
+gil_record_wait(struct _gil_runtime_state *gil, int priority, _PyTime_t waited)
+{
+    _PyTime_t us = _PyTime_AsMicroseconds(waited, _PyTime_ROUND_FLOOR);
+    int bucket = 0;
+    while (us > 0 && bucket < _PyGIL_WAIT_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    gil->wait_histogram[priority][bucket]++;
+}
+
+/* Add delta to the GIL counters of tstate and of its interpreter.
+   gil->mutex must be held. */
+static void
+gil_account(PyThreadState *tstate, const _PyGILStats *delta)
+{
+    _PyGILStats *all[2] = {&tstate->gil_stats,
+                           &tstate->interp->ceval.gil_stats};
+    for (int i = 0; i < 2; i++) {
+        _PyGILStats *stats = all[i];
+        stats->wait_time += delta->wait_time;
+        stats->hold_time += delta->hold_time;
+        stats->acquisitions += delta->acquisitions;
+        stats->forced_drops += delta->forced_drops;
+        stats->drop_requests += delta->drop_requests;
+    }
+}
+
+static void
+gil_account_drop_request(PyThreadState *tstate)
+{
+    _PyGILStats delta = {.drop_requests = 1};
+    gil_account(tstate, &delta);
+}
+
 static void _gil_initialize(struct _gil_runtime_state *gil)
 {
     _Py_atomic_int uninitialized = {-1};
@@ -113,6 +242,8 @@ static void create_gil(struct _gil_runtime_state *gil)
     COND_INIT(gil->switch_cond);
 #endif
     _Py_atomic_store_relaxed(&gil->last_holder, 0);
+    /* After fork, the queues refer to threads of the parent process */
+    memset(gil->waiters, 0, sizeof(gil->waiters));
     _Py_ANNOTATE_RWLOCK_CREATE(&gil->locked);
     _Py_atomic_store_explicit(&gil->locked, 0, _Py_memory_order_release);
 }
@@ -162,9 +293,27 @@ drop_gil(struct _ceval_runtime_state *ceval, struct _ceval_state *ceval2,
     }
 
     MUTEX_LOCK(gil->mutex);
+    if (tstate != NULL && tstate->gil_taken != 0) {
+        _PyGILStats delta = {
+            .hold_time = _PyTime_GetMonotonicClock() - tstate->gil_taken};
+        tstate->gil_taken = 0;
+        gil_account(tstate, &delta);
+    }
     _Py_ANNOTATE_RWLOCK_RELEASED(&gil->locked, /*is_write=*/1);
-    _Py_atomic_store_relaxed(&gil->locked, 0);
-    COND_SIGNAL(gil->cond);
+    struct _gil_waiter *waiter = NULL;
+    if (gil->fair) {
+        waiter = gil_next_waiter(gil);
+    }
+    if (waiter != NULL) {
+        /* Hand the GIL over: it stays locked */
+        waiter->granted = 1;
+        gil->handoffs++;
+        COND_SIGNAL(waiter->cond);
+    }
+    else {
+        _Py_atomic_store_relaxed(&gil->locked, 0);
+        COND_SIGNAL(gil->cond);
+    }
     MUTEX_UNLOCK(gil->mutex);
 
 #ifdef FORCE_SWITCHING
@@ -206,13 +355,64 @@ tstate_must_exit(PyThreadState *tstate)
 }
 
 
+/* Wait in fair mode until the GIL is handed over to the thread.
+   Return 1 if it was, or 0 if the GIL was switched back to the default
+   mode in the meantime.  gil->mutex must be held. */
+static int
+take_gil_fair(struct _gil_runtime_state *gil, PyThreadState *tstate,
+              int priority, _PyTime_t since)
+{
+    PyInterpreterState *interp = tstate->interp;
+    struct _gil_waitqueue *queue = &gil->waiters[priority];
+    struct _gil_waiter waiter;
+    COND_INIT(waiter.cond);
+    waiter.granted = 0;
+    waiter.since = since;
+    gil_enqueue(queue, &waiter);
+
+    if (priority) {
+        SET_GIL_DROP_REQUEST(interp);
+        gil_account_drop_request(tstate);
+    }
+    while (!waiter.granted && gil->fair) {
+        unsigned long saved_switchnum = gil->switch_number;
+
+        unsigned long interval = (gil->interval >= 1 ? gil->interval : 1);
+        int timed_out = 0;
+        COND_TIMED_WAIT(waiter.cond, gil->mutex, interval, timed_out);
+
+        if (timed_out && !waiter.granted && gil->fair &&
+            gil->switch_number == saved_switchnum)
+        {
+            if (tstate_must_exit(tstate)) {
+                gil_dequeue(queue, &waiter);
+                MUTEX_UNLOCK(gil->mutex);
+                PyThread_exit_thread();
+            }
+            assert(is_tstate_valid(tstate));
+
+            SET_GIL_DROP_REQUEST(interp);
+            gil_account_drop_request(tstate);
+        }
+    }
+    if (!waiter.granted) {
+        gil_dequeue(queue, &waiter);
+    }
+    COND_FINI(waiter.cond);
+    return waiter.granted;
+}
+
+
 /* Take the GIL.
 
+   priority is non-zero if the thread released the GIL on its own rather
+   than on a drop request; it is served first in fair mode.
+
    The function saves errno at entry and restores its value at exit.
 
    tstate must be non-NULL. */
 static void
-take_gil(PyThreadState *tstate)
+take_gil(PyThreadState *tstate, int priority)
 {
     int err = errno;
 
@@ -243,11 +443,21 @@ take_gil(PyThreadState *tstate)
 
     MUTEX_LOCK(gil->mutex);
 
+    _PyTime_t since = 0, now, waited;
     if (!_Py_atomic_load_relaxed(&gil->locked)) {
         goto _ready;
     }
 
+    since = _PyTime_GetMonotonicClock();
     while (_Py_atomic_load_relaxed(&gil->locked)) {
+        if (gil->fair) {
+            if (take_gil_fair(gil, tstate, priority, since)) {
+                /* The GIL was handed over to us */
+                break;
+            }
+            continue;
+        }
+
         unsigned long saved_switchnum = gil->switch_number;
 
         unsigned long interval = (gil->interval >= 1 ? gil->interval : 1);
@@ -267,10 +477,14 @@ take_gil(PyThreadState *tstate)
             assert(is_tstate_valid(tstate));
 
             SET_GIL_DROP_REQUEST(interp);
+            gil_account_drop_request(tstate);
         }
     }
 
 _ready:
+    now = (since != 0 || gil->timing) ? _PyTime_GetMonotonicClock() : 0;
+    waited = (since != 0) ? now - since : 0;
+    gil_record_wait(gil, priority, waited);
 #ifdef FORCE_SWITCHING
     /* This mutex must be taken before modifying gil->last_holder:
        see drop_gil(). */
@@ -297,13 +511,19 @@ _ready:
 
            This code path can be reached by a daemon thread which was waiting
            in take_gil() while the main thread called
-           wait_for_thread_shutdown() from Py_Finalize(). */
+           wait_for_thread_shutdown() from Py_Finalize(). tstate can be a
+           dangling pointer: don't pass it to drop_gil(). */
         MUTEX_UNLOCK(gil->mutex);
-        drop_gil(ceval, ceval2, tstate);
+        drop_gil(ceval, ceval2, NULL);
         PyThread_exit_thread();
     }
     assert(is_tstate_valid(tstate));
 
+    _PyGILStats delta = {.wait_time = waited, .acquisitions = 1,
+                         .forced_drops = !priority};
+    gil_account(tstate, &delta);
+    tstate->gil_taken = gil->timing ? now : 0;
+
     if (_Py_atomic_load_relaxed(&ceval2->gil_drop_request)) {
         RESET_GIL_DROP_REQUEST(interp);
     }
@@ -347,3 +567,229 @@ unsigned long _PyEval_GetSwitchInterval()
 #endif
     return gil->interval;
 }
+
+void _PyEval_SetGILMode(int fair)
+{
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    PyInterpreterState *interp = PyInterpreterState_Get();
+    struct _gil_runtime_state *gil = &interp->ceval.gil;
+#else
+    struct _gil_runtime_state *gil = &_PyRuntime.ceval.gil;
+#endif
+    MUTEX_LOCK(gil->mutex);
+    gil->fair = fair;
+    if (!fair) {
+        /* Wake up the queued threads: they wait in the default mode */
+        for (int i = 0; i < 2; i++) {
+            for (struct _gil_waiter *w = gil->waiters[i].head; w; w = w->next) {
+                COND_SIGNAL(w->cond);
+            }
+        }
+    }
+    MUTEX_UNLOCK(gil->mutex);
+}
+
+int _PyEval_GetGILMode(void)
+{
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    PyInterpreterState *interp = PyInterpreterState_Get();
+    struct _gil_runtime_state *gil = &interp->ceval.gil;
+#else
+    struct _gil_runtime_state *gil = &_PyRuntime.ceval.gil;
+#endif
+    return gil->fair;
+}
+
+static PyObject *
+gil_histogram_as_tuple(const uint64_t *histogram)
+{
+    PyObject *result = PyTuple_New(_PyGIL_WAIT_BUCKETS);
+    if (result == NULL) {
+        return NULL;
+    }
+    for (int i = 0; i < _PyGIL_WAIT_BUCKETS; i++) {
+        PyObject *count = PyLong_FromUnsignedLongLong(histogram[i]);
+        if (count == NULL) {
+            Py_DECREF(result);
+            return NULL;
+        }
+        PyTuple_SET_ITEM(result, i, count);
+    }
+    return result;
+}
+
+void _PyEval_SetGILTiming(int enabled)
+{
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    PyInterpreterState *interp = PyInterpreterState_Get();
+    struct _gil_runtime_state *gil = &interp->ceval.gil;
+#else
+    struct _gil_runtime_state *gil = &_PyRuntime.ceval.gil;
+#endif
+    MUTEX_LOCK(gil->mutex);
+    gil->timing = enabled;
+    MUTEX_UNLOCK(gil->mutex);
+}
+
+int _PyEval_GetGILTiming(void)
+{
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    PyInterpreterState *interp = PyInterpreterState_Get();
+    struct _gil_runtime_state *gil = &interp->ceval.gil;
+#else
+    struct _gil_runtime_state *gil = &_PyRuntime.ceval.gil;
+#endif
+    return gil->timing;
+}
+
+static struct _gil_runtime_state *
+gil_of_interpreter(PyInterpreterState *interp)
+{
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+    return &interp->ceval.gil;
+#else
+    return &interp->runtime->ceval.gil;
+#endif
+}
+
+/* Copy the GIL counters of tstate into stats.  The hold time of the
+   current GIL holder doesn't include the ongoing hold. */
+void
+_PyEval_GetThreadGILStats(PyThreadState *tstate, _PyGILStats *stats)
+{
+    struct _gil_runtime_state *gil = gil_of_interpreter(tstate->interp);
+    MUTEX_LOCK(gil->mutex);
+    *stats = tstate->gil_stats;
+    MUTEX_UNLOCK(gil->mutex);
+}
+
+/* Copy the GIL counters of all the threads of interp, including the
+   threads which are gone, into stats */
+void
+_PyEval_GetInterpreterGILStats(PyInterpreterState *interp, _PyGILStats *stats)
+{
+    struct _gil_runtime_state *gil = gil_of_interpreter(interp);
+    MUTEX_LOCK(gil->mutex);
+    *stats = interp->ceval.gil_stats;
+    MUTEX_UNLOCK(gil->mutex);
+}
+
+static PyObject *
+gil_stats_as_dict(const _PyGILStats *stats)
+{
+    return Py_BuildValue("{s:d,s:d,s:K,s:K,s:K}",
+                         "wait_time", _PyTime_AsSecondsDouble(stats->wait_time),
+                         "hold_time", _PyTime_AsSecondsDouble(stats->hold_time),
+                         "acquisitions",
+                         (unsigned long long)stats->acquisitions,
+                         "forced_drops",
+                         (unsigned long long)stats->forced_drops,
+                         "drop_requests",
+                         (unsigned long long)stats->drop_requests);
+}
+
+/* Return a dict mapping the thread identifiers of the threads of interp
+   to their GIL counters */
+static PyObject *
+gil_thread_stats(PyInterpreterState *interp)
+{
+    struct _gil_runtime_state *gil = gil_of_interpreter(interp);
+    _PyRuntimeState *runtime = interp->runtime;
+    struct thread_gil_stats {
+        unsigned long thread_id;
+        _PyGILStats stats;
+    } *threads;
+    Py_ssize_t n = 0;
+
+    /* Copy the counters first: no Python code may run while the thread
+       list lock and the GIL mutex are held. */
+    PyThread_acquire_lock(runtime->interpreters.mutex, WAIT_LOCK);
+    for (PyThreadState *t = interp->tstate_head; t != NULL; t = t->next) {
+        n++;
+    }
+    threads = PyMem_RawMalloc(n * sizeof(*threads));
+    if (threads == NULL) {
+        PyThread_release_lock(runtime->interpreters.mutex);
+        return PyErr_NoMemory();
+    }
+    MUTEX_LOCK(gil->mutex);
+    Py_ssize_t i = 0;
+    for (PyThreadState *t = interp->tstate_head; t != NULL; t = t->next) {
+        threads[i].thread_id = t->thread_id;
+        threads[i].stats = t->gil_stats;
+        i++;
+    }
+    MUTEX_UNLOCK(gil->mutex);
+    PyThread_release_lock(runtime->interpreters.mutex);
+
+    PyObject *result = PyDict_New();
+    if (result == NULL) {
+        goto done;
+    }
+    for (i = 0; i < n; i++) {
+        PyObject *id = PyLong_FromUnsignedLong(threads[i].thread_id);
+        if (id == NULL) {
+            Py_CLEAR(result);
+            goto done;
+        }
+        PyObject *stats = gil_stats_as_dict(&threads[i].stats);
+        if (stats == NULL) {
+            Py_DECREF(id);
+            Py_CLEAR(result);
+            goto done;
+        }
+        int res = PyDict_SetItem(result, id, stats);
+        Py_DECREF(id);
+        Py_DECREF(stats);
+        if (res < 0) {
+            Py_CLEAR(result);
+            goto done;
+        }
+    }
+
+done:
+    PyMem_RawFree(threads);
+    return result;
+}
+
+PyObject *
+_PyEval_GetGILStats(void)
+{
+    PyInterpreterState *interp = _PyInterpreterState_GET();
+    struct _gil_runtime_state *gil = gil_of_interpreter(interp);
+    /* Copy the counters under the mutex so that they are consistent with
+       each other */
+    unsigned long switches, handoffs;
+    uint64_t histogram[2][_PyGIL_WAIT_BUCKETS];
+    _PyGILStats interp_stats;
+    MUTEX_LOCK(gil->mutex);
+    switches = gil->switch_number;
+    handoffs = gil->handoffs;
+    memcpy(histogram, gil->wait_histogram, sizeof(histogram));
+    interp_stats = interp->ceval.gil_stats;
+    MUTEX_UNLOCK(gil->mutex);
+
+    PyObject *io_waits = gil_histogram_as_tuple(histogram[1]);
+    PyObject *cpu_waits = gil_histogram_as_tuple(histogram[0]);
+    PyObject *interp_dict = gil_stats_as_dict(&interp_stats);
+    PyObject *threads = gil_thread_stats(interp);
+    PyObject *stats = NULL;
+    if (io_waits != NULL && cpu_waits != NULL && interp_dict != NULL
+        && threads != NULL)
+    {
+        stats = Py_BuildValue("{s:s,s:O,s:k,s:k,s:O,s:O,s:O,s:O}",
+                              "mode", gil->fair ? "fair" : "default",
+                              "timing", gil->timing ? Py_True : Py_False,
+                              "switches", switches,
+                              "handoffs", handoffs,
+                              "io_waits", io_waits,
+                              "cpu_waits", cpu_waits,
+                              "interpreter", interp_dict,
+                              "threads", threads);
+    }
+    Py_XDECREF(io_waits);
+    Py_XDECREF(cpu_waits);
+    Py_XDECREF(interp_dict);
+    Py_XDECREF(threads);
+    return stats;
+}
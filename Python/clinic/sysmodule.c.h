@@ -350,6 +350,128 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(sys__setgilmode__doc__,
+"_setgilmode($module, mode, /)\n"
+"--\n"
+"\n"
+"Set how the GIL is handed over between threads.\n"
+"\n"
+"\'default\' lets the threads compete for the GIL when it is released.\n"
+"\'fair\' hands it over to the waiting threads in order, serving first the\n"
+"threads which released it around a blocking call.");
+
+#define SYS__SETGILMODE_METHODDEF    \
+    {"_setgilmode", (PyCFunction)sys__setgilmode, METH_O, sys__setgilmode__doc__},
+
+static PyObject *
+sys__setgilmode_impl(PyObject *module, const char *mode);
+
+static PyObject *
+sys__setgilmode(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    const char *mode;
+
+    if (!PyUnicode_Check(arg)) {
+        _PyArg_BadArgument("_setgilmode", "argument", "str", arg);
+        goto exit;
+    }
+    Py_ssize_t mode_length;
+    mode = PyUnicode_AsUTF8AndSize(arg, &mode_length);
+    if (mode == NULL) {
+        goto exit;
+    }
+    if (strlen(mode) != (size_t)mode_length) {
+        PyErr_SetString(PyExc_ValueError, "embedded null character");
+        goto exit;
+    }
+    return_value = sys__setgilmode_impl(module, mode);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(sys__getgilmode__doc__,
+"_getgilmode($module, /)\n"
+"--\n"
+"\n"
+"Return the GIL mode, \'default\' or \'fair\'; see sys._setgilmode().");
+
+#define SYS__GETGILMODE_METHODDEF    \
+    {"_getgilmode", (PyCFunction)sys__getgilmode, METH_NOARGS, sys__getgilmode__doc__},
+
+static PyObject *
+sys__getgilmode_impl(PyObject *module);
+
+static PyObject *
+sys__getgilmode(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__getgilmode_impl(module);
+}
+
+PyDoc_STRVAR(sys__getgilstats__doc__,
+"_getgilstats($module, /)\n"
+"--\n"
+"\n"
+"Return a dict with statistics about the GIL.\n"
+"\n"
+"\'switches\' is the number of times the GIL changed threads and \'handoffs\'\n"
+"the number of times it was handed over directly in fair mode.\n"
+"\'io_waits\' and \'cpu_waits\' are histograms of the time spent waiting for\n"
+"the GIL by the threads which released it on their own and by those asked to\n"
+"drop it: item 0 counts waits under 1 microsecond, item i waits from\n"
+"2**(i-1) to 2**i microseconds, and the last item all the longer waits.\n"
+"\n"
+"\'interpreter\' holds the counters of all the threads of the current\n"
+"interpreter and \'threads\' maps the identifiers of its threads to their\n"
+"own counters: \'wait_time\' and \'hold_time\' in seconds, the number of\n"
+"\'acquisitions\', the number of \'forced_drops\' of the GIL on a request of\n"
+"another thread and the number of \'drop_requests\' sent to the GIL holder.\n"
+"The hold time is only measured while \'timing\' is true; see\n"
+"sys._setgiltiming().");
+
+#define SYS__GETGILSTATS_METHODDEF    \
+    {"_getgilstats", (PyCFunction)sys__getgilstats, METH_NOARGS, sys__getgilstats__doc__},
+
+static PyObject *
+sys__getgilstats_impl(PyObject *module);
+
+static PyObject *
+sys__getgilstats(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__getgilstats_impl(module);
+}
+
+PyDoc_STRVAR(sys__setgiltiming__doc__,
+"_setgiltiming($module, enabled, /)\n"
+"--\n"
+"\n"
+"Enable or disable measuring the time threads hold the GIL.\n"
+"\n"
+"This reads the monotonic clock each time a thread takes or drops the GIL.");
+
+#define SYS__SETGILTIMING_METHODDEF    \
+    {"_setgiltiming", (PyCFunction)sys__setgiltiming, METH_O, sys__setgiltiming__doc__},
+
+static PyObject *
+sys__setgiltiming_impl(PyObject *module, int enabled);
+
+static PyObject *
+sys__setgiltiming(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int enabled;
+
+    enabled = PyObject_IsTrue(arg);
+    if (enabled < 0) {
+        goto exit;
+    }
+    return_value = sys__setgiltiming_impl(module, enabled);
+
+exit:
+    return return_value;
+}
+
 PyDoc_STRVAR(sys_setrecursionlimit__doc__,
 "setrecursionlimit($module, limit, /)\n"
 "--\n"
@@ -738,6 +860,34 @@ exit:
     return return_value;
 }
 
+PyDoc_STRVAR(sys_getunicodeinternedsize__doc__,
+"getunicodeinternedsize($module, /)\n"
+"--\n"
+"\n"
+"Return the number of elements of the unicode interned dictionary.");
+
+#define SYS_GETUNICODEINTERNEDSIZE_METHODDEF    \
+    {"getunicodeinternedsize", (PyCFunction)sys_getunicodeinternedsize, METH_NOARGS, sys_getunicodeinternedsize__doc__},
+
+static Py_ssize_t
+sys_getunicodeinternedsize_impl(PyObject *module);
+
+static PyObject *
+sys_getunicodeinternedsize(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    PyObject *return_value = NULL;
+    Py_ssize_t _return_value;
+
+    _return_value = sys_getunicodeinternedsize_impl(module);
+    if ((_return_value == -1) && PyErr_Occurred()) {
+        goto exit;
+    }
+    return_value = PyLong_FromSsize_t(_return_value);
+
+exit:
+    return return_value;
+}
+
 PyDoc_STRVAR(sys__getframe__doc__,
 "_getframe($module, depth=0, /)\n"
 "--\n"
@@ -860,6 +1010,76 @@ sys__debugmallocstats(PyObject *module, PyObject *Py_UNUSED(ignored))
     return sys__debugmallocstats_impl(module);
 }
 
+PyDoc_STRVAR(sys__setmalloccaches__doc__,
+"_setmalloccaches($module, enabled, /)\n"
+"--\n"
+"\n"
+"Enable or disable the caches of free memory blocks of pymalloc per thread.\n"
+"\n"
+"A thread then reuses the small blocks it freed itself, which avoids\n"
+"sharing the bookkeeping of the allocator with the other threads.\n"
+"Disabling the caches returns the blocks of all threads to the allocator.");
+
+#define SYS__SETMALLOCCACHES_METHODDEF    \
+    {"_setmalloccaches", (PyCFunction)sys__setmalloccaches, METH_O, sys__setmalloccaches__doc__},
+
+static PyObject *
+sys__setmalloccaches_impl(PyObject *module, int enabled);
+
+static PyObject *
+sys__setmalloccaches(PyObject *module, PyObject *arg)
+{
+    PyObject *return_value = NULL;
+    int enabled;
+
+    enabled = PyObject_IsTrue(arg);
+    if (enabled < 0) {
+        goto exit;
+    }
+    return_value = sys__setmalloccaches_impl(module, enabled);
+
+exit:
+    return return_value;
+}
+
+PyDoc_STRVAR(sys__getmalloccaches__doc__,
+"_getmalloccaches($module, /)\n"
+"--\n"
+"\n"
+"Return True if pymalloc uses caches per thread; see sys._setmalloccaches().");
+
+#define SYS__GETMALLOCCACHES_METHODDEF    \
+    {"_getmalloccaches", (PyCFunction)sys__getmalloccaches, METH_NOARGS, sys__getmalloccaches__doc__},
+
+static PyObject *
+sys__getmalloccaches_impl(PyObject *module);
+
+static PyObject *
+sys__getmalloccaches(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__getmalloccaches_impl(module);
+}
+
+PyDoc_STRVAR(sys__malloc_stats__doc__,
+"_malloc_stats($module, /)\n"
+"--\n"
+"\n"
+"Return a dict of statistics about pymalloc\'s arenas, pools and blocks.\n"
+"\n"
+"Return None if pymalloc is not used.");
+
+#define SYS__MALLOC_STATS_METHODDEF    \
+    {"_malloc_stats", (PyCFunction)sys__malloc_stats, METH_NOARGS, sys__malloc_stats__doc__},
+
+static PyObject *
+sys__malloc_stats_impl(PyObject *module);
+
+static PyObject *
+sys__malloc_stats(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__malloc_stats_impl(module);
+}
+
 PyDoc_STRVAR(sys__clear_type_cache__doc__,
 "_clear_type_cache($module, /)\n"
 "--\n"
@@ -878,6 +1098,28 @@ sys__clear_type_cache(PyObject *module, PyObject *Py_UNUSED(ignored))
     return sys__clear_type_cache_impl(module);
 }
 
+PyDoc_STRVAR(sys__getcacheinfo__doc__,
+"_getcacheinfo($module, /)\n"
+"--\n"
+"\n"
+"Return a dict with the size and statistics of the internal caches.\n"
+"\n"
+"The \'type_cache\' entry describes the type attribute lookup cache of the\n"
+"current interpreter: its number of entries and its hit, miss and collision\n"
+"counters, and how many times it was grown.");
+
+#define SYS__GETCACHEINFO_METHODDEF    \
+    {"_getcacheinfo", (PyCFunction)sys__getcacheinfo, METH_NOARGS, sys__getcacheinfo__doc__},
+
+static PyObject *
+sys__getcacheinfo_impl(PyObject *module);
+
+static PyObject *
+sys__getcacheinfo(PyObject *module, PyObject *Py_UNUSED(ignored))
+{
+    return sys__getcacheinfo_impl(module);
+}
+
 PyDoc_STRVAR(sys_is_finalizing__doc__,
 "is_finalizing($module, /)\n"
 "--\n"
@@ -945,4 +1187,4 @@ sys_getandroidapilevel(PyObject *module, PyObject *Py_UNUSED(ignored))
 #ifndef SYS_GETANDROIDAPILEVEL_METHODDEF
     #define SYS_GETANDROIDAPILEVEL_METHODDEF
 #endif /* !defined(SYS_GETANDROIDAPILEVEL_METHODDEF) */
-/*[clinic end generated code: output=87baa3357293ea65 input=a9049054013a1b77]*/
+/*[clinic end generated code: output=cfe09eb4a7f818b4 input=a9049054013a1b77]*/
@@ -34,6 +34,12 @@ def write_contents(f):
     targets = ['_unknown_opcode'] * 256
     for opname, op in opcode.opmap.items():
         targets[op] = "TARGET_%s" % opname
+    # Superinstructions use the unused opcodes, in the same order as
+    # Tools/scripts/generate_opcode_h.py
+    free = (op for op in range(opcode.HAVE_ARGUMENT, 256)
+            if op not in opcode.opmap.values())
+    for first, second in opcode._superinstructions:
+        targets[next(free)] = "TARGET_%s__%s" % (first, second)
     f.write("static void *opcode_targets[256] = {\n")
     f.write(",\n".join(["    &&%s" % s for s in targets]))
     f.write("\n};\n")
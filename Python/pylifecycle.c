@@ -583,6 +583,11 @@ pycore_init_types(PyThreadState *tstate)
         return status;
     }
 
+    status = _PyType_InitCache(tstate);
+    if (_PyStatus_EXCEPTION(status)) {
+        return status;
+    }
+
     // Create the empty tuple singleton. It must be created before the first
     // PyType_Ready() call since PyType_Ready() creates tuples, for tp_bases
     // for example.
@@ -1274,6 +1279,9 @@ finalize_interp_types(PyThreadState *tstate, int is_main_interp)
     _PyUnicode_Fini(tstate);
     _PyFloat_Fini(tstate);
     _PyLong_Fini(tstate);
+
+    /* Cleanup typeobject.c's internal caches. */
+    _PyType_Fini(tstate);
 }
 
 
@@ -1282,6 +1290,9 @@ finalize_interp_clear(PyThreadState *tstate)
 {
     int is_main_interp = _Py_IsMainInterpreter(tstate);
 
+    /* Objects are only deallocated by reference counting from now on */
+    _PyGC_UndeferAll(tstate);
+
     /* Clear interpreter state and all thread states */
     PyInterpreterState_Clear(tstate->interp);
 
@@ -1444,9 +1455,6 @@ Py_FinalizeEx(void)
     /* Destroy the database used by _PyImport_{Fixup,Find}Extension */
     _PyImport_Fini();
 
-    /* Cleanup typeobject.c's internal caches. */
-    _PyType_Fini();
-
     /* unload faulthandler module */
     _PyFaulthandler_Fini();
 
@@ -613,6 +613,19 @@ new_threadstate(PyInterpreterState *interp, int init)
     tstate->context = NULL;
     tstate->context_ver = 1;
 
+    tstate->datastack_chunk = NULL;
+    tstate->datastack_spare = NULL;
+    tstate->datastack_top = NULL;
+    tstate->datastack_limit = NULL;
+
+    memset(&tstate->gil_stats, 0, sizeof(tstate->gil_stats));
+    tstate->gil_taken = 0;
+
+    tstate->obmalloc_cache = NULL;
+
+    tstate->deferred_refcnt = NULL;
+    tstate->deferred_refcnt_size = 0;
+
     if (init) {
         _PyThreadState_Init(tstate);
     }
@@ -777,6 +790,106 @@ _PyInterpreterState_ClearModules(PyInterpreterState *interp)
     }
 }
 
+/* The data stack of a thread is a list of chunks allocated with the object
+   arena allocator. Frames push their locals and value stack on it on entry
+   and pop them on exit, so the storage is reused in LIFO order without any
+   call to malloc(). The most recently popped chunk is kept as a spare, so a
+   call sequence oscillating around a chunk boundary does not map and unmap
+   memory on every call. */
+
+#define DATA_STACK_CHUNK_SIZE (16*1024)
+
+static _PyStackChunk*
+allocate_chunk(size_t size_in_bytes, _PyStackChunk *previous)
+{
+    PyObjectArenaAllocator arena;
+    PyObject_GetArenaAllocator(&arena);
+    _PyStackChunk *chunk = arena.alloc(arena.ctx, size_in_bytes);
+    if (chunk == NULL) {
+        return NULL;
+    }
+    chunk->previous = previous;
+    chunk->size = size_in_bytes;
+    chunk->top = 0;
+    return chunk;
+}
+
+static void
+free_chunk(_PyStackChunk *chunk)
+{
+    PyObjectArenaAllocator arena;
+    PyObject_GetArenaAllocator(&arena);
+    arena.free(arena.ctx, chunk, chunk->size);
+}
+
+static PyObject **
+push_chunk(PyThreadState *tstate, int size)
+{
+    size_t needed = sizeof(_PyStackChunk) + sizeof(PyObject *) * size;
+    _PyStackChunk *previous = tstate->datastack_chunk;
+    _PyStackChunk *chunk = tstate->datastack_spare;
+    if (chunk != NULL && chunk->size >= needed) {
+        tstate->datastack_spare = NULL;
+        chunk->previous = previous;
+        chunk->top = 0;
+    }
+    else {
+        size_t allocate_size = DATA_STACK_CHUNK_SIZE;
+        while (allocate_size < needed) {
+            allocate_size *= 2;
+        }
+        chunk = allocate_chunk(allocate_size, previous);
+        if (chunk == NULL) {
+            return NULL;
+        }
+    }
+    if (previous != NULL) {
+        previous->top = tstate->datastack_top - &previous->data[0];
+    }
+    tstate->datastack_chunk = chunk;
+    tstate->datastack_limit = (PyObject **)(((char *)chunk) + chunk->size);
+    return &chunk->data[0];
+}
+
+PyObject **
+_PyThreadState_PushLocals(PyThreadState *tstate, int size)
+{
+    PyObject **res = tstate->datastack_top;
+    if (res == NULL || size > tstate->datastack_limit - res) {
+        res = push_chunk(tstate, size);
+        if (res == NULL) {
+            _PyErr_NoMemory(tstate);
+            return NULL;
+        }
+    }
+    tstate->datastack_top = res + size;
+    for (int i = 0; i < size; i++) {
+        res[i] = NULL;
+    }
+    return res;
+}
+
+void
+_PyThreadState_PopLocals(PyThreadState *tstate, PyObject **locals)
+{
+    _PyStackChunk *chunk = tstate->datastack_chunk;
+    if (locals == &chunk->data[0] && chunk->previous != NULL) {
+        _PyStackChunk *previous = chunk->previous;
+        tstate->datastack_chunk = previous;
+        tstate->datastack_top = &previous->data[previous->top];
+        tstate->datastack_limit = (PyObject **)(((char *)previous) + previous->size);
+        if (tstate->datastack_spare != NULL) {
+            free_chunk(tstate->datastack_spare);
+        }
+        tstate->datastack_spare = chunk;
+    }
+    else {
+        assert(locals >= &chunk->data[0]);
+        assert(locals <= tstate->datastack_top);
+        tstate->datastack_top = locals;
+    }
+}
+
 void
 PyThreadState_Clear(PyThreadState *tstate)
 {
@@ -826,6 +939,30 @@ PyThreadState_Clear(PyThreadState *tstate)
     if (tstate->on_delete != NULL) {
         tstate->on_delete(tstate->on_delete_data);
     }
+
+    _PyObject_ClearThreadCache(tstate);
+    _PyGC_ClearThreadState(tstate);
+}
+
+
+/* Free the chunks of the thread's data stack. No frame of the thread may
+   still be executing. */
+static void
+free_datastack(PyThreadState *tstate)
+{
+    _PyStackChunk *chunk = tstate->datastack_chunk;
+    tstate->datastack_chunk = NULL;
+    while (chunk != NULL) {
+        _PyStackChunk *previous = chunk->previous;
+        free_chunk(chunk);
+        chunk = previous;
+    }
+    if (tstate->datastack_spare != NULL) {
+        free_chunk(tstate->datastack_spare);
+        tstate->datastack_spare = NULL;
+    }
+    tstate->datastack_top = NULL;
+    tstate->datastack_limit = NULL;
 }
 
 
@@ -858,6 +995,7 @@ tstate_delete_common(PyThreadState *tstate,
     {
         PyThread_tss_set(&gilstate->autoTSSkey, NULL);
     }
+    free_datastack(tstate);
 }
 
 
@@ -939,6 +1077,7 @@ _PyThreadState_DeleteExcept(_PyRuntimeState *runtime, PyThreadState *tstate)
     for (p = list; p; p = next) {
         next = p->next;
         PyThreadState_Clear(p);
+        free_datastack(p);
         PyMem_RawFree(p);
     }
 }
@@ -1560,15 +1699,26 @@ _call_in_interpreter(struct _gilstate_runtime_state *gilstate,
     if (interp != _PyRuntimeGILState_GetThreadState(gilstate)->interp) {
         // XXX Using the "head" thread isn't strictly correct.
         PyThreadState *tstate = PyInterpreterState_ThreadHead(interp);
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+        // The other interpreter has its own GIL: release ours first.
+        save_tstate = PyEval_SaveThread();
+        PyEval_RestoreThread(tstate);
+#else
         // XXX Possible GILState issues?
         save_tstate = _PyThreadState_Swap(gilstate, tstate);
+#endif
     }
 
     func(arg);
 
     // Switch back.
     if (save_tstate != NULL) {
+#ifdef EXPERIMENTAL_ISOLATED_SUBINTERPRETERS
+        PyEval_SaveThread();
+        PyEval_RestoreThread(save_tstate);
+#else
         _PyThreadState_Swap(gilstate, save_tstate);
+#endif
     }
 }
 
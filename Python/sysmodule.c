@@ -1143,6 +1143,104 @@ sys_getswitchinterval_impl(PyObject *module)
     return 1e-6 * _PyEval_GetSwitchInterval();
 }
 
+/*[clinic input]
+sys._setgilmode
+
+    mode: str
+    /
+
+Set how the GIL is handed over between threads.
+
+'default' lets the threads compete for the GIL when it is released.
+'fair' hands it over to the waiting threads in order, serving first the
+threads which released it around a blocking call.
+[clinic start generated code]*/
+
+static PyObject *
+sys__setgilmode_impl(PyObject *module, const char *mode)
+/*[clinic end generated code: output=2cc9044a7c21d35a input=2e903a4c840a3c27]*/
+{
+    int fair;
+    if (strcmp(mode, "default") == 0) {
+        fair = 0;
+    }
+    else if (strcmp(mode, "fair") == 0) {
+        fair = 1;
+    }
+    else {
+        PyErr_Format(PyExc_ValueError,
+                     "GIL mode must be 'default' or 'fair', not '%.200s'",
+                     mode);
+        return NULL;
+    }
+    _PyEval_SetGILMode(fair);
+    Py_RETURN_NONE;
+}
+
+
+/*[clinic input]
+sys._getgilmode
+
+Return the GIL mode, 'default' or 'fair'; see sys._setgilmode().
+[clinic start generated code]*/
+
+static PyObject *
+sys__getgilmode_impl(PyObject *module)
+/*[clinic end generated code: output=26320421af6979a9 input=a6d4db6f84cffd7e]*/
+{
+    return PyUnicode_FromString(_PyEval_GetGILMode() ? "fair" : "default");
+}
+
+
+/*[clinic input]
+sys._getgilstats
+
+Return a dict with statistics about the GIL.
+
+'switches' is the number of times the GIL changed threads and 'handoffs'
+the number of times it was handed over directly in fair mode.
+'io_waits' and 'cpu_waits' are histograms of the time spent waiting for
+the GIL by the threads which released it on their own and by those asked to
+drop it: item 0 counts waits under 1 microsecond, item i waits from
+2**(i-1) to 2**i microseconds, and the last item all the longer waits.
+
+'interpreter' holds the counters of all the threads of the current
+interpreter and 'threads' maps the identifiers of its threads to their
+own counters: 'wait_time' and 'hold_time' in seconds, the number of
+'acquisitions', the number of 'forced_drops' of the GIL on a request of
+another thread and the number of 'drop_requests' sent to the GIL holder.
+The hold time is only measured while 'timing' is true; see
+sys._setgiltiming().
+[clinic start generated code]*/
+
+static PyObject *
+sys__getgilstats_impl(PyObject *module)
+/*[clinic end generated code: output=6cfe4e3b51e0e160 input=6554ab423e4e17a4]*/
+{
+    return _PyEval_GetGILStats();
+}
+
+
+/*[clinic input]
+sys._setgiltiming
+
+    enabled: bool
+    /
+
+Enable or disable measuring the time threads hold the GIL.
+
+This reads the monotonic clock each time a thread takes or drops the GIL.
+[clinic start generated code]*/
+
+static PyObject *
+sys__setgiltiming_impl(PyObject *module, int enabled)
+/*[clinic end generated code: output=576a3461b4950c0a input=846e82656241b5e3]*/
+{
+    _PyEval_SetGILTiming(enabled);
+    Py_RETURN_NONE;
+}
+
+
 /*[clinic input]
 sys.setrecursionlimit
 
@@ -1735,6 +1833,9 @@ static Py_ssize_t
 sys_getrefcount_impl(PyObject *module, PyObject *object)
 /*[clinic end generated code: output=5fd477f2264b85b2 input=bf474efd50a21535]*/
 {
+    if (_Py_IsDeferred(object)) {
+        return _PyGC_GetDeferredRefcnt(object);
+    }
     return Py_REFCNT(object);
 }
 
@@ -1765,6 +1866,20 @@ sys_getallocatedblocks_impl(PyObject *module)
 }
 
 
+/*[clinic input]
+sys.getunicodeinternedsize -> Py_ssize_t
+
+Return the number of elements of the unicode interned dictionary.
+[clinic start generated code]*/
+
+static Py_ssize_t
+sys_getunicodeinternedsize_impl(PyObject *module)
+/*[clinic end generated code: output=ad0e4c9738ed4129 input=55350ffc4e452d60]*/
+{
+    return _PyUnicode_InternedSize();
+}
+
+
 /*[clinic input]
 sys._getframe
 
@@ -1872,6 +1987,58 @@ sys__debugmallocstats_impl(PyObject *module)
     Py_RETURN_NONE;
 }
 
+
+/*[clinic input]
+sys._setmalloccaches
+
+    enabled: bool
+    /
+
+Enable or disable the caches of free memory blocks of pymalloc per thread.
+
+A thread then reuses the small blocks it freed itself, which avoids
+sharing the bookkeeping of the allocator with the other threads.
+Disabling the caches returns the blocks of all threads to the allocator.
+[clinic start generated code]*/
+
+static PyObject *
+sys__setmalloccaches_impl(PyObject *module, int enabled)
+/*[clinic end generated code: output=c83c47dcba8513c5 input=522ea267cc6af5d3]*/
+{
+    _PyObject_SetThreadCaches(enabled);
+    Py_RETURN_NONE;
+}
+
+
+/*[clinic input]
+sys._getmalloccaches
+
+Return True if pymalloc uses caches per thread; see sys._setmalloccaches().
+[clinic start generated code]*/
+
+static PyObject *
+sys__getmalloccaches_impl(PyObject *module)
+/*[clinic end generated code: output=ff3c263a052dd54a input=d967401e0da9c585]*/
+{
+    return PyBool_FromLong(_PyObject_GetThreadCaches());
+}
+
+
+/*[clinic input]
+sys._malloc_stats
+
+Return a dict of statistics about pymalloc's arenas, pools and blocks.
+
+Return None if pymalloc is not used.
+[clinic start generated code]*/
+
+static PyObject *
+sys__malloc_stats_impl(PyObject *module)
+/*[clinic end generated code: output=1275814b6554e13e input=f018fe106c58cecb]*/
+{
+    return _PyObject_GetMallocStats();
+}
+
 #ifdef Py_TRACE_REFS
 /* Defined in objects.c because it uses static globals if that file */
 extern PyObject *_Py_GetObjects(PyObject *, PyObject *);
@@ -1901,6 +2068,40 @@ sys__clear_type_cache_impl(PyObject *module)
     Py_RETURN_NONE;
 }
 
+/*[clinic input]
+sys._getcacheinfo
+
+Return a dict with the size and statistics of the internal caches.
+
+The 'type_cache' entry describes the type attribute lookup cache of the
+current interpreter: its number of entries and its hit, miss and collision
+counters, and how many times it was grown.
+[clinic start generated code]*/
+
+static PyObject *
+sys__getcacheinfo_impl(PyObject *module)
+/*[clinic end generated code: output=8fa10c23163ee0e2 input=01e01c831818a8fc]*/
+{
+    PyObject *info = PyDict_New();
+    if (info == NULL) {
+        return NULL;
+    }
+    PyObject *type_cache = _PyType_GetCacheInfo();
+    if (type_cache == NULL) {
+        goto error;
+    }
+    int res = PyDict_SetItemString(info, "type_cache", type_cache);
+    Py_DECREF(type_cache);
+    if (res < 0) {
+        goto error;
+    }
+    return info;
+
+error:
+    Py_DECREF(info);
+    return NULL;
+}
+
 /*[clinic input]
 sys.is_finalizing
 
@@ -1938,6 +2139,11 @@ static PyMethodDef sys_methods[] = {
     {"breakpointhook",  (PyCFunction)(void(*)(void))sys_breakpointhook,
      METH_FASTCALL | METH_KEYWORDS, breakpointhook_doc},
     SYS__CLEAR_TYPE_CACHE_METHODDEF
+    SYS__GETCACHEINFO_METHODDEF
+    SYS__GETGILMODE_METHODDEF
+    SYS__GETGILSTATS_METHODDEF
+    SYS__SETGILMODE_METHODDEF
+    SYS__SETGILTIMING_METHODDEF
     SYS__CURRENT_FRAMES_METHODDEF
     SYS_DISPLAYHOOK_METHODDEF
     SYS_EXC_INFO_METHODDEF
@@ -1946,6 +2152,7 @@ static PyMethodDef sys_methods[] = {
     SYS_GETDEFAULTENCODING_METHODDEF
     SYS_GETDLOPENFLAGS_METHODDEF
     SYS_GETALLOCATEDBLOCKS_METHODDEF
+    SYS_GETUNICODEINTERNEDSIZE_METHODDEF
 #ifdef DYNAMIC_EXECUTION_PROFILE
     {"getdxp",          _Py_GetDXProfile, METH_VARARGS},
 #endif
@@ -1975,6 +2182,9 @@ static PyMethodDef sys_methods[] = {
     SYS_GETTRACE_METHODDEF
     SYS_CALL_TRACING_METHODDEF
     SYS__DEBUGMALLOCSTATS_METHODDEF
+    SYS__SETMALLOCCACHES_METHODDEF
+    SYS__GETMALLOCCACHES_METHODDEF
+    SYS__MALLOC_STATS_METHODDEF
     SYS_SET_COROUTINE_ORIGIN_TRACKING_DEPTH_METHODDEF
     SYS_GET_COROUTINE_ORIGIN_TRACKING_DEPTH_METHODDEF
     {"set_asyncgen_hooks", (PyCFunction)(void(*)(void))sys_set_asyncgen_hooks,
@@ -738,6 +738,16 @@ class PyDictObjectPtr(PyObjectPtr):
         else:
             offset = 8 * dk_size
 
+        try:
+            # >= Python 3.10: dk_tags follows dk_indices
+            gdb.lookup_type('dk_group_t')
+        except RuntimeError:
+            pass
+        else:
+            ptr_size = _sizeof_void_p()
+            offset += dk_size + 15
+            offset = (offset + ptr_size - 1) & ~(ptr_size - 1)
+
         ent_addr = keys['dk_indices'].address
         ent_addr = ent_addr.cast(_type_unsigned_char_ptr()) + offset
         ent_ptr_t = gdb.lookup_type('PyDictKeyEntry').pointer()
@@ -870,9 +880,9 @@ class PyFrameObjectPtr(PyObjectPtr):
         if self.is_optimized_out():
             return
 
-        f_localsplus = self.field('f_localsplus')
+        f_localsptr = self.field('f_localsptr')
         for i in safe_range(self.co_nlocals):
-            pyop_value = PyObjectPtr.from_pyobject_ptr(f_localsplus[i])
+            pyop_value = PyObjectPtr.from_pyobject_ptr(f_localsptr[i])
             if not pyop_value.is_null():
                 pyop_name = PyObjectPtr.from_pyobject_ptr(self.co_varnames[i])
                 yield (pyop_name, pyop_value)
@@ -1628,6 +1638,24 @@ class Frame(object):
         except ValueError:
             return None
 
+    def get_pyops(self):
+        '''Yield the Python frames run by this evaluation loop call: the
+        current one, then the callers suspended in calls that the loop runs
+        inline, up to the frame the loop was entered with'''
+        pyop = self.get_pyop()
+        yield pyop
+        if not pyop or pyop.is_optimized_out():
+            return
+        try:
+            entry_frame = long(self._gdbframe.read_var('entry_frame'))
+        except ValueError:
+            return
+        while pyop.as_address() != entry_frame:
+            pyop = PyFrameObjectPtr.from_pyobject_ptr(pyop.field('f_back'))
+            if pyop.is_null():
+                return
+            yield pyop
+
     @classmethod
     def get_selected_frame(cls):
         _gdbframe = gdb.selected_frame()
@@ -1669,16 +1697,16 @@ class Frame(object):
 
     def print_summary(self):
         if self.is_evalframe():
-            pyop = self.get_pyop()
-            if pyop:
-                line = pyop.get_truncated_repr(MAX_OUTPUT_LEN)
-                write_unicode(sys.stdout, '#%i %s\n' % (self.get_index(), line))
-                if not pyop.is_optimized_out():
-                    line = pyop.current_line()
-                    if line is not None:
-                        sys.stdout.write('    %s\n' % line.strip())
-            else:
-                sys.stdout.write('#%i (unable to read python frame information)\n' % self.get_index())
+            for pyop in self.get_pyops():
+                if pyop:
+                    line = pyop.get_truncated_repr(MAX_OUTPUT_LEN)
+                    write_unicode(sys.stdout, '#%i %s\n' % (self.get_index(), line))
+                    if not pyop.is_optimized_out():
+                        line = pyop.current_line()
+                        if line is not None:
+                            sys.stdout.write('    %s\n' % line.strip())
+                else:
+                    sys.stdout.write('#%i (unable to read python frame information)\n' % self.get_index())
         else:
             info = self.is_other_python_frame()
             if info:
@@ -1688,15 +1716,15 @@ class Frame(object):
 
     def print_traceback(self):
         if self.is_evalframe():
-            pyop = self.get_pyop()
-            if pyop:
-                pyop.print_traceback()
-                if not pyop.is_optimized_out():
-                    line = pyop.current_line()
-                    if line is not None:
-                        sys.stdout.write('    %s\n' % line.strip())
-            else:
-                sys.stdout.write('  (unable to read python frame information)\n')
+            for pyop in self.get_pyops():
+                if pyop:
+                    pyop.print_traceback()
+                    if not pyop.is_optimized_out():
+                        line = pyop.current_line()
+                        if line is not None:
+                            sys.stdout.write('    %s\n' % line.strip())
+                else:
+                    sys.stdout.write('  (unable to read python frame information)\n')
         else:
             info = self.is_other_python_frame()
             if info:
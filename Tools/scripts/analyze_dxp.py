@@ -6,8 +6,11 @@ in the current process, and, if Python was also built with -DDXPAIRS,
 will tell you which instruction _pairs_ were executed most frequently,
 which may help in choosing new instructions.
 
-If Python was built without -DDYNAMIC_EXECUTION_PROFILE, importing
-this module will raise a RuntimeError.
+Python configured with --with-opcode-stats collects these profiles too,
+and can write them to a file at exit (see PYTHONOPCODESTATS).  Such files
+can be read by load_stats() from any Python.  Otherwise, if Python was
+built without -DDYNAMIC_EXECUTION_PROFILE, the functions which read the
+profile of the current process raise a RuntimeError.
 
 If you're running a script you want to profile, a simple way to get
 the common pairs is:
@@ -18,21 +21,29 @@ $ PYTHONPATH=$PYTHONPATH:<python_srcdir>/Tools/scripts \
 > from analyze_dxp import *
 > s = render_common_pairs()
 > open('/tmp/some_file', 'w').write(s)
+
+superinstruction_candidates() turns the same profile into a list of pairs
+in the format of the _superinstructions table of Lib/opcode.py.
 """
 
 import copy
+import json
 import opcode
 import operator
 import sys
 import threading
 
-if not hasattr(sys, "getdxp"):
-    raise RuntimeError("Can't import analyze_dxp: Python built without"
-                       " -DDYNAMIC_EXECUTION_PROFILE.")
+_profile_lock = threading.RLock()
+if hasattr(sys, "getdxp"):
+    _cumulative_profile = sys.getdxp()
+else:
+    _cumulative_profile = None
 
 
-_profile_lock = threading.RLock()
-_cumulative_profile = sys.getdxp()
+def _check_getdxp():
+    if _cumulative_profile is None:
+        raise RuntimeError("Python built without -DDYNAMIC_EXECUTION_PROFILE:"
+                           " use load_stats() instead.")
 
 # If Python was built with -DDXPAIRS, sys.getdxp() returns a list of
 # lists of ints.  Otherwise it returns just a list of ints.
@@ -45,6 +56,7 @@ def has_pairs(profile):
 
 def reset_profile():
     """Forgets any execution profile that has been gathered so far."""
+    _check_getdxp()
     with _profile_lock:
         sys.getdxp()  # Resets the internal profile
         global _cumulative_profile
@@ -56,6 +68,7 @@ def merge_profile():
 
     We need this because sys.getdxp() 0s itself every time it's called."""
 
+    _check_getdxp()
     with _profile_lock:
         new_profile = sys.getdxp()
         if has_pairs(new_profile):
@@ -75,6 +88,23 @@ def snapshot_profile():
         return copy.deepcopy(_cumulative_profile)
 
 
+def load_stats(filename):
+    """Reads a file written by Python configured with --with-opcode-stats
+    (see PYTHONOPCODESTATS) and returns the sum of the profiles of all the
+    processes it contains, in the format of sys.getdxp() with -DDXPAIRS.
+
+    """
+    profile = [[0] * 256 for _ in range(257)]
+    with open(filename, encoding='utf-8') as f:
+        for line in f:
+            stats = json.loads(line)
+            for op, count in enumerate(stats['opcodes']):
+                profile[256][op] += count
+            for op1, op2, count in stats['pairs']:
+                profile[op1][op2] += count
+    return profile
+
+
 def common_instructions(profile):
     """Returns the most common opcodes in order of descending frequency.
 
@@ -127,3 +157,29 @@ def render_common_pairs(profile=None):
         for _, ops, count in common_pairs(profile):
             yield "%s: %s\n" % (count, ops)
     return ''.join(seq())
+
+
+# Instructions which do not always continue with the next one, and so
+# cannot start a superinstruction.
+_no_fallthrough = frozenset(
+    [opcode.opmap[name] for name in ('RETURN_VALUE', 'RAISE_VARARGS',
+                                     'RERAISE', 'YIELD_VALUE',
+                                     'YIELD_FROM', 'EXTENDED_ARG')]
+    + opcode.hasjrel + opcode.hasjabs)
+
+
+def superinstruction_candidates(profile=None, count=10):
+    """Returns the pairs which are the best candidates for the
+    _superinstructions table of Lib/opcode.py, most frequent first.
+
+    The result is a list of at most count (1st opname, 2nd opname) tuples,
+    leaving out the pairs whose first instruction may not continue with
+    the second one.  Python must have been built with -DDXPAIRS.
+
+    """
+    if profile is None:
+        profile = snapshot_profile()
+    # The row of opcode 0 counts the first instruction of frames
+    result = [ops for (op1, _), ops, _ in common_pairs(profile)
+              if op1 != 0 and op1 not in _no_fallthrough]
+    return result[:count]
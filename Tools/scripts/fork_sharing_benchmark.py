@@ -0,0 +1,144 @@
+"""Measure how much memory forked worker processes stop sharing with their
+parent.
+
+The parent process builds some data, then forks worker processes which only
+read it.  Each worker reports how many kilobytes of memory it had to copy
+(private dirty pages) while doing so: the only writes are reference count
+updates, so immortal objects keep those pages shared.  With --code, the
+workers call functions and instantiate classes instead, whose reference
+counts --defer hands over to the garbage collector.
+
+Linux only: the private dirty memory is read from /proc/self/smaps_rollup.
+"""
+
+# Please leave this code so that it runs under older versions of
+# Python 3 (no f-strings).  That will allow benchmarking for
+# cross-version comparisons.
+
+import argparse
+import gc
+import os
+import sys
+
+
+def private_dirty():
+    "Return the private dirty memory of the current process in kB."
+    try:
+        with open('/proc/self/smaps_rollup') as fp:
+            lines = fp.readlines()
+    except FileNotFoundError:
+        with open('/proc/self/smaps') as fp:
+            lines = fp.readlines()
+    total = 0
+    for line in lines:
+        if line.startswith('Private_Dirty:'):
+            total += int(line.split()[1])
+    return total
+
+
+def make_data(size):
+    "Return data built from interned strings, small ints and singletons."
+    keys = [sys.intern('key%d' % i) for i in range(size)]
+    values = [(None, True, False, i % 256) for i in range(size)]
+    return keys, values
+
+
+def make_code(size):
+    "Return module-level functions and classes."
+    source = []
+    for i in range(size):
+        source.append('def f%d(x):\n    return x\n' % i)
+        source.append('class C%d:\n    pass\n' % i)
+    namespace = {}
+    exec(''.join(source), namespace)
+    funcs = [namespace['f%d' % i] for i in range(size)]
+    classes = [namespace['C%d' % i] for i in range(size)]
+    return funcs, classes
+
+
+def defer_code(data):
+    funcs, classes = data
+    for func in funcs:
+        gc.defer_refcount(func)
+        gc.defer_refcount(func.__code__)
+    for cls in classes:
+        gc.defer_refcount(cls)
+
+
+def work(data):
+    keys, values = data
+    for key in keys:
+        pass
+    for value in values:
+        a, b, c, n = value
+
+
+def work_code(data):
+    funcs, classes = data
+    for func in funcs:
+        func(None)
+    for cls in classes:
+        cls()
+
+
+def worker(work, data, conn):
+    before = private_dirty()
+    work(data)
+    os.write(conn, b'%d\n' % (private_dirty() - before))
+    os._exit(0)
+
+
+def run(work, data, nworkers):
+    rfd, wfd = os.pipe()
+    pids = []
+    for i in range(nworkers):
+        pid = os.fork()
+        if pid == 0:
+            os.close(rfd)
+            worker(work, data, wfd)
+        pids.append(pid)
+    os.close(wfd)
+    for pid in pids:
+        os.waitpid(pid, 0)
+    with os.fdopen(rfd) as fp:
+        return [int(line) for line in fp]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n\n')[0])
+    parser.add_argument('-n', '--size', type=int, default=500000,
+                        help='number of keys and values (default: %(default)s)')
+    parser.add_argument('-w', '--workers', type=int, default=4,
+                        help='number of worker processes (default: %(default)s)')
+    parser.add_argument('--freeze', action='store_true',
+                        help='call gc.freeze(immortal=True) before forking, '
+                             'to make the containers immortal as well')
+    parser.add_argument('--code', action='store_true',
+                        help='use functions and classes instead of keys '
+                             'and values')
+    parser.add_argument('--defer', action='store_true',
+                        help='with --code, defer the reference counts of '
+                             'the functions, code objects and classes')
+    args = parser.parse_args()
+
+    if args.code:
+        data = make_code(args.size)
+        if args.defer:
+            defer_code(data)
+        what = 'functions and classes'
+    else:
+        data = make_data(args.size)
+        what = 'keys and values'
+    if args.freeze:
+        gc.freeze(immortal=True)
+    results = run(work_code if args.code else work, data, args.workers)
+
+    print('Python %s' % sys.version.split()[0])
+    print('%d %s, %d workers' % (args.size, what, args.workers))
+    for i, kb in enumerate(results):
+        print('worker %d: %8d kB copied' % (i, kb))
+    print('mean:     %8d kB copied' % (sum(results) // len(results)))
+
+
+if __name__ == '__main__':
+    main()
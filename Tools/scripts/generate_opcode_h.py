@@ -31,6 +31,21 @@ footer = """
 """
 
 
+superinstructions_header = """
+    /* Superinstructions, only used in quickened code (see
+       _superinstructions in Lib/opcode.py) */
+"""
+
+
+def superinstruction_opcodes(opcode):
+    """Return a list of (name, first, second, op) tuples for the
+    superinstructions, op being taken from the unused opcodes."""
+    used = set(opcode['opmap'].values())
+    free = (op for op in range(opcode['HAVE_ARGUMENT'], 256) if op not in used)
+    return [('%s__%s' % (first, second), first, second, next(free))
+            for first, second in opcode['_superinstructions']]
+
+
 def main(opcode_py, outfile='Include/opcode.h'):
     opcode = {}
     if hasattr(tokenize, 'open'):
@@ -49,6 +64,14 @@ def main(opcode_py, outfile='Include/opcode.h'):
             if name == 'POP_EXCEPT': # Special entry for HAVE_ARGUMENT
                 fobj.write("#define %-23s %3d\n" %
                             ('HAVE_ARGUMENT', opcode['HAVE_ARGUMENT']))
+        superinstructions = superinstruction_opcodes(opcode)
+        fobj.write(superinstructions_header)
+        for name, first, second, op in superinstructions:
+            fobj.write("#define %-23s %3d\n" % (name, op))
+        fobj.write("\n#define _Py_SUPERINSTRUCTIONS(SUPER)")
+        for name, first, second, op in superinstructions:
+            fobj.write(" \\\n    SUPER(%s, %s, %s)" % (first, second, name))
+        fobj.write("\n")
         fobj.write(footer)
 
     print("%s regenerated from %s" % (outfile, opcode_py))